@@ -17,6 +17,10 @@ int main() {
 #include <inttypes.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
@@ -46,7 +50,18 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(use_clock_cache, false,
+            "Use NewClockCache() rather than NewLRUCache().");
+DEFINE_bool(tiny_lfu_admission, false,
+            "Enable the TinyLFU admission policy of the LRU cache.");
+DEFINE_bool(skewed_keys, false,
+            "Pick keys with an exponential bias towards small keys instead of "
+            "uniformly, so that some keys are much hotter than others.");
+DEFINE_bool(insert_on_miss, false,
+            "Insert the key after a lookup misses, like a block cache does.");
+DEFINE_bool(scaling, false,
+            "Run with 1, 2, 4, ... threads up to -threads, and report the QPS "
+            "of each run and its speedup over one thread");
 
 namespace rocksdb {
 
@@ -59,9 +74,9 @@ void deleter(const Slice& /*key*/, void* value) {
 // State shared by all concurrent executions of the same benchmark.
 class SharedState {
  public:
-  explicit SharedState(CacheBench* cache_bench)
+  SharedState(CacheBench* cache_bench, uint32_t num_threads)
       : cv_(&mu_),
-        num_threads_(FLAGS_threads),
+        num_threads_(num_threads),
         num_initialized_(0),
         start_(false),
         num_done_(0),
@@ -131,7 +146,8 @@ struct ThreadState {
 
 class CacheBench {
  public:
-  CacheBench() : num_threads_(FLAGS_threads) {
+  explicit CacheBench(uint32_t num_threads)
+      : num_threads_(num_threads), qps_(0), lookups_(0), hits_(0) {
     if (FLAGS_use_clock_cache) {
       cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
       if (!cache_) {
@@ -139,7 +155,11 @@ class CacheBench {
         exit(1);
       }
     } else {
-      cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
+                           false /*strict_capacity_limit*/,
+                           0.0 /*high_pri_pool_ratio*/);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      cache_ = NewLRUCache(opts);
     }
   }
 
@@ -160,7 +180,7 @@ class CacheBench {
     rocksdb::Env* env = rocksdb::Env::Default();
 
     PrintEnv();
-    SharedState shared(this);
+    SharedState shared(this, num_threads_);
     std::vector<ThreadState*> threads(num_threads_);
     for (uint32_t i = 0; i < num_threads_; i++) {
       threads[i] = new ThreadState(i, &shared);
@@ -186,16 +206,27 @@ class CacheBench {
       // Record end time
       uint64_t end_time = env->NowMicros();
       double elapsed = static_cast<double>(end_time - start_time) * 1e-6;
-      uint32_t qps = static_cast<uint32_t>(
-          static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
-      fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      qps_ = static_cast<uint32_t>(
+          static_cast<double>(num_threads_ * FLAGS_ops_per_thread) / elapsed);
+      fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps_);
+      uint64_t lookups = lookups_.load();
+      if (lookups > 0) {
+        fprintf(stdout, "Lookup hit rate: %.2f%%\n",
+                100.0 * static_cast<double>(hits_.load()) / lookups);
+      }
     }
     return true;
   }
 
+  // QPS of the last Run()
+  uint32_t qps() const { return qps_; }
+
  private:
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  uint32_t qps_;
+  std::atomic<uint64_t> lookups_;
+  std::atomic<uint64_t> hits_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -222,9 +253,22 @@ class CacheBench {
     }
   }
 
+  static uint64_t NextKey(ThreadState* thread) {
+    if (FLAGS_skewed_keys) {
+      int max_log = 0;
+      while (max_log < 30 && (int64_t{2} << max_log) <= FLAGS_max_key) {
+        max_log++;
+      }
+      return thread->rnd.Skewed(max_log) % FLAGS_max_key;
+    }
+    return thread->rnd.Next() % FLAGS_max_key;
+  }
+
   void OperateCache(ThreadState* thread) {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
-      uint64_t rand_key = thread->rnd.Next() % FLAGS_max_key;
+      uint64_t rand_key = NextKey(thread);
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       int32_t prob_op = thread->rnd.Uniform(100);
@@ -235,8 +279,12 @@ class CacheBench {
                  prob_op < FLAGS_lookup_percent) {
         // do lookup
         auto handle = cache_->Lookup(key);
+        lookups++;
         if (handle) {
+          hits++;
           cache_->Release(handle);
+        } else if (FLAGS_insert_on_miss) {
+          cache_->Insert(key, new char[10], 1, &deleter);
         }
       } else if (prob_op -= FLAGS_lookup_percent &&
                  prob_op < FLAGS_erase_percent) {
@@ -244,11 +292,15 @@ class CacheBench {
         cache_->Erase(key);
       }
     }
+    lookups_.fetch_add(lookups);
+    hits_.fetch_add(hits);
   }
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
-    printf("Number of threads   : %d\n", FLAGS_threads);
+    printf("Cache type          : %s\n",
+           FLAGS_use_clock_cache ? "clock" : "lru");
+    printf("Number of threads   : %u\n", num_threads_);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
@@ -257,6 +309,9 @@ class CacheBench {
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    printf("TinyLFU admission   : %d\n", FLAGS_tiny_lfu_admission);
+    printf("Skewed keys         : %d\n", FLAGS_skewed_keys);
+    printf("Insert on miss      : %d\n", FLAGS_insert_on_miss);
     printf("----------------------------\n");
   }
 };
@@ -270,15 +325,41 @@ int main(int argc, char** argv) {
     exit(1);
   }
 
-  rocksdb::CacheBench bench;
-  if (FLAGS_populate_cache) {
-    bench.PopulateCache();
+  if (!FLAGS_scaling) {
+    rocksdb::CacheBench bench(FLAGS_threads);
+    if (FLAGS_populate_cache) {
+      bench.PopulateCache();
+    }
+    if (bench.Run()) {
+      return 0;
+    } else {
+      return 1;
+    }
+  }
+
+  // Scaling curve, with a new cache for each number of threads
+  std::vector<std::pair<uint32_t, uint32_t>> results;
+  for (uint32_t threads = 1;; threads *= 2) {
+    threads = std::min(threads, static_cast<uint32_t>(FLAGS_threads));
+    rocksdb::CacheBench bench(threads);
+    if (FLAGS_populate_cache) {
+      bench.PopulateCache();
+    }
+    if (!bench.Run()) {
+      return 1;
+    }
+    results.emplace_back(threads, bench.qps());
+    if (threads == static_cast<uint32_t>(FLAGS_threads)) {
+      break;
+    }
   }
-  if (bench.Run()) {
-    return 0;
-  } else {
-    return 1;
+  printf("----------------------------\n");
+  printf("Threads          QPS  Speedup\n");
+  for (const auto& result : results) {
+    printf("%7u %12u %8.2f\n", result.first, result.second,
+           static_cast<double>(result.second) / results[0].second);
   }
+  return 0;
 }
 
 #endif  // GFLAGS
@@ -9,6 +9,7 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
@@ -16,7 +17,9 @@
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
+#include "port/port.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
 
@@ -671,6 +674,49 @@ TEST_P(CacheTest, ApplyToAllCacheEntiresTest) {
   ASSERT_TRUE(inserted == callback_state);
 }
 
+TEST_P(CacheTest, ConcurrentOperations) {
+  // Lookups race with inserts, erases and evictions of the same keys, and
+  // must only return handles of the key looked up
+  const int kCapacity = 256;
+  const int kNumKeys = 1000;
+  const int kNumThreads = 4;
+  const int kOpsPerThread = 50000;
+  std::shared_ptr<Cache> cache = NewCache(kCapacity, 2, false);
+  std::atomic<int> wrong_values(0);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int key = rnd.Uniform(kNumKeys);
+        switch (rnd.Uniform(4)) {
+          case 0:
+            cache->Insert(EncodeKey(key), EncodeValue(key), 1, &dumbDeleter);
+            break;
+          case 1:
+            cache->Erase(EncodeKey(key));
+            break;
+          default: {
+            Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+            if (handle != nullptr) {
+              if (DecodeValue(cache->Value(handle)) != key) {
+                wrong_values++;
+              }
+              cache->Release(handle);
+            }
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, wrong_values.load());
+  ASSERT_LE(cache->GetUsage(), static_cast<size_t>(kCapacity));
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+}
+
 TEST_P(CacheTest, DefaultShardBits) {
   // test1: set the flag to false. Insert more keys than capacity. See if they
   // all go through.
@@ -26,13 +26,8 @@ std::shared_ptr<Cache> NewClockCache(size_t /*capacity*/, int /*num_shard_bits*/
 #include <assert.h>
 #include <atomic>
 #include <deque>
-
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+#include <memory>
+#include <vector>
 
 #include "cache/sharded_cache.h"
 #include "port/port.h"
@@ -59,9 +54,10 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup, which chains the in-cache
+// handles of each bucket through the handles themselves (see
+// ClockHandleTable). Readers walk the chains without locking, which is safe
+// because handles are only recycled, never freed, while the cache lives.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -139,8 +135,9 @@ namespace {
 // hold the mutex. Lookup() only access the hash map and the flags associated
 // with each handle, and don't require explicit locking. Release() has to
 // acquire the mutex only when it releases the last reference to the entry and
-// the entry has been erased from cache explicitly. A future improvement could
-// be to remove the mutex completely.
+// the entry has been erased from cache explicitly. A cache hit thus takes no
+// lock: it walks a hash chain, and increments and decrements the reference
+// count of the handle with atomic operations.
 //
 // Benchmark:
 // We run readrandom db_bench on a test DB of size 13GB, with size of each
@@ -174,7 +171,9 @@ namespace {
 // Cache entry meta data.
 struct CacheHandle {
   Slice key;
-  uint32_t hash;
+  // Atomic, as readers of the hash table compare it before they hold a
+  // reference, when the handle may be reused for another key
+  std::atomic<uint32_t> hash;
   void* value;
   size_t charge;
   void (*deleter)(const Slice&, void* value);
@@ -187,13 +186,19 @@ struct CacheHandle {
   // to 0 is responsible to put the handle back to recycle_ and cleanup memory.
   std::atomic<uint32_t> flags;
 
-  CacheHandle() = default;
+  // Next handle in the hash table chain. Left as is when the handle leaves
+  // the table, so that a reader standing on it can carry on.
+  std::atomic<CacheHandle*> next_hash;
+
+  CacheHandle() : hash(0), flags(0), next_hash(nullptr) {}
 
-  CacheHandle(const CacheHandle& a) { *this = a; }
+  CacheHandle(const CacheHandle& a) : hash(0), flags(0), next_hash(nullptr) {
+    *this = a;
+  }
 
   CacheHandle(const Slice& k, void* v,
               void (*del)(const Slice& key, void* value))
-      : key(k), value(v), deleter(del) {}
+      : key(k), hash(0), value(v), deleter(del), flags(0), next_hash(nullptr) {}
 
   CacheHandle& operator=(const CacheHandle& a) {
     // Only copy members needed for deletion.
@@ -204,25 +209,133 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
+// Hash table of the in-cache handles of a shard, chained through
+// CacheHandle::next_hash. Modifications require the shard mutex, while
+// Head() and walking the chains from it do not. A reader may then stand on a
+// handle that is removed from the table and even reused for another key in
+// another chain, and so miss the key it looks for, which is fine for a cache.
+// The bucket arrays replaced when the table grows are kept until the table
+// is destroyed for the same reason; they add up to less than the current one.
+class ClockHandleTable {
+ public:
+  ClockHandleTable() : elems_(0) {
+    buckets_history_.emplace_back(new Buckets(kInitialLengthBits));
+    buckets_.store(buckets_history_.back().get(), std::memory_order_relaxed);
+  }
 
-  CacheKey() = default;
+  // First handle of the chain of hash.
+  CacheHandle* Head(uint32_t hash) const {
+    const Buckets* buckets = buckets_.load(std::memory_order_acquire);
+    return buckets->Bucket(hash).load(std::memory_order_acquire);
+  }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  // Returns the handle of key in the table, or nullptr.
+  //
+  // Has to hold mutex before being called.
+  CacheHandle* Find(const Slice& key, uint32_t hash) const {
+    for (CacheHandle* h = Head(hash); h != nullptr;
+         h = h->next_hash.load(std::memory_order_relaxed)) {
+      if (h->hash.load(std::memory_order_relaxed) == hash && h->key == key) {
+        return h;
+      }
+    }
+    return nullptr;
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+  // Adds a handle whose key is not in the table.
+  //
+  // Has to hold mutex before being called.
+  void Insert(CacheHandle* handle) {
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    if (elems_ >= buckets->Length()) {
+      buckets = Grow();
+    }
+    LinkAtHead(buckets, handle);
+    ++elems_;
+  }
+
+  // Returns false if the handle is not in the table.
+  //
+  // Has to hold mutex before being called.
+  bool Remove(CacheHandle* handle) {
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    std::atomic<CacheHandle*>* link =
+        &buckets->Bucket(handle->hash.load(std::memory_order_relaxed));
+    for (CacheHandle* h = link->load(std::memory_order_relaxed); h != nullptr;
+         h = link->load(std::memory_order_relaxed)) {
+      if (h == handle) {
+        link->store(h->next_hash.load(std::memory_order_relaxed),
+                    std::memory_order_release);
+        --elems_;
+        return true;
+      }
+      link = &h->next_hash;
+    }
+    return false;
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+  // Has to hold mutex before being called.
+  void Clear() {
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < buckets->Length(); i++) {
+      buckets->list[i].store(nullptr, std::memory_order_release);
+    }
+    elems_ = 0;
   }
+
+ private:
+  static const int kInitialLengthBits = 4;
+
+  struct Buckets {
+    explicit Buckets(int _length_bits)
+        : length_bits(_length_bits),
+          list(new std::atomic<CacheHandle*>[size_t{1} << _length_bits]) {
+      for (uint32_t i = 0; i < Length(); i++) {
+        list[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    uint32_t Length() const { return 1U << length_bits; }
+
+    std::atomic<CacheHandle*>& Bucket(uint32_t hash) const {
+      // The shard is picked by the upper bits of the hash
+      return list[hash & (Length() - 1)];
+    }
+
+    const int length_bits;
+    std::unique_ptr<std::atomic<CacheHandle*>[]> list;
+  };
+
+  static void LinkAtHead(Buckets* buckets, CacheHandle* handle) {
+    std::atomic<CacheHandle*>& head =
+        buckets->Bucket(handle->hash.load(std::memory_order_relaxed));
+    handle->next_hash.store(head.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+    // Release semantics, so that readers of the new link see the handle
+    // filled
+    head.store(handle, std::memory_order_release);
+  }
+
+  // Moves the handles to twice as many buckets
+  Buckets* Grow() {
+    Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
+    Buckets* new_buckets = new Buckets(old_buckets->length_bits + 1);
+    buckets_history_.emplace_back(new_buckets);
+    for (uint32_t i = 0; i < old_buckets->Length(); i++) {
+      CacheHandle* h = old_buckets->list[i].load(std::memory_order_relaxed);
+      while (h != nullptr) {
+        CacheHandle* next = h->next_hash.load(std::memory_order_relaxed);
+        LinkAtHead(new_buckets, h);
+        h = next;
+      }
+    }
+    buckets_.store(new_buckets, std::memory_order_release);
+    return new_buckets;
+  }
+
+  std::vector<std::unique_ptr<Buckets>> buckets_history_;
+  std::atomic<Buckets*> buckets_;
+  uint32_t elems_;
 };
 
 struct CleanupContext {
@@ -236,9 +349,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard();
 
@@ -356,8 +466,8 @@ class ClockCacheShard : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  ClockHandleTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -487,8 +597,7 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
+    bool erased __attribute__((__unused__)) = table_.Remove(handle);
     assert(erased);
     RecycleHandle(handle, context);
     return true;
@@ -564,19 +673,20 @@ CacheHandle* ClockCacheShard::Insert(
   }
   // Fill handle.
   handle->key = key;
-  handle->hash = hash;
+  handle->hash.store(hash, std::memory_order_relaxed);
   handle->value = value;
   handle->charge = charge;
   handle->deleter = deleter;
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
+  // Use release semantics, so that a reader that got hold of the handle
+  // before it was recycled sees the new key once Ref() succeeds.
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = table_.Find(key, hash);
+  if (existing_handle != nullptr) {
+    table_.Remove(existing_handle);
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
+  table_.Insert(handle);
   if (hold_reference) {
     pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
   }
@@ -590,7 +700,6 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                Cache::Handle** out_handle,
                                Cache::Priority /*priority*/) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
@@ -609,28 +718,29 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
+  for (CacheHandle* handle = table_.Head(hash); handle != nullptr;
+       handle = handle->next_hash.load(std::memory_order_acquire)) {
+    if (handle->hash.load(std::memory_order_relaxed) != hash) {
+      continue;
+    }
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
+      continue;
+    }
+    // Double check the key since the handle may now representing another key
+    // if other threads sneak in, evict/erase the entry and re-used the handle
+    // for another cache entry.
+    if (hash == handle->hash.load(std::memory_order_relaxed) &&
+        key == handle->key) {
+      return reinterpret_cast<Cache::Handle*>(handle);
+    }
     CleanupContext context;
     Unref(handle, false, &context);
     // It is possible Unref() delete the entry, so we need to cleanup.
     Cleanup(context);
-    return nullptr;
   }
-  return reinterpret_cast<Cache::Handle*>(handle);
+  return nullptr;
 }
 
 bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
@@ -638,7 +748,8 @@ bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
   CacheHandle* handle = reinterpret_cast<CacheHandle*>(h);
   bool erased = Unref(handle, true, &context);
   if (force_erase && !erased) {
-    erased = EraseAndConfirm(handle->key, handle->hash, &context);
+    erased = EraseAndConfirm(
+        handle->key, handle->hash.load(std::memory_order_relaxed), &context);
   }
   Cleanup(context);
   return erased;
@@ -653,11 +764,10 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = table_.Find(key, hash);
+  if (handle != nullptr) {
+    table_.Remove(handle);
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -667,7 +777,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
@@ -706,7 +816,8 @@ class ClockCache : public ShardedCache {
   }
 
   virtual uint32_t GetHash(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->hash;
+    return reinterpret_cast<const CacheHandle*>(handle)->hash.load(
+        std::memory_order_relaxed);
   }
 
   virtual void DisownData() override { shards_ = nullptr; }
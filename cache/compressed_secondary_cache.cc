@@ -0,0 +1,128 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "options/cf_options.h"
+#include "rocksdb/options.h"
+#include "table/block_based_table_builder.h"
+#include "table/format.h"
+#include "util/compression.h"
+
+namespace rocksdb {
+
+namespace {
+// Block format version whose compressed formats record the uncompressed
+// size, as GetCompressFormatForVersion() defines it.
+const uint32_t kCompressFormatVersion = 2;
+
+struct CompressedEntry {
+  std::string data;
+  CompressionType type;
+};
+
+void DeleteCompressedEntry(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<CompressedEntry*>(value);
+}
+
+// Only the env used to time decompression is needed. Never destroyed, to be
+// usable from the destructors of other static objects.
+const ImmutableCFOptions& DefaultImmutableCFOptions() {
+  static const Options* options = new Options();
+  static const ImmutableCFOptions* ioptions = new ImmutableCFOptions(*options);
+  return *ioptions;
+}
+}  // namespace
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts)
+    : compression_type_(opts.compression_type),
+      cache_(NewLRUCache(opts.capacity, opts.num_shard_bits)) {}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, void* value,
+                                        const Cache::CacheItemHelper* helper) {
+  std::string raw;
+  raw.resize((*helper->size_cb)(value));
+  (*helper->saveto_cb)(value, &raw[0]);
+
+  CompressedEntry* entry = new CompressedEntry;
+  CompressionContext compression_ctx(compression_type_);
+  CompressBlock(raw, compression_ctx, &entry->type, kCompressFormatVersion,
+                &entry->data);
+  if (entry->type == kNoCompression) {
+    entry->data = std::move(raw);
+  }
+  return cache_->Insert(key, entry, entry->data.size(),
+                        &DeleteCompressedEntry);
+}
+
+Status CompressedSecondaryCache::Lookup(const Slice& key,
+                                        const Cache::CreateCallback& create_cb,
+                                        void** value, size_t* charge) {
+  Cache::Handle* handle = cache_->Lookup(key);
+  if (handle == nullptr) {
+    return Status::NotFound();
+  }
+
+  auto entry = reinterpret_cast<CompressedEntry*>(cache_->Value(handle));
+  Status s;
+  if (entry->type == kNoCompression) {
+    s = create_cb(entry->data, value, charge);
+  } else {
+    BlockContents contents;
+    UncompressionContext uncompression_ctx(entry->type);
+    s = UncompressBlockContentsForCompressionType(
+        uncompression_ctx, entry->data.data(), entry->data.size(), &contents,
+        kCompressFormatVersion, DefaultImmutableCFOptions());
+    if (s.ok()) {
+      s = create_cb(contents.data, value, charge);
+    }
+  }
+  if (s.ok()) {
+    // The entry moves back to the primary tier.
+    cache_->Erase(key);
+  }
+  cache_->Release(handle);
+  return s;
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+
+size_t CompressedSecondaryCache::GetCapacity() const {
+  return cache_->GetCapacity();
+}
+
+size_t CompressedSecondaryCache::GetUsage() const {
+  return cache_->GetUsage();
+}
+
+std::string CompressedSecondaryCache::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize,
+           "    capacity : %" ROCKSDB_PRIszt
+           "\n"
+           "    compression_type : %s\n",
+           cache_->GetCapacity(),
+           CompressionTypeToString(compression_type_).c_str());
+  return std::string(buffer);
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  if (opts.num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  return std::make_shared<CompressedSecondaryCache>(opts);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,44 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/secondary_cache.h"
+
+namespace rocksdb {
+
+// In-memory SecondaryCache that keeps each demoted entry compressed in an
+// LRU cache of its own, charged with the compressed size. An entry is
+// removed on a hit, since it is promoted back to the primary tier.
+class CompressedSecondaryCache : public SecondaryCache {
+ public:
+  explicit CompressedSecondaryCache(
+      const CompressedSecondaryCacheOptions& opts);
+  virtual ~CompressedSecondaryCache() {}
+
+  virtual const char* Name() const override {
+    return "CompressedSecondaryCache";
+  }
+
+  virtual Status Insert(const Slice& key, void* value,
+                        const Cache::CacheItemHelper* helper) override;
+  virtual Status Lookup(const Slice& key,
+                        const Cache::CreateCallback& create_cb, void** value,
+                        size_t* charge) override;
+  virtual void Erase(const Slice& key) override;
+  virtual size_t GetCapacity() const override;
+  virtual size_t GetUsage() const override;
+  virtual std::string GetPrintableOptions() const override;
+
+ private:
+  const CompressionType compression_type_;
+  std::shared_ptr<Cache> cache_;
+};
+
+}  // namespace rocksdb
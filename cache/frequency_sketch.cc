@@ -0,0 +1,86 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/frequency_sketch.h"
+
+#include <assert.h>
+#include <algorithm>
+
+namespace rocksdb {
+
+namespace {
+const size_t kMinWords = 128;
+
+// Odd multipliers used to derive an independent index for each row.
+const uint64_t kRowSeeds[] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                              0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+}  // namespace
+
+FrequencySketch::FrequencySketch()
+    : table_(kMinWords, 0),
+      table_mask_(kMinWords - 1),
+      additions_(0),
+      sample_size_(10 * kMinWords) {}
+
+void FrequencySketch::EnsureCapacity(size_t num_entries) {
+  if (num_entries <= table_.size()) {
+    return;
+  }
+  size_t new_size = table_.size();
+  while (new_size < num_entries) {
+    new_size *= 2;
+  }
+  table_.assign(new_size, 0);
+  table_mask_ = new_size - 1;
+  additions_ = 0;
+  sample_size_ = 10 * new_size;
+}
+
+void FrequencySketch::Locate(uint32_t hash, int row, size_t* word,
+                             int* shift) const {
+  uint64_t h = (static_cast<uint64_t>(hash) + 1) * kRowSeeds[row];
+  h ^= h >> 29;
+  *word = static_cast<size_t>(h >> 32) & table_mask_;
+  // Each row owns four of the sixteen counters in a word.
+  *shift = static_cast<int>(((h & 3) << 2) + row) << 2;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  bool added = false;
+  for (int row = 0; row < kNumRows; row++) {
+    size_t word;
+    int shift;
+    Locate(hash, row, &word, &shift);
+    uint64_t mask = static_cast<uint64_t>(kMaxCount) << shift;
+    if ((table_[word] & mask) != mask) {
+      table_[word] += static_cast<uint64_t>(1) << shift;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) {
+    Age();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  uint32_t count = kMaxCount;
+  for (int row = 0; row < kNumRows; row++) {
+    size_t word;
+    int shift;
+    Locate(hash, row, &word, &shift);
+    count = std::min(count,
+                     static_cast<uint32_t>(table_[word] >> shift) & kMaxCount);
+  }
+  return count;
+}
+
+void FrequencySketch::Age() {
+  for (auto& w : table_) {
+    w = (w >> 1) & 0x7777777777777777ULL;
+  }
+  additions_ /= 2;
+}
+
+}  // namespace rocksdb
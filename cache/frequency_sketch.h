@@ -0,0 +1,54 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace rocksdb {
+
+// FrequencySketch is a compact, approximate access-frequency histogram used by
+// the TinyLFU admission policy of LRUCache. It is a count-min sketch with
+// four rows of 4-bit saturating counters packed into 64-bit words. To keep the
+// histogram biased towards recent history, all counters are halved once the
+// number of recorded accesses reaches ten times the table size.
+//
+// The sketch is not thread safe; callers serialize access (LRUCacheShard
+// only touches it while holding its mutex).
+class FrequencySketch {
+ public:
+  FrequencySketch();
+
+  // Grow the sketch so that it can track roughly `num_entries` distinct keys
+  // with a low error rate. Growing discards the recorded history.
+  void EnsureCapacity(size_t num_entries);
+
+  // Record one access of the key with the given hash.
+  void Increment(uint32_t hash);
+
+  // Returns the estimated number of accesses of the key, in [0, 15].
+  uint32_t Estimate(uint32_t hash) const;
+
+  size_t NumWords() const { return table_.size(); }
+
+ private:
+  static const int kNumRows = 4;
+  static const uint32_t kMaxCount = 15;
+
+  // Location of the counter for `hash` in row `row`.
+  void Locate(uint32_t hash, int row, size_t* word, int* shift) const;
+
+  // Halve every counter.
+  void Age();
+
+  std::vector<uint64_t> table_;
+  size_t table_mask_;
+  size_t additions_;
+  size_t sample_size_;
+};
+
+}  // namespace rocksdb
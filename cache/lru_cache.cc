@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <string>
 
+#include "monitoring/statistics.h"
 #include "util/mutexlock.h"
 
 namespace rocksdb {
@@ -100,12 +101,16 @@ void LRUHandleTable::Resize() {
 }
 
 LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
-                             double high_pri_pool_ratio)
+                             double high_pri_pool_ratio,
+                             bool tiny_lfu_admission,
+                             SecondaryCache* secondary_cache)
     : capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      tiny_lfu_admission_(tiny_lfu_admission),
+      secondary_cache_(secondary_cache),
       usage_(0),
       lru_usage_(0) {
   // Make empty circular linked list
@@ -246,19 +251,43 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
   }
 }
 
+void LRUCacheShard::MaybeDemote(LRUHandle* e) {
+  if (secondary_cache_ != nullptr && e->helper != nullptr) {
+    // Failing to demote only loses the entry, as if there were no
+    // secondary cache.
+    secondary_cache_->Insert(e->key(), e->value, e->helper);
+  }
+}
+
+void LRUCacheShard::FreeEvicted(const autovector<LRUHandle*>& evicted) {
+  for (auto entry : evicted) {
+    MaybeDemote(entry);
+    entry->Free();
+  }
+}
+
+bool LRUCacheShard::RejectedByAdmission(uint32_t hash, size_t charge) {
+  sketch_.Increment(hash);
+  if (usage_ + charge <= capacity_ || lru_.next == &lru_) {
+    // Nothing would be evicted to make room for the new entry.
+    return false;
+  }
+  // Admit the candidate only if it is more popular than the victim, so that
+  // a burst of one-time accesses (e.g. a scan) cannot flush the working set.
+  return sketch_.Estimate(hash) <= sketch_.Estimate(lru_.next->hash);
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity) {
-  autovector<LRUHandle*> last_reference_list;
+  autovector<LRUHandle*> evicted_list;
   {
     MutexLock l(&mutex_);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
-    EvictFromLRU(0, &last_reference_list);
+    EvictFromLRU(0, &evicted_list);
   }
   // we free the entries here outside of mutex for
   // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
-  }
+  FreeEvicted(evicted_list);
 }
 
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
@@ -268,6 +297,9 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
   MutexLock l(&mutex_);
+  if (tiny_lfu_admission_) {
+    sketch_.Increment(hash);
+  }
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -303,6 +335,7 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
   {
     MutexLock l(&mutex_);
     last_reference = Unref(e);
@@ -321,6 +354,7 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
         Unref(e);
         usage_ -= e->charge;
         last_reference = true;
+        evicted = !force_erase;
       } else {
         // put the item on the list to be potentially freed
         LRU_Insert(e);
@@ -330,6 +364,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
 
   // free outside of mutex
   if (last_reference) {
+    if (evicted) {
+      MaybeDemote(e);
+    }
     e->Free();
   }
   return last_reference;
@@ -339,6 +376,15 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return Insert(key, hash, value, charge, deleter, nullptr /* helper */,
+                handle, priority);
+}
+
+Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                             size_t charge,
+                             void (*deleter)(const Slice& key, void* value),
+                             const Cache::CacheItemHelper* helper,
+                             Cache::Handle** handle, Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -346,9 +392,11 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s;
   autovector<LRUHandle*> last_reference_list;
+  autovector<LRUHandle*> evicted_list;
 
   e->value = value;
   e->deleter = deleter;
+  e->helper = helper;
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
@@ -364,11 +412,29 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   {
     MutexLock l(&mutex_);
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(charge, &last_reference_list);
+    bool rejected = tiny_lfu_admission_ && priority == Cache::Priority::LOW &&
+                    table_.Lookup(key, hash) == nullptr &&
+                    RejectedByAdmission(hash, charge);
+    if (!rejected) {
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty
+      EvictFromLRU(charge, &evicted_list);
+    }
 
-    if (usage_ - lru_usage_ + charge > capacity_ &&
+    if (rejected) {
+      if (handle == nullptr) {
+        // As if the entry was inserted and evicted immediately.
+        last_reference_list.push_back(e);
+      } else {
+        // The caller still needs the value, so hand out an entry that is not
+        // in the table. It is freed when the caller releases it.
+        e->refs = 1;
+        e->SetInCache(false);
+        usage_ += e->charge;
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+      s = Status::OK();
+    } else if (usage_ - lru_usage_ + charge > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
@@ -400,12 +466,16 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       } else {
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
+      if (tiny_lfu_admission_) {
+        sketch_.EnsureCapacity(table_.GetElems());
+      }
       s = Status::OK();
     }
   }
 
   // we free the entries here outside of mutex for
   // performance reasons
+  FreeEvicted(evicted_list);
   for (auto entry : last_reference_list) {
     entry->Free();
   }
@@ -454,22 +524,28 @@ std::string LRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    tiny_lfu_admission: %d\n",
+             high_pri_pool_ratio_, tiny_lfu_admission_);
   }
   return std::string(buffer);
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
-                   bool strict_capacity_limit, double high_pri_pool_ratio)
-    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
+                   bool strict_capacity_limit, double high_pri_pool_ratio,
+                   bool tiny_lfu_admission,
+                   std::shared_ptr<SecondaryCache> secondary_cache)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit),
+      secondary_cache_(secondary_cache) {
   num_shards_ = 1 << num_shard_bits;
   shards_ = reinterpret_cast<LRUCacheShard*>(
       port::cacheline_aligned_alloc(sizeof(LRUCacheShard) * num_shards_));
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
-        LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio);
+        LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio,
+                      tiny_lfu_admission, secondary_cache_.get());
   }
 }
 
@@ -503,6 +579,67 @@ uint32_t LRUCache::GetHash(Handle* handle) const {
   return reinterpret_cast<const LRUHandle*>(handle)->hash;
 }
 
+Status LRUCache::InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) {
+  if (secondary_cache_ == nullptr) {
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+  uint32_t hash = HashSlice(key);
+  return shards_[Shard(hash)].Insert(key, hash, value, charge, helper->del_cb,
+                                     helper, handle, priority);
+}
+
+Cache::Handle* LRUCache::LookupWithHelper(const Slice& key,
+                                          const CacheItemHelper* helper,
+                                          const CreateCallback& create_cb,
+                                          Priority priority,
+                                          Statistics* stats) {
+  if (secondary_cache_ == nullptr) {
+    return Lookup(key, stats);
+  }
+  uint32_t hash = HashSlice(key);
+  LRUCacheShard* shard = &shards_[Shard(hash)];
+  Handle* handle = shard->Lookup(key, hash);
+  if (handle != nullptr) {
+    return handle;
+  }
+
+  void* value = nullptr;
+  size_t charge = 0;
+  Status s = secondary_cache_->Lookup(key, create_cb, &value, &charge);
+  if (!s.ok()) {
+    RecordTick(stats, SECONDARY_CACHE_MISSES);
+    return nullptr;
+  }
+  RecordTick(stats, SECONDARY_CACHE_HITS);
+  // Promote the entry. It was removed from the secondary cache, so it can
+  // be demoted again later.
+  s = shard->Insert(key, hash, value, charge, helper->del_cb, helper, &handle,
+                    priority);
+  if (!s.ok()) {
+    (*helper->del_cb)(key, value);
+    return nullptr;
+  }
+  return handle;
+}
+
+void LRUCache::Erase(const Slice& key) {
+  ShardedCache::Erase(key);
+  if (secondary_cache_ != nullptr) {
+    secondary_cache_->Erase(key);
+  }
+}
+
+std::string LRUCache::GetPrintableOptions() const {
+  std::string ret = ShardedCache::GetPrintableOptions();
+  if (secondary_cache_ != nullptr) {
+    ret.append("    secondary_cache:\n");
+    ret.append(secondary_cache_->GetPrintableOptions());
+  }
+  return ret;
+}
+
 void LRUCache::DisownData() {
 // Do not drop data if compile with ASAN to suppress leak warning.
 #if defined(__clang__)
@@ -534,27 +671,39 @@ double LRUCache::GetHighPriPoolRatio() {
   return result;
 }
 
-std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio);
+bool LRUCache::GetTinyLFUAdmission() {
+  bool result = false;
+  if (num_shards_ > 0) {
+    result = shards_[0].GetTinyLFUAdmission();
+  }
+  return result;
 }
 
-std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
-                                   bool strict_capacity_limit,
-                                   double high_pri_pool_ratio) {
+std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
+  int num_shard_bits = cache_opts.num_shard_bits;
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
   if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+    num_shard_bits = GetDefaultCacheShardBits(cache_opts.capacity);
   }
-  return std::make_shared<LRUCache>(capacity, num_shard_bits,
-                                    strict_capacity_limit, high_pri_pool_ratio);
+  return std::make_shared<LRUCache>(
+      cache_opts.capacity, num_shard_bits, cache_opts.strict_capacity_limit,
+      cache_opts.high_pri_pool_ratio, cache_opts.tiny_lfu_admission,
+      cache_opts.secondary_cache);
+}
+
+std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
+                                   bool strict_capacity_limit,
+                                   double high_pri_pool_ratio) {
+  return NewLRUCache(LRUCacheOptions(capacity, num_shard_bits,
+                                     strict_capacity_limit,
+                                     high_pri_pool_ratio));
 }
 
 }  // namespace rocksdb
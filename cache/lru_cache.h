@@ -10,9 +10,11 @@
 
 #include <string>
 
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
 
 namespace rocksdb {
@@ -46,6 +48,8 @@ namespace rocksdb {
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
+  // Non-null if the entry can be demoted to the secondary cache.
+  const Cache::CacheItemHelper* helper;
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -141,6 +145,8 @@ class LRUHandleTable {
     }
   }
 
+  uint32_t GetElems() const { return elems_; }
+
  private:
   // Return a pointer to slot that points to a cache entry that
   // matches key/hash.  If there is no such cache entry, return a
@@ -160,7 +166,8 @@ class LRUHandleTable {
 class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
-                double high_pri_pool_ratio);
+                double high_pri_pool_ratio, bool tiny_lfu_admission = false,
+                SecondaryCache* secondary_cache = nullptr);
   virtual ~LRUCacheShard();
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -180,6 +187,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
+  // Same as above, but the entry is demoted to the secondary cache through
+  // helper, if it is not null, when it is evicted.
+  Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                const Cache::CacheItemHelper* helper, Cache::Handle** handle,
+                Cache::Priority priority);
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
@@ -209,6 +222,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
 
+  //  Retrieves whether TinyLFU admission is enabled
+  bool GetTinyLFUAdmission() const { return tiny_lfu_admission_; }
+
  private:
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
@@ -227,6 +243,19 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // Save an entry that is evicted to the secondary cache, if it has a
+  // helper. Must be called without holding mutex_.
+  void MaybeDemote(LRUHandle* e);
+
+  // Free entries evicted by EvictFromLRU(), after demoting them. Must be
+  // called without holding mutex_.
+  void FreeEvicted(const autovector<LRUHandle*>& evicted);
+
+  // Returns true if a new low-pri entry with the given hash and charge should
+  // be kept out of the cache because it is estimated to be accessed less
+  // often than the entry it would evict first. Requires mutex_.
+  bool RejectedByAdmission(uint32_t hash, size_t charge);
+
   // Initialized before use.
   size_t capacity_;
 
@@ -251,6 +280,14 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Whether new entries must pass the TinyLFU admission filter once the
+  // shard is full.
+  const bool tiny_lfu_admission_;
+
+  // Tier that evicted entries with a helper are demoted to. Owned by the
+  // LRUCache.
+  SecondaryCache* const secondary_cache_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -270,6 +307,10 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Access frequency history of recently seen keys, used only when
+  // tiny_lfu_admission_ is set.
+  FrequencySketch sketch_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -279,7 +320,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
 class LRUCache : public ShardedCache {
  public:
   LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-           double high_pri_pool_ratio);
+           double high_pri_pool_ratio, bool tiny_lfu_admission = false,
+           std::shared_ptr<SecondaryCache> secondary_cache = nullptr);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -288,15 +330,29 @@ class LRUCache : public ShardedCache {
   virtual size_t GetCharge(Handle* handle) const override;
   virtual uint32_t GetHash(Handle* handle) const override;
   virtual void DisownData() override;
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) override;
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   const CreateCallback& create_cb,
+                                   Priority priority,
+                                   Statistics* stats = nullptr) override;
+  virtual void Erase(const Slice& key) override;
+  virtual std::string GetPrintableOptions() const override;
 
   //  Retrieves number of elements in LRU, for unit test purpose only
   size_t TEST_GetLRUSize();
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
+  //  Retrieves whether TinyLFU admission is enabled
+  bool GetTinyLFUAdmission();
 
  private:
   LRUCacheShard* shards_ = nullptr;
   int num_shards_ = 0;
+  std::shared_ptr<SecondaryCache> secondary_cache_;
 };
 
 }  // namespace rocksdb
@@ -8,6 +8,10 @@
 #include <string>
 #include <vector>
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/statistics.h"
+#include "util/hash.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -25,17 +29,22 @@ class LRUCacheTest : public testing::Test {
     }
   }
 
-  void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0) {
+  void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
+                bool tiny_lfu_admission = false) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
     new (cache_) LRUCacheShard(capacity, false /*strict_capcity_limit*/,
-                               high_pri_pool_ratio);
+                               high_pri_pool_ratio, tiny_lfu_admission);
+  }
+
+  static uint32_t HashKey(const std::string& key) {
+    return Hash(key.data(), key.size(), 0);
   }
 
   void Insert(const std::string& key,
               Cache::Priority priority = Cache::Priority::LOW) {
-    cache_->Insert(key, 0 /*hash*/, nullptr /*value*/, 1 /*charge*/,
+    cache_->Insert(key, HashKey(key), nullptr /*value*/, 1 /*charge*/,
                    nullptr /*deleter*/, nullptr /*handle*/, priority);
   }
 
@@ -44,7 +53,7 @@ class LRUCacheTest : public testing::Test {
   }
 
   bool Lookup(const std::string& key) {
-    auto handle = cache_->Lookup(key, 0 /*hash*/);
+    auto handle = cache_->Lookup(key, HashKey(key));
     if (handle) {
       cache_->Release(handle);
       return true;
@@ -54,7 +63,7 @@ class LRUCacheTest : public testing::Test {
 
   bool Lookup(char key) { return Lookup(std::string(1, key)); }
 
-  void Erase(const std::string& key) { cache_->Erase(key, 0 /*hash*/); }
+  void Erase(const std::string& key) { cache_->Erase(key, HashKey(key)); }
 
   void ValidateLRUList(std::vector<std::string> keys,
                        size_t num_high_pri_pool_keys = 0) {
@@ -85,7 +94,7 @@ class LRUCacheTest : public testing::Test {
     ASSERT_EQ(num_high_pri_pool_keys, high_pri_pool_keys);
   }
 
- private:
+ protected:
   LRUCacheShard* cache_ = nullptr;
 };
 
@@ -188,6 +197,163 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+TEST_F(LRUCacheTest, TinyLFUAdmission) {
+  for (bool tiny_lfu : {false, true}) {
+    NewCache(10, 0.0, tiny_lfu);
+    // A working set of frequently accessed keys.
+    for (char ch = 'a'; ch <= 'e'; ch++) {
+      Insert(ch);
+      for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(Lookup(ch));
+      }
+    }
+    // A scan that touches every key once and fills the cache on misses.
+    for (int i = 0; i < 100; i++) {
+      std::string key = "scan" + ToString(i);
+      ASSERT_FALSE(Lookup(key));
+      Insert(key);
+    }
+    for (char ch = 'a'; ch <= 'e'; ch++) {
+      ASSERT_EQ(tiny_lfu, Lookup(ch));
+    }
+  }
+
+  // A key that becomes popular is admitted in place of the LRU entry.
+  NewCache(10, 0.0, true);
+  for (char ch = 'a'; ch <= 'j'; ch++) {
+    Insert(ch);
+    ASSERT_TRUE(Lookup(ch));
+  }
+  ASSERT_FALSE(Lookup("k"));
+  Insert("k");
+  ASSERT_FALSE(Lookup("k"));
+  ASSERT_TRUE(Lookup("a"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_FALSE(Lookup("k"));
+  }
+  Insert("k");
+  ASSERT_TRUE(Lookup("k"));
+  ASSERT_FALSE(Lookup("b"));
+
+  // A rejected entry is still handed to a caller that asks for a handle, and
+  // is freed once released.
+  static int num_deleted;
+  num_deleted = 0;
+  ASSERT_FALSE(Lookup("l"));
+  std::string key = "l";
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(cache_->Insert(
+      key, HashKey(key), &num_deleted, 1,
+      [](const Slice& /*key*/, void* value) {
+        (*reinterpret_cast<int*>(value))++;
+      },
+      &handle, Cache::Priority::LOW));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(11, cache_->GetUsage());
+  ASSERT_FALSE(Lookup("l"));
+  ASSERT_EQ(0, num_deleted);
+  ASSERT_TRUE(cache_->Release(handle));
+  ASSERT_EQ(1, num_deleted);
+  ASSERT_EQ(10, cache_->GetUsage());
+}
+
+class LRUSecondaryCacheTest : public testing::Test {
+ public:
+  static size_t SizeCallback(void* value) {
+    return reinterpret_cast<std::string*>(value)->size();
+  }
+
+  static void SaveToCallback(void* value, char* out) {
+    auto str = reinterpret_cast<std::string*>(value);
+    memcpy(out, str->data(), str->size());
+  }
+
+  static void DeletionCallback(const Slice& /*key*/, void* value) {
+    delete reinterpret_cast<std::string*>(value);
+  }
+
+  static Status CreateCallback(const Slice& data, void** value,
+                               size_t* charge) {
+    *value = new std::string(data.ToString());
+    *charge = data.size();
+    return Status::OK();
+  }
+
+  static const Cache::CacheItemHelper helper_;
+};
+
+const Cache::CacheItemHelper LRUSecondaryCacheTest::helper_ = {
+    &LRUSecondaryCacheTest::SizeCallback,
+    &LRUSecondaryCacheTest::SaveToCallback,
+    &LRUSecondaryCacheTest::DeletionCallback};
+
+TEST_F(LRUSecondaryCacheTest, DemoteAndPromote) {
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(
+          CompressedSecondaryCacheOptions(1000, 0, kLZ4Compression));
+  LRUCacheOptions opts(250 /*capacity*/, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+
+  std::string str1(100, 'a');
+  std::string str2(100, 'b');
+  ASSERT_OK(cache->InsertWithHelper("k1", new std::string(str1), &helper_,
+                                    str1.size()));
+  ASSERT_OK(cache->InsertWithHelper("k2", new std::string(str2), &helper_,
+                                    str2.size()));
+  ASSERT_EQ(0, secondary_cache->GetUsage());
+  // k1 is demoted to make room.
+  ASSERT_OK(cache->InsertWithHelper("k3", new std::string(100, 'c'), &helper_,
+                                    100));
+  ASSERT_EQ(200, cache->GetUsage());
+  size_t secondary_usage = secondary_cache->GetUsage();
+  ASSERT_GT(secondary_usage, 0);
+  ASSERT_LE(secondary_usage, str1.size());
+  ASSERT_EQ(nullptr, cache->Lookup("k1"));
+
+  // A lookup with helper promotes k1, which demotes k2.
+  Cache::CreateCallback create_cb = &LRUSecondaryCacheTest::CreateCallback;
+  Cache::Handle* handle = cache->LookupWithHelper(
+      "k1", &helper_, create_cb, Cache::Priority::LOW, stats.get());
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(str1, *reinterpret_cast<std::string*>(cache->Value(handle)));
+  cache->Release(handle);
+  ASSERT_EQ(1, stats->getTickerCount(SECONDARY_CACHE_HITS));
+  handle = cache->LookupWithHelper("k2", &helper_, create_cb,
+                                   Cache::Priority::LOW, stats.get());
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(str2, *reinterpret_cast<std::string*>(cache->Value(handle)));
+  cache->Release(handle);
+  ASSERT_EQ(2, stats->getTickerCount(SECONDARY_CACHE_HITS));
+  ASSERT_EQ(0, stats->getTickerCount(SECONDARY_CACHE_MISSES));
+
+  // Entries move between the tiers rather than being copied.
+  ASSERT_EQ(200, cache->GetUsage());
+  ASSERT_EQ(secondary_usage, secondary_cache->GetUsage());
+
+  // Erase removes the entry from both tiers.
+  cache->Erase("k3");
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("k3", &helper_, create_cb,
+                                             Cache::Priority::LOW,
+                                             stats.get()));
+  ASSERT_EQ(1, stats->getTickerCount(SECONDARY_CACHE_MISSES));
+
+  // Entries inserted without a helper are not demoted.
+  ASSERT_OK(cache->Insert("k4", new std::string(100, 'd'), 100,
+                          &LRUSecondaryCacheTest::DeletionCallback));
+  ASSERT_OK(cache->InsertWithHelper("k5", new std::string(100, 'e'), &helper_,
+                                    100));
+  ASSERT_OK(cache->InsertWithHelper("k6", new std::string(100, 'f'), &helper_,
+                                    100));
+  ASSERT_EQ(nullptr, cache->LookupWithHelper("k4", &helper_, create_cb,
+                                             Cache::Priority::LOW,
+                                             stats.get()));
+  ASSERT_EQ(2, stats->getTickerCount(SECONDARY_CACHE_MISSES));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
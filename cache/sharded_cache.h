@@ -80,7 +80,7 @@ class ShardedCache : public Cache {
 
   int GetNumShardBits() const { return num_shard_bits_; }
 
- private:
+ protected:
   static inline uint32_t HashSlice(const Slice& s) {
     return Hash(s.data(), s.size(), 0);
   }
@@ -90,6 +90,8 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+ private:
+
   int num_shard_bits_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
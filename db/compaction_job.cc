@@ -526,6 +526,35 @@ void CompactionJob::GenSubcompactionBoundaries() {
     sum += size;
   }
 
+  // For a leveled compaction from a level other than L0, only cut at the
+  // starting keys of output level files, so that each output file is
+  // rewritten by one subcompaction instead of being split into smaller files.
+  // The input files of such a compaction are range partitioned, so the data
+  // between two of these keys can be large enough to be worth its own
+  // subcompaction.
+  std::vector<Slice> output_file_starts;
+  if (start_lvl > 0 &&
+      c->immutable_cf_options()->compaction_style == kCompactionStyleLevel) {
+    const LevelFilesBrief* flevel = c->input_levels(c->num_input_levels() - 1);
+    for (size_t i = 1; i < flevel->num_files; i++) {
+      output_file_starts.emplace_back(flevel->files[i].smallest_key);
+    }
+    if (output_file_starts.empty()) {
+      // A single output file: the cuts would split it
+      sizes_.emplace_back(sum);
+      return;
+    }
+  }
+  auto is_cut_allowed = [&](const Slice& key) -> bool {
+    return output_file_starts.empty() ||
+           std::binary_search(
+               output_file_starts.begin(), output_file_starts.end(), key,
+               [cfd_comparator](const Slice& a, const Slice& b) -> bool {
+                 return cfd_comparator->Compare(ExtractUserKey(a),
+                                                ExtractUserKey(b)) < 0;
+               });
+  };
+
   // Group the ranges into subcompactions
   const double min_file_fill_percent = 4.0 / 5;
   int base_level = v->storage_info()->base_level();
@@ -534,9 +563,12 @@ void CompactionJob::GenSubcompactionBoundaries() {
       MaxFileSizeForLevel(*(c->mutable_cf_options()), out_lvl,
           c->immutable_cf_options()->compaction_style, base_level,
           c->immutable_cf_options()->level_compaction_dynamic_level_bytes)));
+  uint64_t max_ranges = static_cast<uint64_t>(ranges.size());
+  if (!output_file_starts.empty()) {
+    max_ranges = std::min<uint64_t>(max_ranges, output_file_starts.size() + 1);
+  }
   uint64_t subcompactions =
-      std::min({static_cast<uint64_t>(ranges.size()),
-                static_cast<uint64_t>(c->max_subcompactions()),
+      std::min({max_ranges, static_cast<uint64_t>(c->max_subcompactions()),
                 max_output_files});
 
   if (subcompactions > 1) {
@@ -551,7 +583,7 @@ void CompactionJob::GenSubcompactionBoundaries() {
         // need to put an end boundary
         continue;
       }
-      if (sum >= mean) {
+      if (sum >= mean && is_cut_allowed(ranges[i].range.limit)) {
         boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
         sizes_.emplace_back(sum);
         subcompactions--;
@@ -576,21 +608,38 @@ Status CompactionJob::Run() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
-  // Launch a thread for each of subcompactions 1...num_threads-1
-  std::vector<port::Thread> thread_pool;
-  thread_pool.reserve(num_threads - 1);
-  for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
-    thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this,
-                             &compact_->sub_compact_states[i]);
+  bool run_by_service = false;
+  if (db_options_.compaction_service != nullptr) {
+    Status s = RunWithCompactionService();
+    if (s.ok()) {
+      run_by_service = true;
+    } else if (!s.IsNotSupported()) {
+      ROCKS_LOG_WARN(
+          db_options_.info_log,
+          "[%s] [JOB %d] Compaction service %s failed, compacting locally: %s",
+          compact_->compaction->column_family_data()->GetName().c_str(),
+          job_id_, db_options_.compaction_service->Name(),
+          s.ToString().c_str());
+    }
   }
 
-  // Always schedule the first subcompaction (whether or not there are also
-  // others) in the current thread to be efficient with resources
-  ProcessKeyValueCompaction(&compact_->sub_compact_states[0]);
+  std::vector<port::Thread> thread_pool;
+  if (!run_by_service) {
+    // Launch a thread for each of subcompactions 1...num_threads-1
+    thread_pool.reserve(num_threads - 1);
+    for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
+      thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this,
+                               &compact_->sub_compact_states[i]);
+    }
+
+    // Always schedule the first subcompaction (whether or not there are also
+    // others) in the current thread to be efficient with resources
+    ProcessKeyValueCompaction(&compact_->sub_compact_states[0]);
 
-  // Wait for all other threads (if there are any) to finish execution
-  for (auto& thread : thread_pool) {
-    thread.join();
+    // Wait for all other threads (if there are any) to finish execution
+    for (auto& thread : thread_pool) {
+      thread.join();
+    }
   }
 
   if (output_directory_) {
@@ -696,6 +745,135 @@ Status CompactionJob::Run() {
   return status;
 }
 
+namespace {
+// Deletes dir and the files in it, if it exists
+void DeleteCompactionServiceDir(Env* env, const std::string& dir) {
+  std::vector<std::string> children;
+  if (!env->GetChildren(dir, &children).ok()) {
+    return;
+  }
+  for (const auto& child : children) {
+    if (child != "." && child != "..") {
+      env->DeleteFile(dir + "/" + child);
+    }
+  }
+  env->DeleteDir(dir);
+}
+}  // namespace
+
+Status CompactionJob::RunWithCompactionService() {
+  Compaction* c = compact_->compaction;
+  if (snapshot_checker_ != nullptr) {
+    // The snapshots of WritePrepared transactions cannot be handed over
+    return Status::NotSupported();
+  }
+  ColumnFamilyData* cfd = c->column_family_data();
+  const auto& cf_paths = c->immutable_cf_options()->cf_paths;
+
+  CompactionServiceInput input;
+  input.db_name = dbname_;
+  input.column_family_name = cfd->GetName();
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (const FileMetaData* f : *c->inputs(i)) {
+      input.input_files.push_back(TableFileName(
+          cf_paths, f->fd.GetNumber(), f->fd.GetPathId()));
+    }
+  }
+  input.output_level = c->output_level();
+  input.bottommost_level = c->bottommost_level();
+  input.compression = c->output_compression();
+  input.max_output_file_size = c->max_output_file_size();
+  input.snapshots = existing_snapshots_;
+  input.earliest_write_conflict_snapshot = earliest_write_conflict_snapshot_;
+  // A directory next to the output level's files, so that the output files
+  // can be renamed into place. It may be left over from before a crash.
+  input.output_directory = cf_paths[c->output_path_id()].path +
+                           "/compaction_service_" + ToString(job_id_);
+  DeleteCompactionServiceDir(env_, input.output_directory);
+  Status s = env_->CreateDir(input.output_directory);
+
+  CompactionServiceResult result;
+  if (s.ok()) {
+    s = db_options_.compaction_service->Compact(input, &result);
+  }
+
+  SubcompactionState* sub_compact = &compact_->sub_compact_states[0];
+  auto sfm =
+      static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+  for (size_t i = 0; s.ok() && i < result.output_files.size(); i++) {
+    const CompactionServiceOutputFile& file = result.output_files[i];
+    SubcompactionState::Output out;
+    out.meta.fd = FileDescriptor(versions_->NewFileNumber(),
+                                 c->output_path_id(), file.file_size,
+                                 file.smallest_seqno, file.largest_seqno);
+    out.meta.smallest.DecodeFrom(file.smallest_internal_key);
+    out.meta.largest.DecodeFrom(file.largest_internal_key);
+    out.finished = true;
+    std::string fname = TableFileName(cf_paths, out.meta.fd.GetNumber(),
+                                      out.meta.fd.GetPathId());
+    s = env_->RenameFile(input.output_directory + "/" + file.file_name,
+                         fname);
+    if (s.ok()) {
+      if (sfm) {
+        sfm->OnAddFile(fname);
+      }
+      // Reported to the listeners, as for the outputs written here
+      s = cfd->table_cache()->GetTableProperties(
+          env_options_, cfd->internal_comparator(), out.meta.fd,
+          &out.table_properties,
+          c->mutable_cf_options()->prefix_extractor.get());
+    }
+    if (s.ok()) {
+      sub_compact->outputs.push_back(out);
+      sub_compact->total_bytes += file.file_size;
+    }
+  }
+  DeleteCompactionServiceDir(env_, input.output_directory);
+
+  if (s.ok()) {
+    sub_compact->num_input_records = result.num_input_records;
+    sub_compact->num_output_records = result.num_output_records;
+  } else {
+    // The files that were moved are deleted as obsolete files
+    sub_compact->outputs.clear();
+    sub_compact->total_bytes = 0;
+  }
+  return s;
+}
+
+Status CompactionJob::FinishWithoutInstallation(
+    CompactionServiceResult* result) {
+  db_mutex_->AssertHeld();
+  Status status = compact_->status;
+  if (!status.ok()) {
+    CleanupCompaction();
+    return status;
+  }
+  const Compaction* c = compact_->compaction;
+  const std::string& output_path =
+      c->immutable_cf_options()->cf_paths[c->output_path_id()].path;
+  result->output_files.clear();
+  for (const auto& state : compact_->sub_compact_states) {
+    for (const auto& output : state.outputs) {
+      CompactionServiceOutputFile file;
+      // The part after output_path + "/"
+      file.file_name =
+          MakeTableFileName(output_path, output.meta.fd.GetNumber())
+              .substr(output_path.size() + 1);
+      file.file_size = output.meta.fd.GetFileSize();
+      file.smallest_internal_key = output.meta.smallest.Encode().ToString();
+      file.largest_internal_key = output.meta.largest.Encode().ToString();
+      file.smallest_seqno = output.meta.fd.smallest_seqno;
+      file.largest_seqno = output.meta.fd.largest_seqno;
+      result->output_files.push_back(std::move(file));
+    }
+  }
+  result->num_input_records = compact_->num_input_records;
+  result->num_output_records = compact_->num_output_records;
+  CleanupCompaction();
+  return status;
+}
+
 Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_INSTALL);
@@ -34,6 +34,7 @@
 #include "port/port.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/compaction_job_stats.h"
+#include "rocksdb/compaction_service.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
@@ -89,11 +90,21 @@ class CompactionJob {
   // REQUIRED: mutex held
   Status Install(const MutableCFOptions& mutable_cf_options);
 
+  // Replaces Install() for a compaction that another DB handed over through
+  // its CompactionService: describes the output files in result, for that
+  // DB to install them.
+  // REQUIRED: mutex held
+  Status FinishWithoutInstallation(CompactionServiceResult* result);
+
  private:
   struct SubcompactionState;
 
   void AggregateStatistics();
   void GenSubcompactionBoundaries();
+  // Hands the compaction to db_options_.compaction_service, and moves the
+  // output files it returns into the DB as the outputs of the first
+  // subcompaction. On error, nothing is left to install.
+  Status RunWithCompactionService();
 
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
@@ -0,0 +1,77 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/compaction_service.h"
+
+#include "port/port.h"
+#include "rocksdb/db.h"
+#include "rocksdb/threadpool.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+#ifndef ROCKSDB_LITE
+namespace {
+
+class ThreadPoolCompactionService : public CompactionService {
+ public:
+  ThreadPoolCompactionService(const Options& options, int num_threads,
+                              bool bottommost_only)
+      : options_(options),
+        thread_pool_(NewThreadPool(num_threads)),
+        bottommost_only_(bottommost_only) {
+    // The compactions run here must not be handed over again
+    options_.compaction_service = nullptr;
+  }
+
+  ~ThreadPoolCompactionService() { thread_pool_->JoinAllThreads(); }
+
+  const char* Name() const override { return "ThreadPoolCompactionService"; }
+
+  Status Compact(const CompactionServiceInput& input,
+                 CompactionServiceResult* result) override {
+    if (bottommost_only_ && !input.bottommost_level) {
+      return Status::NotSupported();
+    }
+    port::Mutex mu;
+    port::CondVar cv(&mu);
+    bool done = false;
+    Status s;
+    thread_pool_->SubmitJob([&]() {
+      Status job_status = DB::OpenAndCompact(options_, input, result);
+      MutexLock l(&mu);
+      s = job_status;
+      done = true;
+      cv.SignalAll();
+    });
+    MutexLock l(&mu);
+    while (!done) {
+      cv.Wait();
+    }
+    return s;
+  }
+
+ private:
+  Options options_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  const bool bottommost_only_;
+};
+
+}  // namespace
+
+std::shared_ptr<CompactionService> NewThreadPoolCompactionService(
+    const Options& options, int num_threads, bool bottommost_only) {
+  return std::make_shared<ThreadPoolCompactionService>(options, num_threads,
+                                                       bottommost_only);
+}
+#else
+std::shared_ptr<CompactionService> NewThreadPoolCompactionService(
+    const Options& /*options*/, int /*num_threads*/,
+    bool /*bottommost_only*/) {
+  return nullptr;
+}
+#endif  // !ROCKSDB_LITE
+
+}  // namespace rocksdb
@@ -0,0 +1,271 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/concurrent_log_writer.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/file_reader_writer.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+namespace log {
+
+ConcurrentWriter::ConcurrentWriter(std::unique_ptr<WritableFileWriter>&& dest,
+                                   uint64_t log_number, bool recycle_log_files,
+                                   size_t buffer_size, bool use_fsync)
+    : dest_(std::move(dest)),
+      log_number_(log_number),
+      recycle_log_files_(recycle_log_files),
+      header_size_(recycle_log_files ? kRecyclableHeaderSize : kHeaderSize),
+      use_fsync_(use_fsync),
+      buffer_size_(std::max(buffer_size, static_cast<size_t>(2 * kBlockSize))),
+      buffer_(new char[buffer_size_]),
+      reserved_(0),
+      filled_(0),
+      flushed_(0),
+      synced_(0),
+      work_cv_(&mutex_),
+      done_cv_(&mutex_),
+      sync_requested_(0),
+      closing_(false),
+      closed_(false),
+      flush_thread_(&ConcurrentWriter::BGWorkFlush, this) {
+  for (int i = 0; i <= kMaxRecordType; i++) {
+    char t = static_cast<char>(i);
+    type_crc_[i] = crc32c::Value(&t, 1);
+  }
+}
+
+ConcurrentWriter::~ConcurrentWriter() { Close(); }
+
+Status ConcurrentWriter::AddRecord(const Slice& slice, bool sync) {
+  uint64_t start = reserved_.load(std::memory_order_relaxed);
+  uint64_t end;
+  do {
+    end = RecordEnd(start, slice.size());
+  } while (!reserved_.compare_exchange_weak(start, end,
+                                            std::memory_order_relaxed));
+
+  if (end - start <= buffer_size_) {
+    if (WaitForRoom(end)) {
+      EmitRecord(start, slice, false /* in_pieces */);
+    }
+    Publish(start, end);
+  } else {
+    // The record cannot be in the buffer at once, so it is copied as the
+    // flush thread makes room, which it only does in file order.
+    while (filled_.load(std::memory_order_acquire) != start) {
+      std::this_thread::yield();
+    }
+    EmitRecord(start, slice, true /* in_pieces */);
+  }
+
+  MutexLock l(&mutex_);
+  if (sync && sync_requested_ < end) {
+    sync_requested_ = end;
+  }
+  work_cv_.Signal();
+  while (status_.ok() &&
+         (flushed_.load(std::memory_order_relaxed) < end ||
+          (sync && synced_ < end))) {
+    done_cv_.Wait();
+  }
+  return status_;
+}
+
+Status ConcurrentWriter::Close() {
+  {
+    MutexLock l(&mutex_);
+    if (closed_) {
+      return status_;
+    }
+    closing_ = true;
+    work_cv_.Signal();
+  }
+  flush_thread_.join();
+  MutexLock l(&mutex_);
+  closed_ = true;
+  return status_;
+}
+
+uint64_t ConcurrentWriter::RecordEnd(uint64_t offset, size_t length) const {
+  size_t left = length;
+  // An empty record still takes a header.
+  do {
+    size_t leftover = kBlockSize - offset % kBlockSize;
+    if (leftover < header_size_) {
+      offset += leftover;
+      leftover = kBlockSize;
+    }
+    const size_t fragment_length = std::min(left, leftover - header_size_);
+    offset += header_size_ + fragment_length;
+    left -= fragment_length;
+  } while (left > 0);
+  return offset;
+}
+
+void ConcurrentWriter::EmitRecord(uint64_t offset, const Slice& slice,
+                                  bool in_pieces) {
+  // Zeroes for the trailer of a block (relies on kHeaderSize and
+  // kRecyclableHeaderSize being <= 11)
+  static const char kTrailer[kRecyclableHeaderSize] = {0};
+
+  const char* ptr = slice.data();
+  size_t left = slice.size();
+  bool begin = true;
+  do {
+    size_t leftover = kBlockSize - offset % kBlockSize;
+    if (leftover < header_size_) {
+      // Switch to a new block
+      Emit(offset, kTrailer, leftover, in_pieces);
+      offset += leftover;
+      leftover = kBlockSize;
+    }
+
+    const size_t fragment_length = std::min(left, leftover - header_size_);
+    const bool end = (left == fragment_length);
+    RecordType type;
+    if (begin && end) {
+      type = recycle_log_files_ ? kRecyclableFullType : kFullType;
+    } else if (begin) {
+      type = recycle_log_files_ ? kRecyclableFirstType : kFirstType;
+    } else if (end) {
+      type = recycle_log_files_ ? kRecyclableLastType : kLastType;
+    } else {
+      type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
+    }
+
+    // Format the header, as in Writer::EmitPhysicalRecord().
+    char buf[kRecyclableHeaderSize];
+    buf[4] = static_cast<char>(fragment_length & 0xff);
+    buf[5] = static_cast<char>(fragment_length >> 8);
+    buf[6] = static_cast<char>(type);
+    uint32_t crc = type_crc_[type];
+    if (recycle_log_files_) {
+      EncodeFixed32(buf + 7, static_cast<uint32_t>(log_number_));
+      crc = crc32c::Extend(crc, buf + 7, 4);
+    }
+    crc = crc32c::Extend(crc, ptr, fragment_length);
+    EncodeFixed32(buf, crc32c::Mask(crc));
+
+    Emit(offset, buf, header_size_, in_pieces);
+    Emit(offset + header_size_, ptr, fragment_length, in_pieces);
+    offset += header_size_ + fragment_length;
+    ptr += fragment_length;
+    left -= fragment_length;
+    begin = false;
+  } while (left > 0);
+}
+
+void ConcurrentWriter::Emit(uint64_t offset, const char* data, size_t n,
+                            bool in_pieces) {
+  if (!in_pieces) {
+    CopyToBuffer(offset, data, n);
+    return;
+  }
+  if (n == 0) {
+    return;
+  }
+  if (WaitForRoom(offset + n)) {
+    CopyToBuffer(offset, data, n);
+  }
+  filled_.store(offset + n, std::memory_order_release);
+  MutexLock l(&mutex_);
+  work_cv_.Signal();
+}
+
+void ConcurrentWriter::CopyToBuffer(uint64_t offset, const char* data,
+                                    size_t n) {
+  const size_t pos = static_cast<size_t>(offset % buffer_size_);
+  const size_t first = std::min(n, buffer_size_ - pos);
+  memcpy(buffer_.get() + pos, data, first);
+  if (first < n) {
+    memcpy(buffer_.get(), data + first, n - first);
+  }
+}
+
+bool ConcurrentWriter::WaitForRoom(uint64_t end) {
+  if (end - flushed_.load(std::memory_order_acquire) <= buffer_size_) {
+    return true;
+  }
+  MutexLock l(&mutex_);
+  while (status_.ok() &&
+         end - flushed_.load(std::memory_order_relaxed) > buffer_size_) {
+    done_cv_.Wait();
+  }
+  return status_.ok();
+}
+
+void ConcurrentWriter::Publish(uint64_t start, uint64_t end) {
+  // The records before this one were reserved earlier, and are normally
+  // copied already.
+  while (filled_.load(std::memory_order_acquire) != start) {
+    std::this_thread::yield();
+  }
+  filled_.store(end, std::memory_order_release);
+}
+
+void ConcurrentWriter::BGWorkFlush() {
+  mutex_.Lock();
+  while (true) {
+    const uint64_t flushed = flushed_.load(std::memory_order_relaxed);
+    const uint64_t filled = filled_.load(std::memory_order_acquire);
+    const bool need_sync = sync_requested_ > synced_;
+    if (filled == flushed && !need_sync) {
+      if (closing_) {
+        break;
+      }
+      work_cv_.Wait();
+      continue;
+    }
+    if (!status_.ok()) {
+      // The writers return the error instead of waiting for their records.
+      flushed_.store(filled, std::memory_order_release);
+      synced_ = filled;
+      done_cv_.SignalAll();
+      continue;
+    }
+
+    // Write all the bytes published so far with a single write, and sync
+    // them at once for all the writers that asked for it.
+    mutex_.Unlock();
+    Status s;
+    if (filled > flushed) {
+      const size_t pos = static_cast<size_t>(flushed % buffer_size_);
+      const size_t n = static_cast<size_t>(filled - flushed);
+      const size_t first = std::min(n, buffer_size_ - pos);
+      s = dest_->Append(Slice(buffer_.get() + pos, first));
+      if (s.ok() && first < n) {
+        s = dest_->Append(Slice(buffer_.get(), n - first));
+      }
+      if (s.ok()) {
+        s = dest_->Flush();
+      }
+    }
+    if (s.ok() && need_sync) {
+      s = dest_->Sync(use_fsync_);
+    }
+    mutex_.Lock();
+
+    if (!s.ok() && status_.ok()) {
+      status_ = s;
+    }
+    flushed_.store(filled, std::memory_order_release);
+    if (s.ok() && need_sync) {
+      synced_ = filled;
+    }
+    done_cv_.SignalAll();
+  }
+  mutex_.Unlock();
+}
+
+}  // namespace log
+}  // namespace rocksdb
@@ -0,0 +1,130 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "db/log_format.h"
+#include "port/port.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+class WritableFileWriter;
+
+namespace log {
+
+/**
+ * ConcurrentWriter is a log writer that several threads can append to at
+ * the same time. It writes the same file format as log::Writer, so the file
+ * can be read back with log::Reader.
+ *
+ * Each AddRecord() reserves the bytes of its record in the file by advancing
+ * a shared offset with a compare-and-swap, then computes the CRCs and copies
+ * the record into a shared ring buffer, in parallel with the other writers.
+ * Records are published in file order, and a dedicated thread writes the
+ * published bytes to the file. All the records published while that thread
+ * writes or syncs the file are written, and synced if any of them asked for
+ * it, with the next single write: the batching adapts to the load.
+ *
+ * A record larger than the ring buffer is copied in pieces, once all the
+ * records before it are published.
+ */
+class ConcurrentWriter {
+ public:
+  // Create a writer that will append data to "*dest", which must be
+  // initially empty. buffer_size is the size of the ring buffer, which is
+  // at least two log blocks.
+  ConcurrentWriter(std::unique_ptr<WritableFileWriter>&& dest,
+                   uint64_t log_number, bool recycle_log_files,
+                   size_t buffer_size = 4 << 20, bool use_fsync = false);
+
+  // Calls Close() if it was not called.
+  ~ConcurrentWriter();
+
+  // Append a record to the log. Returns once the record is written to the
+  // file, and synced if sync is true. Safe to call from several threads.
+  Status AddRecord(const Slice& slice, bool sync = false);
+
+  // Write the records that are left and stop the flush thread. Returns the
+  // first error hit by the writes.
+  // REQUIRES: no AddRecord() is in progress, and none is started after it.
+  Status Close();
+
+  WritableFileWriter* file() { return dest_.get(); }
+  const WritableFileWriter* file() const { return dest_.get(); }
+
+  uint64_t get_log_number() const { return log_number_; }
+
+ private:
+  // Returns the offset where a record of length bytes that starts at offset
+  // ends, including the padding of the blocks it does not fit in.
+  uint64_t RecordEnd(uint64_t offset, size_t length) const;
+
+  // Format the record that starts at offset into the ring buffer. If
+  // in_pieces, the record is at the head of the unpublished records and is
+  // published one fragment at a time, waiting for room in the buffer.
+  void EmitRecord(uint64_t offset, const Slice& slice, bool in_pieces);
+
+  void Emit(uint64_t offset, const char* data, size_t n, bool in_pieces);
+
+  // Copy n bytes to the ring buffer position of the file offset.
+  void CopyToBuffer(uint64_t offset, const char* data, size_t n);
+
+  // Wait until the ring buffer has room for the bytes up to end. Returns
+  // false if a write failed, in which case nothing needs to be copied.
+  bool WaitForRoom(uint64_t end);
+
+  // Publish [start, end) once the records before it are published.
+  void Publish(uint64_t start, uint64_t end);
+
+  void BGWorkFlush();
+
+  std::unique_ptr<WritableFileWriter> dest_;
+  const uint64_t log_number_;
+  const bool recycle_log_files_;
+  const size_t header_size_;
+  const bool use_fsync_;
+
+  // crc32c values for all supported record types.
+  uint32_t type_crc_[kMaxRecordType + 1];
+
+  const size_t buffer_size_;
+  std::unique_ptr<char[]> buffer_;
+
+  // File offsets. reserved_ is the end of the last reserved record, filled_
+  // the end of the bytes copied in full into the buffer, flushed_ and
+  // synced_ the end of the bytes written and synced to the file.
+  // reserved_ >= filled_ >= flushed_ >= synced_.
+  std::atomic<uint64_t> reserved_;
+  std::atomic<uint64_t> filled_;
+  std::atomic<uint64_t> flushed_;
+  uint64_t synced_;
+
+  // Protects the fields below, and is used to wait on flushed_ and synced_.
+  port::Mutex mutex_;
+  // Signaled when bytes are published, or on Close().
+  port::CondVar work_cv_;
+  // Signaled when bytes are written or synced.
+  port::CondVar done_cv_;
+  // End of the last published record that asked for a sync.
+  uint64_t sync_requested_;
+  Status status_;
+  bool closing_;
+  bool closed_;
+  port::Thread flush_thread_;
+
+  // No copying allowed
+  ConcurrentWriter(const ConcurrentWriter&) = delete;
+  void operator=(const ConcurrentWriter&) = delete;
+};
+
+}  // namespace log
+}  // namespace rocksdb
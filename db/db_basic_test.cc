@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/iostats_context.h"
 #include "rocksdb/perf_context.h"
 #include "util/fault_injection_test_env.h"
 #if !defined(ROCKSDB_LITE)
@@ -790,6 +791,147 @@ TEST_F(DBBasicTest, MultiGetEmpty) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, MultiGetBatchedSimple) {
+  do {
+    CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
+    SetPerfLevel(kEnableCount);
+    ASSERT_OK(Put(1, "k1", "v1"));
+    ASSERT_OK(Put(1, "k2", "v2"));
+    ASSERT_OK(Put(1, "k3", "v3"));
+    ASSERT_OK(Put(1, "k4", "v4"));
+    ASSERT_OK(Delete(1, "k4"));
+    ASSERT_OK(Put(1, "k5", "v5"));
+    ASSERT_OK(Delete(1, "no_key"));
+
+    // Unsorted, with a duplicate
+    std::vector<Slice> keys({"no_key", "k5", "k4", "k3", "k2", "k1", "k3"});
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> s(keys.size());
+
+    get_perf_context()->Reset();
+    db_->MultiGet(ReadOptions(), handles_[1], keys.size(), keys.data(),
+                  values.data(), s.data());
+    ASSERT_TRUE(s[0].IsNotFound());
+    ASSERT_OK(s[1]);
+    ASSERT_EQ(values[1], "v5");
+    ASSERT_TRUE(s[2].IsNotFound());
+    ASSERT_OK(s[3]);
+    ASSERT_EQ(values[3], "v3");
+    ASSERT_OK(s[4]);
+    ASSERT_EQ(values[4], "v2");
+    ASSERT_OK(s[5]);
+    ASSERT_EQ(values[5], "v1");
+    ASSERT_OK(s[6]);
+    ASSERT_EQ(values[6], "v3");
+    // five kv pairs * two bytes per value
+    ASSERT_EQ(10, (int)get_perf_context()->multiget_read_bytes);
+    SetPerfLevel(kDisable);
+  } while (ChangeCompactOptions());
+}
+
+TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 256;
+  table_options.block_cache = NewLRUCache(1 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  const int kNumKeys = 300;
+  // Oldest versions in L2, overwritten in parts by L1, L0 and the memtable.
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "l2_" + Key(i)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  for (int i = 0; i < kNumKeys; i += 3) {
+    ASSERT_OK(Put(Key(i), "l1_" + Key(i)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  for (int i = 0; i < kNumKeys; i += 5) {
+    ASSERT_OK(Merge(Key(i), "l0"));
+  }
+  for (int i = 0; i < kNumKeys; i += 7) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < kNumKeys; i += 11) {
+    ASSERT_OK(Put(Key(i), "mem_" + Key(i)));
+  }
+  ASSERT_EQ("1,1,1", FilesPerLevel());
+
+  std::vector<std::string> key_strs;
+  for (int i = kNumKeys + 10; i >= 0; i -= 2) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  for (int cached = 0; cached < 2; ++cached) {
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> s(keys.size());
+    db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), s.data());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      std::string expected;
+      Status expected_s = db_->Get(ReadOptions(), keys[i], &expected);
+      ASSERT_EQ(expected_s.ToString(), s[i].ToString()) << keys[i].ToString();
+      if (expected_s.ok()) {
+        ASSERT_EQ(expected, values[i].ToString()) << keys[i].ToString();
+      }
+    }
+  }
+}
+
+TEST_F(DBBasicTest, MultiGetBatchedCoalescesBlockReads) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 128;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 64)));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys; ++i) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> s(keys.size());
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1U, props.size());
+  const TableProperties* tp = props.begin()->second.get();
+  ASSERT_GT(tp->num_data_blocks, 1U);
+
+  SetPerfLevel(kEnableCount);
+  get_perf_context()->Reset();
+  uint64_t bytes_read_before = get_iostats_context()->bytes_read;
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                keys.data(), values.data(), s.data(), true /* sorted_input */);
+  uint64_t bytes_read = get_iostats_context()->bytes_read - bytes_read_before;
+  SetPerfLevel(kDisable);
+  // Every data block of the file is read exactly once, even though most of
+  // them hold several of the keys.
+  ASSERT_EQ(tp->num_data_blocks, get_perf_context()->block_read_count);
+  ASSERT_GE(get_perf_context()->block_read_byte, tp->data_size);
+  ASSERT_LT(bytes_read, 2 * tp->data_size);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_OK(s[i]);
+    ASSERT_EQ(Get(key_strs[i]), values[i].ToString());
+  }
+}
+
 TEST_F(DBBasicTest, ChecksumTest) {
   BlockBasedTableOptions table_options;
   Options options = CurrentOptions();
@@ -10,6 +10,7 @@
 #include "cache/lru_cache.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/secondary_cache.h"
 
 namespace rocksdb {
 
@@ -254,6 +255,55 @@ TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
 
 // Make sure that when options.block_cache is set, after a new table is
 // created its index/filter blocks are added to block cache.
+TEST_F(DBBlockCacheTest, TestWithSecondaryCache) {
+  ReadOptions read_options;
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+
+  std::shared_ptr<SecondaryCache> secondary_cache =
+      NewCompressedSecondaryCache(
+          CompressedSecondaryCacheOptions(1 << 25, 0, kLZ4Compression));
+  // Blocks do not fit the primary tier, so they are demoted as soon as they
+  // are released.
+  LRUCacheOptions cache_opts(0 /*capacity*/, 0 /*num_shard_bits*/,
+                             false /*strict_capacity_limit*/,
+                             0.0 /*high_pri_pool_ratio*/);
+  cache_opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_opts);
+  table_options.block_cache = cache;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  RecordCacheCounters(options);
+
+  // Load blocks from the table.
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->Seek(ToString(i));
+    ASSERT_OK(iter->status());
+    CheckCacheCounters(options, 1, 0, 1, 0);
+  }
+  ASSERT_EQ(0, cache->GetUsage());
+  size_t secondary_usage = secondary_cache->GetUsage();
+  ASSERT_LT(0, secondary_usage);
+  ASSERT_EQ(0, TestGetTickerCount(options, SECONDARY_CACHE_HITS));
+  ASSERT_EQ(kNumBlocks, TestGetTickerCount(options, SECONDARY_CACHE_MISSES));
+
+  // Blocks are now promoted from the secondary tier.
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->Seek(ToString(i));
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(ToString(i), iter->key().ToString());
+    ASSERT_EQ(std::string(kValueSize, 'a'), iter->value().ToString());
+    CheckCacheCounters(options, 0, 1, 0, 0);
+  }
+  ASSERT_EQ(kNumBlocks, TestGetTickerCount(options, SECONDARY_CACHE_HITS));
+  ASSERT_EQ(kNumBlocks, TestGetTickerCount(options, SECONDARY_CACHE_MISSES));
+  ASSERT_EQ(secondary_usage, secondary_cache->GetUsage());
+}
+
 TEST_F(DBBlockCacheTest, IndexAndFilterBlocksOfNewTableAddedToCache) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -532,6 +532,128 @@ TEST_F(DBBloomFilterTest, BloomFilterCompatibility) {
   ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 0);
 }
 
+TEST_F(DBBloomFilterTest, SplitBlockBloomFilter) {
+  for (bool partition_filters : {false, true}) {
+    Options options = CurrentOptions();
+    options.statistics = rocksdb::CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    if (partition_filters) {
+      table_options.partition_filters = true;
+      table_options.index_type =
+          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      table_options.metadata_block_size = 1024;
+    }
+    table_options.filter_policy.reset(NewBloomFilterPolicy(
+        10, false /* use_block_based_builder */,
+        1 /* full_filter_format_version */));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    const int maxKey = 10000;
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_OK(Put(Key(i), Key(i)));
+    }
+    ASSERT_OK(Put(Key(maxKey + 55555), Key(maxKey + 55555)));
+    Flush();
+
+    // Read with either format configured, the filters record their own
+    for (int read_format : {1, 0}) {
+      table_options.filter_policy.reset(
+          NewBloomFilterPolicy(10, false, read_format));
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      Reopen(options);
+      options.statistics->setTickerCount(BLOOM_FILTER_USEFUL, 0);
+
+      for (int i = 0; i < maxKey; i++) {
+        ASSERT_EQ(Key(i), Get(Key(i)));
+      }
+      ASSERT_EQ(0, TestGetTickerCount(options, BLOOM_FILTER_USEFUL));
+      for (int i = 0; i < maxKey; i++) {
+        ASSERT_EQ("NOT_FOUND", Get(Key(i + 33333)));
+      }
+      ASSERT_GE(TestGetTickerCount(options, BLOOM_FILTER_USEFUL),
+                maxKey * 0.97);
+
+      // The batched MultiGet checks the filter for all the keys together
+      std::vector<std::string> key_strs;
+      for (int i = 0; i < 100; i++) {
+        key_strs.push_back(Key(i * 2));
+        key_strs.push_back(Key(i + 33333));
+      }
+      std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+      std::vector<PinnableSlice> values(keys.size());
+      std::vector<Status> statuses(keys.size());
+      options.statistics->setTickerCount(BLOOM_FILTER_USEFUL, 0);
+      db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), keys.size(),
+                    keys.data(), values.data(), statuses.data());
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (i % 2 == 0) {
+          ASSERT_OK(statuses[i]);
+          ASSERT_EQ(key_strs[i], values[i]);
+        } else {
+          ASSERT_TRUE(statuses[i].IsNotFound());
+        }
+      }
+      ASSERT_GE(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 90);
+    }
+  }
+}
+
+TEST_F(DBBloomFilterTest, RibbonFilterStartLevel) {
+  for (bool partition_filters : {false, true}) {
+    Options options = CurrentOptions();
+    options.statistics = rocksdb::CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    if (partition_filters) {
+      table_options.partition_filters = true;
+      table_options.index_type =
+          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      table_options.metadata_block_size = 1024;
+    }
+    table_options.filter_policy.reset(
+        NewRibbonFilterPolicy(10, 1 /* ribbon_start_level */));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    // Two overlapping L0 files, so that the compaction rewrites them
+    const int maxKey = 10000;
+    for (int odd = 0; odd < 2; odd++) {
+      for (int i = odd; i < maxKey; i += 2) {
+        ASSERT_OK(Put(Key(i), Key(i)));
+      }
+      ASSERT_OK(Put(Key(maxKey + 55555), Key(maxKey + 55555)));
+      Flush();
+    }
+    ASSERT_EQ("2", FilesPerLevel());
+    TablePropertiesCollection props;
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+    ASSERT_EQ(2U, props.size());
+    uint64_t bloom_filter_size = 0;
+    for (const auto& file_props : props) {
+      bloom_filter_size += file_props.second->filter_size;
+    }
+
+    // The compaction output in L1 gets a Ribbon filter of the same false
+    // positive rate, in at most 80% of the space
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_EQ("0,1", FilesPerLevel());
+    props.clear();
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+    ASSERT_EQ(1U, props.size());
+    ASSERT_LT(props.begin()->second->filter_size, bloom_filter_size * 0.8);
+
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_EQ(Key(i), Get(Key(i)));
+    }
+    ASSERT_EQ(0, TestGetTickerCount(options, BLOOM_FILTER_USEFUL));
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_EQ("NOT_FOUND", Get(Key(i + 33333)));
+    }
+    ASSERT_GE(TestGetTickerCount(options, BLOOM_FILTER_USEFUL),
+              maxKey * 0.98);
+  }
+}
+
 TEST_F(DBBloomFilterTest, BloomFilterReverseCompatibility) {
   for (bool partition_filters : {true, false}) {
     Options options = CurrentOptions();
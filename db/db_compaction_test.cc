@@ -10,6 +10,7 @@
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
 #include "port/port.h"
+#include "rocksdb/compaction_service.h"
 #include "rocksdb/experimental.h"
 #include "rocksdb/utilities/convenience.h"
 #include "util/sync_point.h"
@@ -3353,6 +3354,194 @@ TEST_F(DBCompactionTest, CompactBottomLevelFilesWithDeletions) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBCompactionTest, SubcompactionsFromNonL0Level) {
+  const int kNumKeys = 4096;
+  const int kValueSize = 128;
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  options.target_file_size_base = 64 << 10;
+  options.max_bytes_for_level_base = 64 << 10;
+  options.max_subcompactions = 4;
+  options.statistics = rocksdb::CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  // Fill L2 with 8 files of consecutive key ranges
+  const int kNumL2Files = 8;
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumL2Files; i++) {
+    for (int j = 0; j < kNumKeys / kNumL2Files; j++) {
+      values.push_back(RandomString(&rnd, kValueSize));
+      ASSERT_OK(Put(Key(static_cast<int>(values.size()) - 1), values.back()));
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(2);
+  }
+  ASSERT_EQ(kNumL2Files, NumTableFilesAtLevel(2));
+
+  // Overwrite every other key into a single L1 file that overlaps them all
+  for (int i = 0; i < kNumKeys; i += 2) {
+    values[i] = RandomString(&rnd, kValueSize);
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(1, NumTableFilesAtLevel(1));
+
+  // The automatic L1->L2 compaction is split into subcompactions
+  int start_level = -1;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "LevelCompactionPicker::PickCompaction:Return", [&](void* arg) {
+        start_level = reinterpret_cast<Compaction*>(arg)->start_level();
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  options.statistics->Reset();
+  ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "false"}}));
+  dbfull()->TEST_WaitForCompact();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(1, start_level);
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_GT(subcompactions.max, 1);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+namespace {
+class CountingCompactionService : public CompactionService {
+ public:
+  explicit CountingCompactionService(
+      std::shared_ptr<CompactionService> target)
+      : target_(target), compactions_(0), declined_(0) {}
+
+  const char* Name() const override { return "CountingCompactionService"; }
+
+  Status Compact(const CompactionServiceInput& input,
+                 CompactionServiceResult* result) override {
+    Status s = target_->Compact(input, result);
+    if (s.ok()) {
+      compactions_++;
+    } else if (s.IsNotSupported()) {
+      declined_++;
+    }
+    return s;
+  }
+
+  int compactions() const { return compactions_.load(); }
+  int declined() const { return declined_.load(); }
+
+ private:
+  std::shared_ptr<CompactionService> target_;
+  std::atomic<int> compactions_;
+  std::atomic<int> declined_;
+};
+}  // namespace
+
+TEST_F(DBCompactionTest, CompactionService) {
+  const int kNumKeys = 100;
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  auto service = std::make_shared<CountingCompactionService>(
+      NewThreadPoolCompactionService(options, 1));
+  options.compaction_service = service;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "v1"));
+  }
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  for (int i = 0; i < kNumKeys; i++) {
+    if (i % 3 == 0) {
+      ASSERT_OK(Delete(Key(i)));
+    } else if (i % 2 == 0) {
+      ASSERT_OK(Put(Key(i), "v2"));
+    }
+  }
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service->compactions(), 0);
+  ASSERT_EQ(0, service->declined());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      if (i % 3 == 0) {
+        ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+      } else if (i % 2 == 0) {
+        ASSERT_EQ("v2", Get(Key(i)));
+      } else {
+        ASSERT_EQ("v1", Get(Key(i)));
+      }
+    }
+  };
+  verify();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("v1", Get(Key(i), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+
+  // The output directories of the service are gone
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(dbname_, &children));
+  for (const auto& child : children) {
+    ASSERT_EQ(std::string::npos, child.find("compaction_service_"));
+  }
+
+  // The output files were installed like local ones
+  Reopen(options);
+  verify();
+}
+
+TEST_F(DBCompactionTest, CompactionServiceBottommostOnly) {
+  const int kNumKeys = 100;
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  auto service = std::make_shared<CountingCompactionService>(
+      NewThreadPoolCompactionService(options, 1, true /* bottommost_only */));
+  options.compaction_service = service;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "v1"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), "v2"));
+    ASSERT_OK(Flush());
+  }
+
+  // L0->L1 is not bottommost, so the DB runs it itself
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  std::vector<std::string> input_filenames;
+  for (const auto& file : cf_meta.levels[0].files) {
+    input_filenames.push_back(file.name);
+  }
+  ASSERT_OK(db_->CompactFiles(CompactionOptions(), input_filenames, 1));
+  ASSERT_EQ(1, service->declined());
+  ASSERT_EQ(0, service->compactions());
+  ASSERT_EQ(1, NumTableFilesAtLevel(1));
+
+  // L1->L2 is
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(1, service->compactions());
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 ? "v2" : "v1", Get(Key(i)));
+  }
+}
+
 TEST_F(DBCompactionTest, LevelCompactExpiredTtlFiles) {
   const int kNumKeysPerFile = 32;
   const int kNumLevelFiles = 2;
@@ -3822,6 +4011,38 @@ INSTANTIATE_TEST_CASE_P(DBCompactionTestWithParam, DBCompactionTestWithParam,
                                           std::make_tuple(4, true),
                                           std::make_tuple(4, false)));
 
+TEST_F(DBCompactionTest, CompactionAsyncReadahead) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compaction_async_readahead = true;
+  options.compaction_readahead_size = 64 << 10;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int file = 0; file < 4; ++file) {
+    for (int i = 0; i < 200; ++i) {
+      if (file == 0) {
+        values.push_back(RandomString(&rnd, 500));
+      } else if (i % (file + 1) == 0) {
+        values[i] = RandomString(&rnd, 500);
+      } else {
+        continue;
+      }
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel(0));
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
 TEST_P(DBCompactionDirectIOTest, DirectIO) {
   Options options = CurrentOptions();
   Destroy(options);
@@ -213,6 +213,109 @@ TEST_F(DBFlushTest, FlushError) {
   ASSERT_NE(s, Status::OK());
 }
 
+TEST_F(DBFlushTest, ManualAtomicFlush) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.atomic_flush = true;
+  options.write_buffer_size = (static_cast<size_t>(64) << 20);
+
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+  size_t num_cfs = handles_.size();
+  ASSERT_EQ(3U, num_cfs);
+  WriteOptions wopts;
+  wopts.disableWAL = true;
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ASSERT_OK(Put(static_cast<int>(i) /*cf*/, "key", "value", wopts));
+  }
+  // Flushing one column family flushes all of them.
+  ASSERT_OK(Flush(0));
+  for (size_t i = 0; i != num_cfs; ++i) {
+    auto cfd = static_cast<ColumnFamilyHandleImpl*>(handles_[i])->cfd();
+    ASSERT_EQ(0, cfd->imm()->NumNotFlushed());
+    ASSERT_TRUE(cfd->mem()->IsEmpty());
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, static_cast<int>(i)));
+  }
+
+  // The data is persisted without the WAL.
+  ReopenWithColumnFamilies({kDefaultColumnFamilyName, "pikachu", "eevee"},
+                           options);
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ASSERT_EQ("value", Get(static_cast<int>(i), "key"));
+  }
+}
+
+TEST_F(DBFlushTest, AtomicFlushTriggeredByMemTableFull) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.atomic_flush = true;
+  options.disable_auto_compactions = true;
+  options.memtable_factory.reset(new SpecialSkipListFactory(2));
+
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+  size_t num_cfs = handles_.size();
+  WriteOptions wopts;
+  wopts.disableWAL = true;
+  ASSERT_OK(Put(1, "key", "value", wopts));
+  ASSERT_OK(Put(2, "key", "value", wopts));
+  // The memtable of the default column family is full after two keys, and
+  // the next write switches the memtables of all the column families.
+  ASSERT_OK(Put(0, "key1", "value", wopts));
+  ASSERT_OK(Put(0, "key2", "value", wopts));
+  ASSERT_OK(Put(0, "key3", "value", wopts));
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable(handles_[i]));
+    ASSERT_EQ(1, NumTableFilesAtLevel(0, static_cast<int>(i)));
+  }
+  ASSERT_EQ("value", Get(0, "key3"));
+}
+
+TEST_F(DBFlushTest, AtomicFlushIgnoresIncompleteManifestWrite) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_injection_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.atomic_flush = true;
+  options.avoid_flush_during_shutdown = true;
+  options.env = fault_injection_env.get();
+
+  CreateAndReopenWithCF({"pikachu", "eevee"}, options);
+  size_t num_cfs = handles_.size();
+  WriteOptions wopts;
+  wopts.disableWAL = true;
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ASSERT_OK(Put(static_cast<int>(i) /*cf*/, "key", "value", wopts));
+  }
+
+  // Fail the MANIFEST write after the first edit of the atomic group, as a
+  // crash would.
+  std::atomic<bool> installing(false);
+  int num_records = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::AtomicFlushMemTablesToOutputFiles:InstallResults",
+      [&](void* /*arg*/) { installing = true; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "VersionSet::LogAndApply:BeforeAddRecord", [&](void* /*arg*/) {
+        if (installing && ++num_records == 2) {
+          fault_injection_env->SetFilesystemActive(false);
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_NOK(Flush(0));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  fault_injection_env->SetFilesystemActive(true);
+
+  // Recovery ignores the edit that was written, so none of the column
+  // families has the key.
+  ReopenWithColumnFamilies({kDefaultColumnFamilyName, "pikachu", "eevee"},
+                           options);
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ASSERT_EQ(0, NumTableFilesAtLevel(0, static_cast<int>(i)));
+    ASSERT_EQ("NOT_FOUND", Get(static_cast<int>(i), "key"));
+  }
+  Close();
+}
+
 INSTANTIATE_TEST_CASE_P(DBFlushDirectIOTest, DBFlushDirectIOTest,
                         testing::Bool());
 
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <deque>
 #include <map>
 #include <set>
 #include <stdexcept>
@@ -162,7 +163,10 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       write_buffer_manager_(immutable_db_options_.write_buffer_manager.get()),
       write_thread_(immutable_db_options_),
       nonmem_write_thread_(immutable_db_options_),
+      pending_memtable_writes_(0),
+      pending_memtable_writes_cv_(&pending_memtable_writes_mutex_),
       write_controller_(mutable_db_options_.delayed_write_rate),
+      write_buffer_manager_stall_level_(0),
       // Use delayed_write_rate as a base line to determine the initial
       // low pri write rate limit. It may be adjusted later.
       low_pri_write_rate_limiter_(NewGenericRateLimiter(std::min(
@@ -184,6 +188,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       next_job_id_(1),
       has_unpersisted_data_(false),
       unable_to_release_oldest_log_(false),
+      atomic_flush_in_progress_(false),
+      switching_memtables_for_atomic_flush_(false),
       env_options_(BuildDBOptions(immutable_db_options_, mutable_db_options_)),
       env_options_for_compaction_(env_->OptimizeForCompactionTableWrite(
           env_options_, immutable_db_options_)),
@@ -1307,6 +1313,136 @@ std::vector<Status> DBImpl::MultiGet(
   return stat_list;
 }
 
+void DBImpl::MultiGet(const ReadOptions& read_options,
+                      ColumnFamilyHandle* column_family, const size_t num_keys,
+                      const Slice* keys, PinnableSlice* values,
+                      Status* statuses, const bool sorted_input) {
+  if (num_keys == 0) {
+    return;
+  }
+  StopWatch sw(env_, stats_, DB_MULTIGET);
+  PERF_TIMER_GUARD(get_snapshot_time);
+
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  auto cfd = cfh->cfd();
+  const Comparator* ucmp = cfd->user_comparator();
+
+  // Look the keys up in sorted order, so that keys that share an SST file or
+  // a data block are next to each other all the way down.
+  std::vector<size_t> sorted_keys(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    sorted_keys[i] = i;
+  }
+  if (!sorted_input) {
+    std::sort(sorted_keys.begin(), sorted_keys.end(),
+              [&](size_t a, size_t b) {
+                return ucmp->Compare(keys[a], keys[b]) < 0;
+              });
+  }
+#ifndef NDEBUG
+  for (size_t i = 1; i < num_keys; ++i) {
+    assert(ucmp->Compare(keys[sorted_keys[i - 1]], keys[sorted_keys[i]]) <=
+           0);
+  }
+#endif  // NDEBUG
+
+  // Acquire SuperVersion
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+
+  SequenceNumber snapshot;
+  if (read_options.snapshot != nullptr) {
+    snapshot =
+        reinterpret_cast<const SnapshotImpl*>(read_options.snapshot)->number_;
+  } else {
+    // See the comment in GetImpl() on why the snapshot is taken after the
+    // super version is referenced.
+    snapshot = last_seq_same_as_publish_seq_
+                   ? versions_->LastSequence()
+                   : versions_->LastPublishedSequence();
+  }
+
+  // Per-key lookup state, kept in sorted order
+  std::deque<LookupKey> lkeys;
+  std::deque<MergeContext> merge_contexts;
+  std::deque<RangeDelAggregator> range_del_aggs;
+  for (size_t i = 0; i < num_keys; ++i) {
+    size_t k = sorted_keys[i];
+    lkeys.emplace_back(keys[k], snapshot);
+    merge_contexts.emplace_back();
+    range_del_aggs.emplace_back(cfd->internal_comparator(), snapshot);
+    values[k].Reset();
+    statuses[k] = Status::OK();
+  }
+  std::vector<bool> done(num_keys, false);
+  PERF_TIMER_STOP(get_snapshot_time);
+
+  bool skip_memtable = (read_options.read_tier == kPersistedTier &&
+                        has_unpersisted_data_.load(std::memory_order_relaxed));
+  if (!skip_memtable) {
+    // Probe the mutable memtable for the whole batch before moving on to the
+    // immutable ones.
+    for (size_t i = 0; i < num_keys; ++i) {
+      size_t k = sorted_keys[i];
+      if (sv->mem->Get(lkeys[i], values[k].GetSelf(), &statuses[k],
+                       &merge_contexts[i], &range_del_aggs[i],
+                       read_options)) {
+        done[i] = true;
+        values[k].PinSelf();
+        RecordTick(stats_, MEMTABLE_HIT);
+      }
+    }
+    for (size_t i = 0; i < num_keys; ++i) {
+      size_t k = sorted_keys[i];
+      if (done[i]) {
+        continue;
+      }
+      if ((statuses[k].ok() || statuses[k].IsMergeInProgress()) &&
+          sv->imm->Get(lkeys[i], values[k].GetSelf(), &statuses[k],
+                       &merge_contexts[i], &range_del_aggs[i],
+                       read_options)) {
+        done[i] = true;
+        values[k].PinSelf();
+        RecordTick(stats_, MEMTABLE_HIT);
+      } else if (!statuses[k].ok() && !statuses[k].IsMergeInProgress()) {
+        done[i] = true;
+      }
+    }
+  }
+
+  std::vector<MultiGetKeyContext> sst_keys;
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (!done[i]) {
+      size_t k = sorted_keys[i];
+      sst_keys.emplace_back(&lkeys[i], &values[k], &statuses[k],
+                            &merge_contexts[i], &range_del_aggs[i]);
+    }
+  }
+  if (!sst_keys.empty()) {
+    PERF_TIMER_GUARD(get_from_output_files_time);
+    sv->current->MultiGet(read_options, sst_keys.data(), sst_keys.size());
+    RecordTick(stats_, MEMTABLE_MISS, sst_keys.size());
+  }
+
+  PERF_TIMER_GUARD(get_post_process_time);
+  ReturnAndCleanupSuperVersion(cfd, sv);
+
+  uint64_t bytes_read = 0;
+  size_t num_found = 0;
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (statuses[i].ok()) {
+      bytes_read += values[i].size();
+      num_found++;
+    }
+  }
+  RecordTick(stats_, NUMBER_MULTIGET_CALLS);
+  RecordTick(stats_, NUMBER_MULTIGET_KEYS_READ, num_keys);
+  RecordTick(stats_, NUMBER_MULTIGET_KEYS_FOUND, num_found);
+  RecordTick(stats_, NUMBER_MULTIGET_BYTES_READ, bytes_read);
+  MeasureTime(stats_, BYTES_PER_MULTIGET, bytes_read);
+  PERF_COUNTER_ADD(multiget_read_bytes, bytes_read);
+  PERF_TIMER_STOP(get_post_process_time);
+}
+
 Status DBImpl::CreateColumnFamily(const ColumnFamilyOptions& cf_options,
                                   const std::string& column_family,
                                   ColumnFamilyHandle** handle) {
@@ -2425,6 +2561,16 @@ Status DBImpl::GetDbIdentity(std::string& identity) const {
 }
 
 // Default implementation -- returns not supported status
+void DB::MultiGet(const ReadOptions& options,
+                  ColumnFamilyHandle* column_family, const size_t num_keys,
+                  const Slice* keys, PinnableSlice* values, Status* statuses,
+                  const bool /*sorted_input*/) {
+  for (size_t i = 0; i < num_keys; ++i) {
+    values[i].Reset();
+    statuses[i] = Get(options, column_family, keys[i], &values[i]);
+  }
+}
+
 Status DB::CreateColumnFamily(const ColumnFamilyOptions& /*cf_options*/,
                               const std::string& /*column_family_name*/,
                               ColumnFamilyHandle** /*handle*/) {
@@ -120,6 +120,12 @@ class DBImpl : public DB {
       const std::vector<Slice>& keys,
       std::vector<std::string>* values) override;
 
+  virtual void MultiGet(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family,
+                        const size_t num_keys, const Slice* keys,
+                        PinnableSlice* values, Status* statuses,
+                        const bool sorted_input = false) override;
+
   virtual Status CreateColumnFamily(const ColumnFamilyOptions& cf_options,
                                     const std::string& column_family,
                                     ColumnFamilyHandle** handle) override;
@@ -777,6 +783,20 @@ class DBImpl : public DB {
                             bool disable_memtable = false,
                             uint64_t* seq_used = nullptr);
 
+  // Write path of unordered_write. The write group leader writes the WAL and
+  // publishes the sequence numbers of the group, and each writer then
+  // inserts its own batch into the memtable.
+  Status UnorderedWriteImpl(const WriteOptions& options, WriteBatch* updates,
+                            WriteCallback* callback, uint64_t* log_used,
+                            uint64_t log_ref, bool disable_memtable,
+                            uint64_t* seq_used, size_t batch_cnt,
+                            PreReleaseCallback* pre_release_callback);
+
+  // Wait until the unordered_write writers whose sequence numbers are
+  // published have inserted their batches into the memtable.
+  // REQUIRES: mutex_ is not held
+  void WaitForPendingMemTableWrites();
+
   // batch_cnt is expected to be non-zero in seq_per_batch mode and indicates
   // the number of sub-patches. A sub-patch is a subset of the write batch that
   // does not have duplicate keys.
@@ -810,6 +830,7 @@ class DBImpl : public DB {
 #endif
   friend struct SuperVersion;
   friend class CompactedDBImpl;
+  friend class DBImplReadOnly;
   friend class DBTest_ConcurrentFlushWAL_Test;
 #ifndef NDEBUG
   friend class DBTest2_ReadCallbackTest_Test;
@@ -890,6 +911,13 @@ class DBImpl : public DB {
                                    bool* madeProgress, JobContext* job_context,
                                    LogBuffer* log_buffer);
 
+  // With atomic_flush, flush the immutable memtables of all the column
+  // families in cfds, and install the results with a single atomic group of
+  // version edits, so that either all or none of them are persisted.
+  Status AtomicFlushMemTablesToOutputFiles(
+      const autovector<ColumnFamilyData*>& cfds, bool* made_progress,
+      JobContext* job_context, LogBuffer* log_buffer);
+
   // REQUIRES: log_numbers are sorted in ascending order
   Status RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                          SequenceNumber* next_sequence, bool read_only);
@@ -914,10 +942,23 @@ class DBImpl : public DB {
   Status SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context,
                         FlushReason flush_reason = FlushReason::kOthers);
 
+  // With atomic_flush, switch the memtables of all the column families that
+  // have data, and schedule their flush.
+  // REQUIRES: mutex locked
+  // REQUIRES: this thread is currently at the front of the writer queue
+  Status SwitchMemtablesForAtomicFlush(WriteContext* context,
+                                       FlushReason flush_reason);
+
   // Force current memtable contents to be flushed.
   Status FlushMemTable(ColumnFamilyData* cfd, const FlushOptions& options,
                        FlushReason flush_reason, bool writes_stopped = false);
 
+  // FlushMemTable() with atomic_flush: flushes the memtables of all the
+  // column families together.
+  Status AtomicFlushMemTables(const FlushOptions& options,
+                              FlushReason flush_reason,
+                              bool writes_stopped = false);
+
   // Wait for memtable flushed.
   // If flush_memtable_id is non-null, wait until the memtable with the ID
   // gets flush. Otherwise, wait until the column family don't have any
@@ -931,6 +972,17 @@ class DBImpl : public DB {
   // REQUIRES: mutex locked
   Status HandleWriteBufferFull(WriteContext* write_context);
 
+  // Picks the column family to flush when the write buffer manager is full,
+  // following its flush policy. Returns nullptr if all the mutable memtables
+  // are empty.
+  // REQUIRES: mutex locked
+  ColumnFamilyData* PickColumnFamilyToFlush();
+
+  // Takes or releases write_buffer_manager_delay_token_ as the stall level
+  // of the write buffer manager changes.
+  // REQUIRES: mutex locked
+  void UpdateWriteBufferManagerStall();
+
   // REQUIRES: mutex locked
   Status PreprocessWrite(const WriteOptions& write_options, bool* need_log_sync,
                          WriteContext* write_context);
@@ -939,8 +991,23 @@ class DBImpl : public DB {
                          WriteBatch* tmp_batch, size_t* write_with_wal,
                          WriteBatch** to_be_cached_state);
 
+  // Batches smaller than this are checksummed by the write group leader even
+  // with precompute_wal_checksums.
+  static const size_t kMinPrecomputedWALChecksumSize = 1024;
+
+  // If precompute_wal_checksums is set, computes the checksum of the batch
+  // of w in the writer thread for CombineWALChecksums().
+  void PrecomputeWALChecksum(WriteThread::Writer* w);
+
+  // Returns the crc32c of what MergeBatch() puts after the header of the
+  // merged batch, reusing the checksums computed by the writers.
+  uint32_t CombineWALChecksums(const WriteThread::WriteGroup& write_group);
+
+  // If contents_checksum is not null, it is the crc32c of merged_batch
+  // after its header.
   Status WriteToWAL(const WriteBatch& merged_batch, log::Writer* log_writer,
-                    uint64_t* log_used, uint64_t* log_size);
+                    uint64_t* log_used, uint64_t* log_size,
+                    const uint32_t* contents_checksum = nullptr);
 
   Status WriteToWAL(const WriteThread::WriteGroup& write_group,
                     log::Writer* log_writer, uint64_t* log_used,
@@ -1197,8 +1264,21 @@ class DBImpl : public DB {
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
 
+  // With unordered_write, the number of writers whose sequence numbers are
+  // published but which have not inserted their batch into the memtable yet.
+  // The memtable is only switched once it drops to zero.
+  std::atomic<size_t> pending_memtable_writes_;
+  port::Mutex pending_memtable_writes_mutex_;
+  port::CondVar pending_memtable_writes_cv_;
+
   WriteController write_controller_;
 
+  // Slows down the writes while the write buffer manager is over its limit,
+  // if it allows stalls. write_buffer_manager_stall_level_ is the
+  // WriteBufferManager::StallLevel() the token was taken for.
+  std::unique_ptr<WriteControllerToken> write_buffer_manager_delay_token_;
+  int write_buffer_manager_stall_level_;
+
   unique_ptr<RateLimiter> low_pri_write_rate_limiter_;
 
   // Size of the last batch group. In slowdown mode, next write needs to
@@ -1361,6 +1441,17 @@ class DBImpl : public DB {
   // log is fully commited.
   bool unable_to_release_oldest_log_;
 
+  // With atomic_flush, true while a background flush of the column families
+  // is running. Atomic flushes run one at a time, so that each of them
+  // picks the earliest memtables of every column family.
+  bool atomic_flush_in_progress_;
+
+  // With atomic_flush, true while SwitchMemtablesForAtomicFlush() runs.
+  // SwitchMemtable() releases the mutex, and a background flush must not
+  // pick the memtables of some column families before the others are
+  // switched.
+  bool switching_memtables_for_atomic_flush_;
+
   static const int KEEP_LOG_FILE_NUM = 1000;
   // MSVC version 1800 still does not have constexpr for ::max()
   static const uint64_t kNoTimeOut = port::kMaxUint64;
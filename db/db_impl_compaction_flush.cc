@@ -200,6 +200,165 @@ Status DBImpl::FlushMemTableToOutputFile(
   return s;
 }
 
+Status DBImpl::AtomicFlushMemTablesToOutputFiles(
+    const autovector<ColumnFamilyData*>& cfds, bool* made_progress,
+    JobContext* job_context, LogBuffer* log_buffer) {
+  mutex_.AssertHeld();
+  assert(immutable_db_options_.atomic_flush);
+
+  SequenceNumber earliest_write_conflict_snapshot;
+  std::vector<SequenceNumber> snapshot_seqs =
+      snapshots_.GetAll(&earliest_write_conflict_snapshot);
+
+  auto snapshot_checker = snapshot_checker_.get();
+  if (use_custom_gc_ && snapshot_checker == nullptr) {
+    snapshot_checker = DisableGCSnapshotChecker::Instance();
+  }
+
+  size_t num_cfs = cfds.size();
+  // The flush jobs keep references to their options.
+  std::vector<MutableCFOptions> all_mutable_cf_options;
+  all_mutable_cf_options.reserve(num_cfs);
+  std::vector<std::unique_ptr<FlushJob>> jobs;
+  std::vector<FileMetaData> file_metas(num_cfs);
+  for (size_t i = 0; i != num_cfs; ++i) {
+    ColumnFamilyData* cfd = cfds[i];
+    all_mutable_cf_options.emplace_back(*cfd->GetLatestMutableCFOptions());
+    const MutableCFOptions& mutable_cf_options = all_mutable_cf_options.back();
+    jobs.emplace_back(new FlushJob(
+        dbname_, cfd, immutable_db_options_, mutable_cf_options,
+        env_options_for_compaction_, versions_.get(), &mutex_, &shutting_down_,
+        snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
+        job_context, log_buffer, directories_.GetDbDir(), GetDataDir(cfd, 0U),
+        GetCompressionFlush(*cfd->ioptions(), mutable_cf_options), stats_,
+        &event_logger_, mutable_cf_options.report_bg_io_stats));
+    jobs.back()->PickMemTable();
+  }
+
+#ifndef ROCKSDB_LITE
+  for (size_t i = 0; i != num_cfs; ++i) {
+    // may temporarily unlock and lock the mutex.
+    NotifyOnFlushBegin(cfds[i], &file_metas[i], all_mutable_cf_options[i],
+                       job_context->job_id, jobs[i]->GetTableProperties());
+  }
+#endif  // ROCKSDB_LITE
+
+  Status s;
+  if (logfile_number_ > 0) {
+    // The flushed SSTs must not contain data from write batches whose
+    // updates to other column families are lost with the WAL; see
+    // FlushMemTableToOutputFile().
+    // SyncClosedLogs() may unlock and re-lock the db_mutex.
+    s = SyncClosedLogs(job_context);
+  }
+
+  // Write the output files without installing them. Each Run() will unlock
+  // and lock the db_mutex.
+  size_t num_run = 0;
+  for (; num_run != num_cfs && s.ok(); ++num_run) {
+    s = jobs[num_run]->Run(nullptr /* prep_tracker */, &file_metas[num_run],
+                           false /* write_manifest */);
+  }
+
+  if (!s.ok()) {
+    // The job that failed rolled back its memtables. Roll back the ones
+    // that were flushed before it, and cancel the ones that did not run.
+    for (size_t i = 0; i != num_cfs; ++i) {
+      const auto& mems = jobs[i]->GetMemTables();
+      if (mems.empty()) {
+        continue;
+      }
+      if (i + 1 < num_run) {
+        cfds[i]->imm()->RollbackMemtableFlush(mems,
+                                              file_metas[i].fd.GetNumber());
+      } else if (i >= num_run) {
+        jobs[i]->Cancel();
+        cfds[i]->imm()->RollbackMemtableFlush(mems, 0 /* file_number */);
+      }
+    }
+  } else {
+    TEST_SYNC_POINT("DBImpl::AtomicFlushMemTablesToOutputFiles:InstallResults");
+    autovector<ColumnFamilyData*> install_cfds;
+    autovector<const MutableCFOptions*> mutable_cf_options_list;
+    autovector<const autovector<MemTable*>*> mems_list;
+    autovector<const FileMetaData*> install_file_metas;
+    for (size_t i = 0; i != num_cfs; ++i) {
+      const auto& mems = jobs[i]->GetMemTables();
+      if (mems.empty()) {
+        continue;
+      }
+      install_cfds.push_back(cfds[i]);
+      mutable_cf_options_list.push_back(&all_mutable_cf_options[i]);
+      mems_list.push_back(&mems);
+      install_file_metas.push_back(&file_metas[i]);
+    }
+    if (!install_cfds.empty()) {
+      // this can release and reacquire the mutex.
+      s = MemTableList::InstallMemtableAtomicFlushResults(
+          install_cfds, mutable_cf_options_list, mems_list, versions_.get(),
+          &mutex_, install_file_metas, &job_context->memtables_to_free,
+          directories_.GetDbDir(), log_buffer);
+    }
+  }
+
+  if (s.ok()) {
+    while (job_context->superversion_contexts.size() < num_cfs) {
+      job_context->superversion_contexts.emplace_back(
+          SuperVersionContext(true /* create_superversion */));
+    }
+    for (size_t i = 0; i != num_cfs; ++i) {
+      ColumnFamilyData* cfd = cfds[i];
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      InstallSuperVersionAndScheduleWork(cfd,
+                                         &job_context->superversion_contexts[i],
+                                         all_mutable_cf_options[i]);
+      VersionStorageInfo::LevelSummaryStorage tmp;
+      ROCKS_LOG_BUFFER(log_buffer, "[%s] Level summary: %s\n",
+                       cfd->GetName().c_str(),
+                       cfd->current()->storage_info()->LevelSummary(&tmp));
+    }
+    if (made_progress) {
+      *made_progress = 1;
+    }
+  }
+
+  if (!s.ok() && !s.IsShutdownInProgress()) {
+    Status new_bg_error = s;
+    error_handler_.SetBGError(new_bg_error, BackgroundErrorReason::kFlush);
+  }
+  if (s.ok()) {
+#ifndef ROCKSDB_LITE
+    auto sfm = static_cast<SstFileManagerImpl*>(
+        immutable_db_options_.sst_file_manager.get());
+    for (size_t i = 0; i != num_cfs; ++i) {
+      if (jobs[i]->GetMemTables().empty()) {
+        continue;
+      }
+      // may temporarily unlock and lock the mutex.
+      NotifyOnFlushCompleted(cfds[i], &file_metas[i], all_mutable_cf_options[i],
+                             job_context->job_id,
+                             jobs[i]->GetTableProperties());
+      if (sfm) {
+        // Notify sst_file_manager that a new file was added
+        std::string file_path = MakeTableFileName(
+            cfds[i]->ioptions()->cf_paths[0].path,
+            file_metas[i].fd.GetNumber());
+        sfm->OnAddFile(file_path);
+        if (sfm->IsMaxAllowedSpaceReached()) {
+          Status new_bg_error =
+              Status::SpaceLimit("Max allowed space was reached");
+          error_handler_.SetBGError(new_bg_error,
+                                    BackgroundErrorReason::kFlush);
+        }
+      }
+    }
+#endif  // ROCKSDB_LITE
+  }
+  return s;
+}
+
 void DBImpl::NotifyOnFlushBegin(ColumnFamilyData* cfd, FileMetaData* file_meta,
                                 const MutableCFOptions& mutable_cf_options,
                                 int job_id, TableProperties prop) {
@@ -1075,6 +1234,9 @@ Status DBImpl::RunManualCompaction(ColumnFamilyData* cfd, int input_level,
 Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
                              const FlushOptions& flush_options,
                              FlushReason flush_reason, bool writes_stopped) {
+  if (immutable_db_options_.atomic_flush) {
+    return AtomicFlushMemTables(flush_options, flush_reason, writes_stopped);
+  }
   Status s;
   uint64_t flush_memtable_id = 0;
   {
@@ -1115,6 +1277,60 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
   return s;
 }
 
+Status DBImpl::AtomicFlushMemTables(const FlushOptions& flush_options,
+                                    FlushReason flush_reason,
+                                    bool writes_stopped) {
+  Status s;
+  autovector<ColumnFamilyData*> cfds;
+  autovector<uint64_t> flush_memtable_ids;
+  {
+    WriteContext context;
+    InstrumentedMutexLock guard_lock(&mutex_);
+
+    WriteThread::Writer w;
+    if (!writes_stopped) {
+      write_thread_.EnterUnbatched(&w, &mutex_);
+    }
+
+    // SwitchMemtablesForAtomicFlush() will release and reacquire mutex
+    // during execution
+    s = SwitchMemtablesForAtomicFlush(&context, flush_reason);
+
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || cfd->imm()->NumNotFlushed() == 0) {
+        continue;
+      }
+      cfd->Ref();
+      cfds.push_back(cfd);
+      flush_memtable_ids.push_back(cfd->imm()->GetLatestMemTableID());
+    }
+
+    if (!writes_stopped) {
+      write_thread_.ExitUnbatched(&w);
+    }
+  }
+
+  if (s.ok() && flush_options.wait) {
+    // Wait until the flushes of all the column families complete
+    for (size_t i = 0; i != cfds.size() && s.ok(); ++i) {
+      if (cfds[i]->IsDropped()) {
+        continue;
+      }
+      s = WaitForFlushMemTable(cfds[i], &flush_memtable_ids[i]);
+    }
+  }
+  {
+    InstrumentedMutexLock guard_lock(&mutex_);
+    for (auto cfd : cfds) {
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+  }
+  TEST_SYNC_POINT("FlushMemTableFinished");
+  return s;
+}
+
 Status DBImpl::WaitForFlushMemTable(ColumnFamilyData* cfd,
                                     const uint64_t* flush_memtable_id) {
   Status s;
@@ -1367,6 +1583,55 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
     return status;
   }
 
+  if (immutable_db_options_.atomic_flush) {
+    // Wait for the atomic flush that is running, which can pick some of the
+    // memtables this flush was scheduled for, and for the memtables of all
+    // the column families to be switched.
+    while (atomic_flush_in_progress_ ||
+           switching_memtables_for_atomic_flush_) {
+      bg_cv_.Wait();
+    }
+    // A single flush handles all the column families that are queued.
+    while (!flush_queue_.empty()) {
+      auto first_cfd = PopFirstFromFlushQueue();
+      if (first_cfd->Unref()) {
+        delete first_cfd;
+      }
+    }
+    autovector<ColumnFamilyData*> cfds;
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || cfd->imm()->NumNotFlushed() == 0) {
+        continue;
+      }
+      cfd->Ref();
+      cfds.push_back(cfd);
+    }
+    if (!cfds.empty()) {
+      ROCKS_LOG_BUFFER(log_buffer,
+                       "Calling AtomicFlushMemTablesToOutputFiles with "
+                       "%" ROCKSDB_PRIszt " column families",
+                       cfds.size());
+      atomic_flush_in_progress_ = true;
+      status = AtomicFlushMemTablesToOutputFiles(cfds, made_progress,
+                                                 job_context, log_buffer);
+      atomic_flush_in_progress_ = false;
+      bg_cv_.SignalAll();
+    }
+    for (auto cfd : cfds) {
+      if (status.IsShutdownInProgress() && !cfd->IsDropped() &&
+          !shutting_down_.load(std::memory_order_acquire)) {
+        // Another column family was dropped during the flush; flush the
+        // others again.
+        cfd->imm()->FlushRequested();
+        SchedulePendingFlush(cfd, cfd->GetFlushReason());
+      }
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+    return status;
+  }
+
   ColumnFamilyData* cfd = nullptr;
   while (!flush_queue_.empty()) {
     // This cfd is already referenced
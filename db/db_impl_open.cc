@@ -185,6 +185,21 @@ static Status ValidateOptions(
     }
   }
 
+  if (db_options.unordered_write &&
+      !db_options.allow_concurrent_memtable_write) {
+    return Status::InvalidArgument(
+        "unordered_write requires allow_concurrent_memtable_write");
+  }
+
+  if (db_options.unordered_write && db_options.enable_pipelined_write) {
+    return Status::InvalidArgument(
+        "unordered_write is not compatible with enable_pipelined_write");
+  }
+
+  if (db_options.atomic_flush && db_options.allow_2pc) {
+    return Status::NotSupported("atomic_flush is not supported with allow_2pc");
+  }
+
   if (db_options.db_paths.size() > 4) {
     return Status::NotSupported(
         "More than four DB paths are not supported yet. ");
@@ -205,6 +220,12 @@ static Status ValidateOptions(
         "be disabled. ");
   }
 
+  if (db_options.use_pmem_for_wal && db_options.two_write_queues) {
+    // two_write_queues syncs the WAL with SyncWAL()
+    return Status::NotSupported(
+        "use_pmem_for_wal is not supported with two_write_queues");
+  }
+
   if (db_options.keep_log_file_num == 0) {
     return Status::InvalidArgument("keep_log_file_num must be greater than 0");
   }
@@ -5,12 +5,17 @@
 
 #include "db/db_impl_readonly.h"
 
+#include <limits>
+
 #include "db/compacted_db_impl.h"
+#include "db/compaction_job.h"
 #include "db/db_impl.h"
 #include "db/db_iter.h"
 #include "db/merge_context.h"
 #include "db/range_del_aggregator.h"
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/compaction_service.h"
+#include "util/filename.h"
 
 namespace rocksdb {
 
@@ -188,8 +193,118 @@ Status DB::OpenForReadOnly(
   return s;
 }
 
+Status DBImplReadOnly::CompactWithoutInstallation(
+    ColumnFamilyHandle* column_family, const CompactionServiceInput& input,
+    CompactionServiceResult* result) {
+  auto cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family)->cfd();
+  std::unordered_set<uint64_t> input_set;
+  for (const auto& file_name : input.input_files) {
+    input_set.insert(TableFileNameToNumber(file_name));
+  }
+  CompactionOptions compact_options;
+  compact_options.compression = input.compression;
+  compact_options.output_file_size_limit = input.max_output_file_size;
+  const uint32_t output_path_id =
+      static_cast<uint32_t>(cfd->ioptions()->cf_paths.size() - 1);
+
+  std::unique_ptr<Directory> output_directory;
+  Status s = env_->NewDirectory(input.output_directory, &output_directory);
+  if (!s.ok()) {
+    return s;
+  }
+  LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
+                       immutable_db_options_.info_log.get());
+
+  InstrumentedMutexLock l(&mutex_);
+  Version* version = cfd->current();
+  std::vector<CompactionInputFiles> input_files;
+  s = cfd->compaction_picker()->GetCompactionInputsFromFileNumbers(
+      &input_files, &input_set, version->storage_info(), compact_options);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<Compaction> c(cfd->compaction_picker()->CompactFiles(
+      compact_options, input_files, input.output_level,
+      version->storage_info(), *cfd->GetLatestMutableCFOptions(),
+      output_path_id));
+  assert(c != nullptr);
+  c->SetInputVersion(version);
+
+  CompactionJob compaction_job(
+      next_job_id_.fetch_add(1), c.get(), immutable_db_options_,
+      env_options_for_compaction_, versions_.get(), &shutting_down_,
+      preserve_deletes_seqnum_.load(), &log_buffer,
+      nullptr /* db_directory */, output_directory.get(), stats_, &mutex_,
+      &error_handler_, input.snapshots, input.earliest_write_conflict_snapshot,
+      nullptr /* snapshot_checker */, table_cache_, &event_logger_,
+      c->mutable_cf_options()->paranoid_file_checks,
+      c->mutable_cf_options()->report_bg_io_stats, dbname_,
+      nullptr /* compaction_job_stats */);
+  compaction_job.Prepare();
+
+  mutex_.Unlock();
+  compaction_job.Run();
+  mutex_.Lock();
+
+  s = compaction_job.FinishWithoutInstallation(result);
+  c->ReleaseCompactionFiles(s);
+  c.reset();
+  log_buffer.FlushBufferToLog();
+  return s;
+}
+
+Status DB::OpenAndCompact(const Options& options,
+                          const CompactionServiceInput& input,
+                          CompactionServiceResult* result) {
+  DBOptions db_options(options);
+  // This instance only writes the output files of the compaction
+  db_options.compaction_service = nullptr;
+  db_options.sst_file_manager = nullptr;
+  db_options.listeners.clear();
+
+  // The output files are written to a path after the paths of the input
+  // files, which keeps the path ids of these valid
+  ColumnFamilyOptions cf_options(options);
+  if (cf_options.cf_paths.empty()) {
+    cf_options.cf_paths = db_options.db_paths;
+    if (cf_options.cf_paths.empty()) {
+      cf_options.cf_paths.emplace_back(input.db_name,
+                                       std::numeric_limits<uint64_t>::max());
+    }
+  }
+  cf_options.cf_paths.emplace_back(input.output_directory,
+                                   std::numeric_limits<uint64_t>::max());
+
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.emplace_back(input.column_family_name, cf_options);
+  if (input.column_family_name != kDefaultColumnFamilyName) {
+    column_families.emplace_back(kDefaultColumnFamilyName,
+                                 ColumnFamilyOptions(options));
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  Status s = DB::OpenForReadOnly(db_options, input.db_name, column_families,
+                                 &handles, &db);
+  if (!s.ok()) {
+    return s;
+  }
+  s = static_cast<DBImplReadOnly*>(db)->CompactWithoutInstallation(
+      handles[0], input, result);
+  for (auto* h : handles) {
+    delete h;
+  }
+  delete db;
+  return s;
+}
+
 #else   // !ROCKSDB_LITE
 
+Status DB::OpenAndCompact(const Options& /*options*/,
+                          const CompactionServiceInput& /*input*/,
+                          CompactionServiceResult* /*result*/) {
+  return Status::NotSupported("Not supported in ROCKSDB_LITE.");
+}
+
 Status DB::OpenForReadOnly(const Options& /*options*/,
                            const std::string& /*dbname*/, DB** /*dbptr*/,
                            bool /*error_if_log_file_exist*/) {
@@ -114,6 +114,13 @@ class DBImplReadOnly : public DBImpl {
     return Status::NotSupported("Not supported operation in read only mode.");
   }
 
+  // Runs a compaction handed over by another DB through its
+  // CompactionService, with the output files written to the last path of the
+  // column family, and describes them in result without installing them.
+  Status CompactWithoutInstallation(ColumnFamilyHandle* column_family,
+                                    const CompactionServiceInput& input,
+                                    CompactionServiceResult* result);
+
  private:
   friend class DB;
 
@@ -16,6 +16,7 @@
 #include "db/event_helpers.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
+#include "util/crc32c.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
@@ -111,6 +112,12 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                             log_ref, seq_used, batch_cnt, pre_release_callback);
   }
 
+  if (immutable_db_options_.unordered_write) {
+    return UnorderedWriteImpl(write_options, my_batch, callback, log_used,
+                              log_ref, disable_memtable, seq_used, batch_cnt,
+                              pre_release_callback);
+  }
+
   if (immutable_db_options_.enable_pipelined_write) {
     return PipelinedWriteImpl(write_options, my_batch, callback, log_used,
                               log_ref, disable_memtable, seq_used);
@@ -119,6 +126,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, batch_cnt, pre_release_callback);
+  PrecomputeWALChecksum(&w);
 
   if (!write_options.disableWAL) {
     RecordTick(stats_, WRITE_WITH_WAL);
@@ -139,7 +147,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       w.status = WriteBatchInternal::InsertInto(
           &w, w.sequence, &column_family_memtables, &flush_scheduler_,
           write_options.ignore_missing_column_families, 0 /*log_number*/, this,
-          true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt);
+          true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt,
+          batch_per_txn_, write_options.memtable_insert_hint_per_batch);
 
       PERF_TIMER_START(write_pre_and_post_process_time);
     }
@@ -353,7 +362,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
               &w, w.sequence, &column_family_memtables, &flush_scheduler_,
               write_options.ignore_missing_column_families, 0 /*log_number*/,
               this, true /*concurrent_memtable_writes*/, seq_per_batch_,
-              w.batch_cnt, batch_per_txn_);
+              w.batch_cnt, batch_per_txn_,
+              write_options.memtable_insert_hint_per_batch);
         }
       }
       if (seq_used != nullptr) {
@@ -424,6 +434,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
 
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable);
+  PrecomputeWALChecksum(&w);
   write_thread_.JoinBatchGroup(&w);
   if (w.state == WriteThread::STATE_GROUP_LEADER) {
     WriteThread::WriteGroup wal_write_group;
@@ -529,7 +540,9 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     w.status = WriteBatchInternal::InsertInto(
         &w, w.sequence, &column_family_memtables, &flush_scheduler_,
         write_options.ignore_missing_column_families, 0 /*log_number*/, this,
-        true /*concurrent_memtable_writes*/);
+        true /*concurrent_memtable_writes*/, false /*seq_per_batch*/,
+        0 /*batch_cnt*/, true /*batch_per_txn*/,
+        write_options.memtable_insert_hint_per_batch);
     if (write_thread_.CompleteParallelMemTableWriter(&w)) {
       MemTableInsertStatusCheck(w.status);
       versions_->SetLastSequence(w.write_group->last_sequence);
@@ -544,6 +557,246 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   return w.FinalStatus();
 }
 
+Status DBImpl::UnorderedWriteImpl(const WriteOptions& write_options,
+                                  WriteBatch* my_batch, WriteCallback* callback,
+                                  uint64_t* log_used, uint64_t log_ref,
+                                  bool disable_memtable, uint64_t* seq_used,
+                                  size_t batch_cnt,
+                                  PreReleaseCallback* pre_release_callback) {
+  PERF_TIMER_GUARD(write_pre_and_post_process_time);
+  WriteThread::Writer w(write_options, my_batch, callback, log_ref,
+                        disable_memtable, batch_cnt, pre_release_callback);
+  PrecomputeWALChecksum(&w);
+
+  if (!write_options.disableWAL) {
+    RecordTick(stats_, WRITE_WITH_WAL);
+  }
+
+  StopWatch write_sw(env_, immutable_db_options_.statistics.get(), DB_WRITE);
+
+  write_thread_.JoinBatchGroup(&w);
+  assert(w.state != WriteThread::STATE_PARALLEL_MEMTABLE_WRITER);
+  if (w.state == WriteThread::STATE_GROUP_LEADER) {
+    // The leader writes the group to the WAL, assigns the sequence numbers
+    // and publishes them. Each writer then inserts its own batch into the
+    // memtable after the group is exited, so that the next group does not
+    // wait for the memtable inserts of this one.
+    WriteContext write_context;
+    WriteThread::WriteGroup write_group;
+    uint64_t last_sequence = kMaxSequenceNumber;
+    if (!two_write_queues_) {
+      last_sequence = versions_->LastSequence();
+    }
+
+    mutex_.Lock();
+    bool need_log_sync = write_options.sync;
+    bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
+    PERF_TIMER_STOP(write_pre_and_post_process_time);
+    Status status =
+        PreprocessWrite(write_options, &need_log_sync, &write_context);
+    PERF_TIMER_START(write_pre_and_post_process_time);
+    log::Writer* log_writer = logs_.back().writer;
+    mutex_.Unlock();
+
+    last_batch_group_size_ =
+        write_thread_.EnterAsBatchGroupLeader(&w, &write_group);
+
+    if (status.ok()) {
+      size_t total_count = 0;
+      size_t valid_batches = 0;
+      size_t total_byte_size = 0;
+      bool has_merge = false;
+      for (auto* writer : write_group) {
+        if (writer->CheckCallback(this)) {
+          valid_batches += writer->batch_cnt;
+          if (writer->ShouldWriteToMemtable()) {
+            total_count += WriteBatchInternal::Count(writer->batch);
+            has_merge = has_merge || writer->batch->HasMerge();
+          }
+
+          total_byte_size = WriteBatchInternal::AppendedByteSize(
+              total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
+        }
+      }
+      size_t seq_inc = seq_per_batch_ ? valid_batches : total_count;
+
+      const bool concurrent_update = two_write_queues_;
+      auto stats = default_cf_internal_stats_;
+      stats->AddDBStats(InternalStats::NUMBER_KEYS_WRITTEN, total_count,
+                        concurrent_update);
+      RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
+      stats->AddDBStats(InternalStats::BYTES_WRITTEN, total_byte_size,
+                        concurrent_update);
+      RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+      stats->AddDBStats(InternalStats::WRITE_DONE_BY_SELF, 1,
+                        concurrent_update);
+      RecordTick(stats_, WRITE_DONE_BY_SELF);
+      auto write_done_by_other = write_group.size - 1;
+      if (write_done_by_other > 0) {
+        stats->AddDBStats(InternalStats::WRITE_DONE_BY_OTHER,
+                          write_done_by_other, concurrent_update);
+        RecordTick(stats_, WRITE_DONE_BY_OTHER, write_done_by_other);
+      }
+      MeasureTime(stats_, BYTES_PER_WRITE, total_byte_size);
+
+      if (write_options.disableWAL) {
+        has_unpersisted_data_.store(true, std::memory_order_relaxed);
+      }
+
+      PERF_TIMER_STOP(write_pre_and_post_process_time);
+
+      if (!two_write_queues_) {
+        if (!write_options.disableWAL) {
+          PERF_TIMER_GUARD(write_wal_time);
+          status = WriteToWAL(write_group, log_writer, log_used, need_log_sync,
+                              need_log_dir_sync, last_sequence + 1);
+        }
+      } else {
+        if (!write_options.disableWAL) {
+          PERF_TIMER_GUARD(write_wal_time);
+          status = ConcurrentWriteToWAL(write_group, log_used, &last_sequence,
+                                        seq_inc);
+        } else {
+          last_sequence = versions_->FetchAddLastAllocatedSequence(seq_inc);
+        }
+      }
+      assert(last_sequence != kMaxSequenceNumber);
+      SequenceNumber next_sequence = last_sequence + 1;
+      last_sequence += seq_inc;
+
+      if (status.ok()) {
+        // Must be consistent with WriteBatchInternal::InsertInto(write_group)
+        // and with the recovery of the merged batch from the WAL.
+        for (auto* writer : write_group) {
+          if (writer->CallbackFailed()) {
+            continue;
+          }
+          writer->sequence = next_sequence;
+          if (seq_per_batch_) {
+            assert(writer->batch_cnt);
+            next_sequence += writer->batch_cnt;
+          } else if (writer->ShouldWriteToMemtable()) {
+            next_sequence += WriteBatchInternal::Count(writer->batch);
+          }
+        }
+
+        if (has_merge) {
+          // Merges cannot be inserted concurrently, so the leader inserts
+          // the batches with merges itself, once no other writer is
+          // inserting: the earlier groups are drained, and the writers of
+          // this group and of the next ones are still waiting.
+          PERF_TIMER_GUARD(write_memtable_time);
+          WaitForPendingMemTableWrites();
+          for (auto* writer : write_group) {
+            if (writer->ShouldWriteToMemtable() &&
+                writer->batch->HasMerge()) {
+              writer->status = WriteBatchInternal::InsertInto(
+                  writer, writer->sequence, column_family_memtables_.get(),
+                  &flush_scheduler_,
+                  write_options.ignore_missing_column_families,
+                  0 /*log_number*/, this, false /*concurrent_memtable_writes*/,
+                  seq_per_batch_, writer->batch_cnt, batch_per_txn_);
+              MemTableInsertStatusCheck(writer->status);
+              if (!writer->status.ok()) {
+                // Fail the whole group, whose writers were not counted as
+                // pending memtable writes yet.
+                status = writer->status;
+                break;
+              }
+            }
+          }
+        }
+      }
+      PERF_TIMER_START(write_pre_and_post_process_time);
+    }
+
+    if (!w.CallbackFailed()) {
+      WriteStatusCheck(status);
+    }
+
+    if (need_log_sync) {
+      mutex_.Lock();
+      MarkLogsSynced(logfile_number_, need_log_dir_sync, status);
+      mutex_.Unlock();
+      if (two_write_queues_) {
+        if (manual_wal_flush_) {
+          status = FlushWAL(true);
+        } else {
+          status = SyncWAL();
+        }
+      }
+    }
+
+    if (status.ok()) {
+      for (auto* writer : write_group) {
+        if (!writer->CallbackFailed() && writer->pre_release_callback) {
+          assert(writer->sequence != kMaxSequenceNumber);
+          Status ws = writer->pre_release_callback->Callback(writer->sequence,
+                                                             disable_memtable);
+          if (!ws.ok()) {
+            status = ws;
+            break;
+          }
+        }
+      }
+    }
+    if (status.ok()) {
+      // Count the inserts left to the writers before publishing their
+      // sequence numbers, so that a memtable switch waits for them.
+      size_t memtable_writers = 0;
+      for (auto* writer : write_group) {
+        if (writer->ShouldWriteToMemtable() && !writer->batch->HasMerge()) {
+          memtable_writers++;
+        }
+      }
+      pending_memtable_writes_.fetch_add(memtable_writers);
+      versions_->SetLastSequence(last_sequence);
+    } else if (w.status.ok()) {
+      // ExitAsBatchGroupLeader() only sets the status of the followers.
+      w.status = status;
+    }
+    write_thread_.ExitAsBatchGroupLeader(write_group, status);
+  }
+
+  // The group succeeded and left the insert of this batch to this writer.
+  // The insert can run concurrently with those of other writers and groups.
+  if (w.ShouldWriteToMemtable() && !my_batch->HasMerge()) {
+    PERF_TIMER_STOP(write_pre_and_post_process_time);
+    PERF_TIMER_GUARD(write_memtable_time);
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    w.status = WriteBatchInternal::InsertInto(
+        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+        write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+        true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt,
+        batch_per_txn_, write_options.memtable_insert_hint_per_batch);
+    MemTableInsertStatusCheck(w.status);
+    if (pending_memtable_writes_.fetch_sub(1) == 1) {
+      MutexLock l(&pending_memtable_writes_mutex_);
+      pending_memtable_writes_cv_.SignalAll();
+    }
+    PERF_TIMER_START(write_pre_and_post_process_time);
+  }
+
+  if (log_used != nullptr) {
+    *log_used = w.log_used;
+  }
+  if (seq_used != nullptr) {
+    *seq_used = w.sequence;
+  }
+  return w.FinalStatus();
+}
+
+void DBImpl::WaitForPendingMemTableWrites() {
+  if (pending_memtable_writes_.load() == 0) {
+    return;
+  }
+  MutexLock l(&pending_memtable_writes_mutex_);
+  while (pending_memtable_writes_.load() != 0) {
+    pending_memtable_writes_cv_.Wait();
+  }
+}
+
 // The 2nd write queue. If enabled it will be used only for WAL-only writes.
 // This is the only queue that updates LastPublishedSequence which is only
 // applicable in a two-queue setting.
@@ -557,6 +810,7 @@ Status DBImpl::WriteImplWALOnly(const WriteOptions& write_options,
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         true /* disable_memtable */, batch_cnt,
                         pre_release_callback);
+  PrecomputeWALChecksum(&w);
   RecordTick(stats_, WRITE_WITH_WAL);
   StopWatch write_sw(env_, immutable_db_options_.statistics.get(), DB_WRITE);
 
@@ -728,6 +982,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     status = HandleWriteBufferFull(write_context);
   }
 
+  if (UNLIKELY(write_buffer_manager_->allow_stall())) {
+    UpdateWriteBufferManagerStall();
+  }
+
   if (UNLIKELY(status.ok())) {
     status = error_handler_.GetBGError();
   }
@@ -818,11 +1076,42 @@ WriteBatch* DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
   return merged_batch;
 }
 
+void DBImpl::PrecomputeWALChecksum(WriteThread::Writer* w) {
+  if (!immutable_db_options_.precompute_wal_checksums || w->disable_wal) {
+    return;
+  }
+  Slice contents = WriteBatchInternal::WALContents(w->batch);
+  // Combining a checksum costs about as much as checksumming several hundred
+  // bytes with SSE4.2, so the leader checksums small batches itself.
+  if (contents.size() >= kMinPrecomputedWALChecksumSize) {
+    w->wal_checksum = crc32c::Value(contents.data(), contents.size());
+    w->has_wal_checksum = true;
+  }
+}
+
+uint32_t DBImpl::CombineWALChecksums(
+    const WriteThread::WriteGroup& write_group) {
+  uint32_t checksum = 0;
+  for (auto writer : write_group) {
+    if (!writer->CallbackFailed()) {
+      Slice contents = WriteBatchInternal::WALContents(writer->batch);
+      if (writer->has_wal_checksum) {
+        checksum =
+            crc32c::Combine(checksum, writer->wal_checksum, contents.size());
+      } else {
+        checksum = crc32c::Extend(checksum, contents.data(), contents.size());
+      }
+    }
+  }
+  return checksum;
+}
+
 // When two_write_queues_ is disabled, this function is called from the only
 // write thread. Otherwise this must be called holding log_write_mutex_.
 Status DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                           log::Writer* log_writer, uint64_t* log_used,
-                          uint64_t* log_size) {
+                          uint64_t* log_size,
+                          const uint32_t* contents_checksum) {
   assert(log_size != nullptr);
   Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
   *log_size = log_entry.size();
@@ -837,7 +1126,13 @@ Status DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Lock();
   }
-  Status status = log_writer->AddRecord(log_entry);
+  Status status;
+  if (contents_checksum != nullptr) {
+    status = log_writer->AddRecord(log_entry, WriteBatchInternal::kHeader,
+                                   *contents_checksum);
+  } else {
+    status = log_writer->AddRecord(log_entry);
+  }
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
   }
@@ -874,8 +1169,16 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
 
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
+  uint32_t contents_checksum = 0;
+  if (immutable_db_options_.precompute_wal_checksums) {
+    contents_checksum = CombineWALChecksums(write_group);
+  }
+
   uint64_t log_size;
-  status = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+  status = WriteToWAL(
+      *merged_batch, log_writer, log_used, &log_size,
+      immutable_db_options_.precompute_wal_checksums ? &contents_checksum
+                                                     : nullptr);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
       cached_recoverable_state_empty_ = false;
@@ -934,6 +1237,10 @@ Status DBImpl::ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
   WriteBatch* to_be_cached_state = nullptr;
   WriteBatch* merged_batch =
       MergeBatch(write_group, &tmp_batch, &write_with_wal, &to_be_cached_state);
+  uint32_t contents_checksum = 0;
+  if (immutable_db_options_.precompute_wal_checksums) {
+    contents_checksum = CombineWALChecksums(write_group);
+  }
 
   // We need to lock log_write_mutex_ since logs_ and alive_log_files might be
   // pushed back concurrently
@@ -951,7 +1258,10 @@ Status DBImpl::ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
 
   log::Writer* log_writer = logs_.back().writer;
   uint64_t log_size;
-  status = WriteToWAL(*merged_batch, log_writer, log_used, &log_size);
+  status = WriteToWAL(
+      *merged_batch, log_writer, log_used, &log_size,
+      immutable_db_options_.precompute_wal_checksums ? &contents_checksum
+                                                     : nullptr);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
       cached_recoverable_state_empty_ = false;
@@ -1062,6 +1372,10 @@ Status DBImpl::SwitchWAL(WriteContext* write_context) {
                  ". Total log size is %" PRIu64
                  " while max_total_wal_size is %" PRIu64,
                  oldest_alive_log, total_log_size_.load(), GetMaxTotalWalSize());
+  if (immutable_db_options_.atomic_flush) {
+    return SwitchMemtablesForAtomicFlush(write_context,
+                                         FlushReason::kWriteBufferManager);
+  }
   // no need to refcount because drop is happening in write thread, so can't
   // happen while we're in the write thread
   for (auto cfd : *versions_->GetColumnFamilySet()) {
@@ -1097,35 +1411,143 @@ Status DBImpl::HandleWriteBufferFull(WriteContext* write_context) {
       "using %" PRIu64 " bytes out of a total of %" PRIu64 ".",
       write_buffer_manager_->memory_usage(),
       write_buffer_manager_->buffer_size());
+  if (immutable_db_options_.atomic_flush) {
+    return SwitchMemtablesForAtomicFlush(write_context,
+                                         FlushReason::kWriteBufferFull);
+  }
   // no need to refcount because drop is happening in write thread, so can't
   // happen while we're in the write thread
-  ColumnFamilyData* cfd_picked = nullptr;
-  SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
+  ColumnFamilyData* cfd_picked = PickColumnFamilyToFlush();
+  if (cfd_picked != nullptr) {
+    status = SwitchMemtable(cfd_picked, write_context,
+                            FlushReason::kWriteBufferFull);
+    if (status.ok()) {
+      cfd_picked->imm()->FlushRequested();
+      SchedulePendingFlush(cfd_picked, FlushReason::kWriteBufferFull);
+      MaybeScheduleFlushOrCompaction();
+    }
+  }
+  return status;
+}
 
+ColumnFamilyData* DBImpl::PickColumnFamilyToFlush() {
+  mutex_.AssertHeld();
+  // We only consider active mem tables, hoping immutable memtables are
+  // already in the process of flushing.
+  autovector<ColumnFamilyData*> candidates;
   for (auto cfd : *versions_->GetColumnFamilySet()) {
-    if (cfd->IsDropped()) {
-      continue;
+    if (!cfd->IsDropped() && !cfd->mem()->IsEmpty()) {
+      candidates.push_back(cfd);
     }
-    if (!cfd->mem()->IsEmpty()) {
-      // We only consider active mem table, hoping immutable memtable is
-      // already in the process of flushing.
+  }
+  if (candidates.empty()) {
+    return nullptr;
+  }
+
+  if (write_buffer_manager_->flush_policy() ==
+      WriteBufferFlushPolicy::kOldestMemtable) {
+    ColumnFamilyData* cfd_picked = nullptr;
+    SequenceNumber seq_num_for_cf_picked = kMaxSequenceNumber;
+    for (auto cfd : candidates) {
       uint64_t seq = cfd->mem()->GetCreationSeq();
       if (cfd_picked == nullptr || seq < seq_num_for_cf_picked) {
         cfd_picked = cfd;
         seq_num_for_cf_picked = seq;
       }
     }
+    return cfd_picked;
+  }
+
+  // kCostAware: each of the three terms of the score is in [0, 1].
+  // - Size: the memory the flush frees, relative to the largest memtable.
+  // - Age: how old the first entry of the memtable is, relative to the
+  //   oldest one, so that small column families do not stay unflushed.
+  // - WAL: 1 if the column family keeps the oldest WAL alive while there are
+  //   newer ones, whose space the flush may let us reclaim.
+  size_t max_memory = 0;
+  SequenceNumber min_seq = kMaxSequenceNumber;
+  uint64_t min_log_number = port::kMaxUint64;
+  for (auto cfd : candidates) {
+    max_memory = std::max(max_memory, cfd->mem()->ApproximateMemoryUsage());
+    min_seq = std::min(min_seq, cfd->mem()->GetFirstSequenceNumber());
+    min_log_number = std::min(min_log_number, cfd->GetLogNumber());
+  }
+  const SequenceNumber last_seq = versions_->LastSequence();
+  const bool has_newer_wals = alive_log_files_.size() > 1;
+
+  ColumnFamilyData* cfd_picked = nullptr;
+  double score_picked = 0;
+  SequenceNumber seq_picked = kMaxSequenceNumber;
+  for (auto cfd : candidates) {
+    MemTable* mem = cfd->mem();
+    double score = 0;
+    if (max_memory > 0) {
+      score += static_cast<double>(mem->ApproximateMemoryUsage()) / max_memory;
+    }
+    const SequenceNumber seq = mem->GetFirstSequenceNumber();
+    if (last_seq > min_seq) {
+      score += static_cast<double>(last_seq - std::min(seq, last_seq)) /
+               (last_seq - min_seq);
+    }
+    if (has_newer_wals && cfd->GetLogNumber() == min_log_number) {
+      score += 1;
+    }
+    if (cfd_picked == nullptr || score > score_picked ||
+        (score == score_picked && seq < seq_picked)) {
+      cfd_picked = cfd;
+      score_picked = score;
+      seq_picked = seq;
+    }
   }
-  if (cfd_picked != nullptr) {
-    status = SwitchMemtable(cfd_picked, write_context,
-                            FlushReason::kWriteBufferFull);
-    if (status.ok()) {
-      cfd_picked->imm()->FlushRequested();
-      SchedulePendingFlush(cfd_picked, FlushReason::kWriteBufferFull);
-      MaybeScheduleFlushOrCompaction();
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[%s] Picked to flush with score %.3f out of %" ROCKSDB_PRIszt
+                 " column families with data in memory.",
+                 cfd_picked->GetName().c_str(), score_picked,
+                 candidates.size());
+  return cfd_picked;
+}
+
+void DBImpl::UpdateWriteBufferManagerStall() {
+  mutex_.AssertHeld();
+  const int level = write_buffer_manager_->StallLevel();
+  if (level == 0) {
+    if (write_buffer_manager_delay_token_ != nullptr) {
+      write_buffer_manager_delay_token_.reset();
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Stopping the write slowdown: write buffer is using "
+                     "%" ROCKSDB_PRIszt " bytes out of a total of "
+                     "%" ROCKSDB_PRIszt ".",
+                     write_buffer_manager_->memory_usage(),
+                     write_buffer_manager_->buffer_size());
     }
+    write_buffer_manager_stall_level_ = 0;
+    return;
+  }
+
+  const uint64_t kMinWriteRate = 16 * 1024u;  // Minimum write rate 16KB/s.
+  const uint64_t write_rate = std::max(
+      write_controller_.max_delayed_write_rate() >> level, kMinWriteRate);
+  if (level != write_buffer_manager_stall_level_) {
+    write_buffer_manager_stall_level_ = level;
+    write_buffer_manager_delay_token_.reset();
+    uint64_t rate = write_rate;
+    if (write_controller_.NeedsDelay()) {
+      // Do not speed up the writes that column families already slow down.
+      rate = std::min(rate, write_controller_.delayed_write_rate());
+    }
+    write_buffer_manager_delay_token_ = write_controller_.GetDelayToken(rate);
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Slowing down writes to %" PRIu64
+                   " bytes/s (stall level %d): write buffer is using "
+                   "%" ROCKSDB_PRIszt " bytes out of a total of "
+                   "%" ROCKSDB_PRIszt ".",
+                   rate, level, write_buffer_manager_->memory_usage(),
+                   write_buffer_manager_->buffer_size());
+  } else if (write_controller_.delayed_write_rate() > write_rate) {
+    // Column families raise the rate when they recover from their own delay
+    // conditions, while the memory is still over the limit.
+    write_controller_.set_delayed_write_rate(write_rate);
   }
-  return status;
 }
 
 uint64_t DBImpl::GetMaxTotalWalSize() const {
@@ -1219,6 +1641,16 @@ Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
 
 Status DBImpl::ScheduleFlushes(WriteContext* context) {
   ColumnFamilyData* cfd;
+  if (immutable_db_options_.atomic_flush) {
+    // The memtables of all the column families are switched together.
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+    return SwitchMemtablesForAtomicFlush(context,
+                                         FlushReason::kWriteBufferFull);
+  }
   while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
     auto status = SwitchMemtable(cfd, context, FlushReason::kWriteBufferFull);
     if (cfd->Unref()) {
@@ -1231,6 +1663,31 @@ Status DBImpl::ScheduleFlushes(WriteContext* context) {
   return Status::OK();
 }
 
+Status DBImpl::SwitchMemtablesForAtomicFlush(WriteContext* context,
+                                             FlushReason flush_reason) {
+  mutex_.AssertHeld();
+  assert(immutable_db_options_.atomic_flush);
+  Status status;
+  switching_memtables_for_atomic_flush_ = true;
+  // no need to refcount because drop is happening in write thread, so can't
+  // happen while we're in the write thread
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || cfd->mem()->IsEmpty()) {
+      continue;
+    }
+    status = SwitchMemtable(cfd, context, flush_reason);
+    if (!status.ok()) {
+      break;
+    }
+    cfd->imm()->FlushRequested();
+    SchedulePendingFlush(cfd, flush_reason);
+  }
+  switching_memtables_for_atomic_flush_ = false;
+  bg_cv_.SignalAll();
+  MaybeScheduleFlushOrCompaction();
+  return status;
+}
+
 #ifndef ROCKSDB_LITE
 void DBImpl::NotifyOnMemTableSealed(ColumnFamilyData* /*cfd*/,
                                     const MemTableInfo& mem_table_info) {
@@ -1259,6 +1716,14 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context,
     nonmem_write_thread_.EnterUnbatched(&nonmem_w, &mutex_);
   }
 
+  // With unordered_write, wait for the writers of the previous write groups
+  // to finish their inserts into the memtable being switched.
+  if (immutable_db_options_.unordered_write) {
+    mutex_.Unlock();
+    WaitForPendingMemTableWrites();
+    mutex_.Lock();
+  }
+
   unique_ptr<WritableFile> lfile;
   log::Writer* new_log = nullptr;
   MemTable* new_mem = nullptr;
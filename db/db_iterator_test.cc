@@ -1978,6 +1978,64 @@ TEST_P(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, AsyncReadAhead) {
+  Options options;
+  env_->count_random_reads_ = true;
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(1024, 'a');
+  for (int level = 2; level >= 0; --level) {
+    for (int i = level; i < 300; i += 3) {
+      Put(Key(i), value);
+    }
+    ASSERT_OK(Flush());
+    if (level > 0) {
+      MoveFilesToLevel(level);
+    }
+  }
+#ifndef ROCKSDB_LITE
+  ASSERT_EQ("1,1,1", FilesPerLevel());
+#endif  // !ROCKSDB_LITE
+
+  for (size_t readahead_size : {static_cast<size_t>(0),
+                                static_cast<size_t>(10 * 1024)}) {
+    ReadOptions read_options;
+    read_options.async_readahead = true;
+    read_options.readahead_size = readahead_size;
+
+    env_->random_read_bytes_counter_ = 0;
+    options.statistics->setTickerCount(NO_FILE_OPENS, 0);
+    auto* iter = NewIterator(read_options);
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(count), iter->key().ToString());
+      ASSERT_EQ(value, iter->value());
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(300, count);
+    for (int i = 299; i >= 0; i -= 7) {
+      iter->Seek(Key(i));
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(Key(i), iter->key().ToString());
+    }
+    delete iter;
+    // The readahead is done by the table iterators themselves, on the table
+    // readers of the table cache
+    ASSERT_EQ(0, TestGetTickerCount(options, NO_FILE_OPENS));
+    if (readahead_size > 0) {
+      ASSERT_GT(env_->random_read_bytes_counter_, 3 * 100 * value.size());
+    }
+  }
+}
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
@@ -262,6 +262,81 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+#ifndef ROCKSDB_LITE
+TEST_F(DBMemTableTest, ShardedMemTable) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  options.memtable_factory.reset(
+      NewShardedRepFactory(std::make_shared<SkipListFactory>(), 4));
+  DestroyAndReopen(options);
+
+  const int kNumThreads = 4;
+  const int kKeysPerThread = 500;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kKeysPerThread; i++) {
+        int k = i * kNumThreads + t;
+        ASSERT_OK(Put(Key(k), "v" + ToString(k)));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // Overwrite some keys so that a user key has several versions
+  for (int k = 0; k < kNumThreads * kKeysPerThread; k += 7) {
+    ASSERT_OK(Put(Key(k), "w" + ToString(k)));
+  }
+
+  const int kNumKeys = kNumThreads * kKeysPerThread;
+  auto expected_value = [](int k) {
+    return (k % 7 == 0 ? "w" : "v") + ToString(k);
+  };
+  for (int k = 0; k < kNumKeys; k++) {
+    ASSERT_EQ(expected_value(k), Get(Key(k)));
+  }
+
+  // The iterators merge the shards in order, in both directions
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int k = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), k++) {
+    ASSERT_EQ(Key(k), iter->key().ToString());
+    ASSERT_EQ(expected_value(k), iter->value().ToString());
+  }
+  ASSERT_EQ(kNumKeys, k);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    k--;
+    ASSERT_EQ(Key(k), iter->key().ToString());
+  }
+  ASSERT_EQ(0, k);
+
+  // Change direction in the middle
+  iter->Seek(Key(100));
+  ASSERT_EQ(Key(100), iter->key().ToString());
+  iter->Next();
+  ASSERT_EQ(Key(101), iter->key().ToString());
+  iter->Prev();
+  ASSERT_EQ(Key(100), iter->key().ToString());
+  iter->Prev();
+  ASSERT_EQ(Key(99), iter->key().ToString());
+  iter->Next();
+  ASSERT_EQ(Key(100), iter->key().ToString());
+  iter->SeekForPrev(Key(200));
+  ASSERT_EQ(Key(200), iter->key().ToString());
+  iter->Next();
+  ASSERT_EQ(Key(201), iter->key().ToString());
+  iter.reset();
+
+  // The flushed file holds the same data
+  ASSERT_OK(Flush());
+  for (k = 0; k < kNumKeys; k += 13) {
+    ASSERT_EQ(expected_value(k), Get(Key(k)));
+  }
+}
+#endif  // ROCKSDB_LITE
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
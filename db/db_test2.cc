@@ -454,6 +454,127 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest2, CostAwareWriteBufferFlush) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  // Avoid undeterministic value by malloc_usable_size();
+  // Force arena block size to 1
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::Arena:0", [&](void* arg) {
+        size_t* block_size = static_cast<size_t*>(arg);
+        *block_size = 1;
+      });
+
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "Arena::AllocateNewBlock:0", [&](void* arg) {
+        std::pair<size_t*, size_t*>* pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        *std::get<0>(*pair) = *std::get<1>(*pair);
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  options.write_buffer_size = 500000;  // this is never hit
+  // The soft limit is about 105000.
+  options.write_buffer_manager.reset(new WriteBufferManager(
+      120000, {} /* cache */, false /* allow_stall */,
+      WriteBufferFlushPolicy::kCostAware));
+  CreateAndReopenWithCF({"cf1", "cf2"}, options);
+
+  std::function<void()> wait_flush = [&]() {
+    dbfull()->TEST_WaitForFlushMemTable(handles_[0]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[1]);
+    dbfull()->TEST_WaitForFlushMemTable(handles_[2]);
+  };
+
+  // "cf1" has the oldest entry but little data, and "cf2" the most data.
+  // The oldest memtable policy would flush "cf1", whose flush frees little.
+  WriteOptions wo;
+  wo.disableWAL = true;
+  ASSERT_OK(Put(1, Key(1), DummyString(1), wo));
+  ASSERT_OK(Put(2, Key(1), DummyString(60000), wo));
+  ASSERT_OK(Put(0, Key(1), DummyString(50000), wo));
+  ASSERT_OK(Put(0, Key(2), DummyString(1), wo));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf1"),
+            static_cast<uint64_t>(0));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(1));
+
+  // Now "cf1" is the only column family with data in the oldest WAL, which
+  // makes it worth flushing even if it has little data.
+  DestroyAndReopen(options);
+  CreateAndReopenWithCF({"cf1", "cf2"}, options);
+  ASSERT_OK(Put(1, Key(1), DummyString(1)));
+  ASSERT_OK(Put(0, Key(1), DummyString(1)));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Put(2, Key(1), DummyString(60000)));
+  ASSERT_OK(Put(0, Key(1), DummyString(50000)));
+  ASSERT_OK(Put(0, Key(2), DummyString(1)));
+  wait_flush();
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "default"),
+            static_cast<uint64_t>(1));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf1"),
+            static_cast<uint64_t>(1));
+  ASSERT_EQ(GetNumberOfSstFilesForColumnFamily(db_, "cf2"),
+            static_cast<uint64_t>(0));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+}
+
+TEST_F(DBTest2, WriteBufferManagerStall) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 500000;  // this is never hit
+  options.max_write_buffer_number = 16;
+  options.write_buffer_manager.reset(new WriteBufferManager(
+      100000, {} /* cache */, true /* allow_stall */));
+  WriteBufferManager* wbm = options.write_buffer_manager.get();
+
+  // Block the flushes, so that the memory of the memtables is not freed
+  env_->SetBackgroundThreads(1, Env::LOW);
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  test::SleepingBackgroundTask sleeping_task_low;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task_low,
+                 Env::Priority::LOW);
+  test::SleepingBackgroundTask sleeping_task_high;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+                 &sleeping_task_high, Env::Priority::HIGH);
+  Reopen(options);
+
+  WriteController& write_controller = dbfull()->TEST_write_controler();
+  const uint64_t max_rate = write_controller.max_delayed_write_rate();
+  int last_level = 0;
+  for (int i = 0; i < 8; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(20000)));
+    // The stall level only goes up while the flushes cannot free memory,
+    // and the write rate goes down with it.
+    ASSERT_GE(wbm->StallLevel(), last_level);
+    last_level = wbm->StallLevel();
+  }
+  ASSERT_GT(last_level, 0);
+  ASSERT_LE(last_level, WriteBufferManager::kMaxStallLevel);
+  // The DB takes the stall level into account before each write
+  ASSERT_OK(Put(Key(100), "v"));
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  ASSERT_FALSE(write_controller.IsStopped());
+  ASSERT_EQ(max_rate >> last_level, write_controller.delayed_write_rate());
+
+  // Once the flushes free the memory, the writes are not delayed anymore
+  sleeping_task_high.WakeUp();
+  sleeping_task_high.WaitUntilDone();
+  sleeping_task_low.WakeUp();
+  sleeping_task_low.WaitUntilDone();
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, wbm->StallLevel());
+  ASSERT_OK(Put(Key(101), "v"));
+  ASSERT_FALSE(write_controller.NeedsDelay());
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(DummyString(20000), Get(Key(i)));
+  }
+}
+
 namespace {
   void ValidateKeyExistence(DB* db, const std::vector<Slice>& keys_must_exist,
     const std::vector<Slice>& keys_must_not_exist) {
@@ -111,7 +111,9 @@ bool DBTestBase::ShouldSkipOptions(int option_config, int skip_mask) {
       option_config == kUniversalCompactionMultiLevel ||
       option_config == kUniversalSubcompactions ||
       option_config == kFIFOCompaction ||
-      option_config == kConcurrentSkipList) {
+      option_config == kConcurrentSkipList ||
+      option_config == kUnorderedWrite || option_config == kBPlusTreeRep ||
+      option_config == kShardedSkipList) {
     return true;
     }
 #endif
@@ -347,6 +349,14 @@ Options DBTestBase::GetOptions(
           NewHashCuckooRepFactory(options.write_buffer_size));
       options.allow_concurrent_memtable_write = false;
       break;
+    case kBPlusTreeRep:
+      options.memtable_factory.reset(new BPlusTreeFactory());
+      break;
+    case kShardedSkipList:
+      options.memtable_factory.reset(
+          NewShardedRepFactory(std::make_shared<SkipListFactory>(), 4));
+      options.allow_concurrent_memtable_write = true;
+      break;
       case kDirectIO: {
         options.use_direct_reads = true;
         options.use_direct_io_for_flush_and_compaction = true;
@@ -502,6 +512,11 @@ Options DBTestBase::GetOptions(
       options.manual_wal_flush = true;
       break;
     }
+    case kUnorderedWrite: {
+      options.allow_concurrent_memtable_write = true;
+      options.unordered_write = true;
+      break;
+    }
 
     default:
       break;
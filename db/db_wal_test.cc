@@ -521,6 +521,45 @@ TEST_F(DBWALTest, FullPurgePreservesRecycledLog) {
   }
 }
 
+TEST_F(DBWALTest, PmemWAL) {
+  for (size_t recycle_log_file_num : {0, 2}) {
+    Options options = CurrentOptions();
+    options.use_pmem_for_wal = true;
+    options.recycle_log_file_num = recycle_log_file_num;
+    options.write_buffer_size = 64 << 10;
+    DestroyAndReopen(options);
+
+    // Take the cache line flush path even if the WAL is not on DAX
+    rocksdb::SyncPoint::GetInstance()->SetCallBack(
+        "PosixMmapFile::MapNewRegion:MapSync",
+        [&](void* arg) { *static_cast<bool*>(arg) = true; });
+    rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+    WriteOptions wo;
+    wo.sync = true;
+    Random rnd(301);
+    std::vector<std::string> values;
+    // Write enough to flush some memtables and map several regions
+    for (int i = 0; i < 300; i++) {
+      values.push_back(RandomString(&rnd, i % 3 == 0 ? 3000 : 10));
+      ASSERT_OK(Put(Key(i), values.back(), wo));
+    }
+
+    rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+    rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+    Reopen(options);
+    for (int i = 0; i < 300; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+  }
+
+  Options options = CurrentOptions();
+  options.use_pmem_for_wal = true;
+  options.two_write_queues = true;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+}
+
 TEST_F(DBWALTest, GetSortedWalFiles) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -15,6 +15,7 @@
 #include "util/fault_injection_test_env.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
+#include "utilities/merge_operators.h"
 
 namespace rocksdb {
 
@@ -140,10 +141,131 @@ TEST_P(DBWriteTest, IOErrorOnWALWriteTriggersReadOnlyMode) {
   Close();
 }
 
+TEST_P(DBWriteTest, ConcurrentWritesAcrossMemTableSwitches) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 500;
+  Options options = GetOptions();
+  options.write_buffer_size = 32 << 10;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  // Memtables fill up and are switched while the writers of earlier write
+  // groups may still be inserting; no write may be lost in the switch.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.push_back(port::Thread([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        WriteBatch batch;
+        ASSERT_OK(batch.Put(key, std::string(100, 'v')));
+        if (i % 50 == 0) {
+          ASSERT_OK(batch.Merge("merge" + ToString(t), "m"));
+        }
+        ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+      }
+    }));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(std::string(100, 'v'),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+    ASSERT_EQ("m,m,m,m,m,m,m,m,m,m", Get("merge" + ToString(t)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(std::string(100, 'v'), Get("key0_0"));
+}
+
+TEST_P(DBWriteTest, MemTableInsertHintPerBatch) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumBatches = 50;
+  constexpr int kBatchSize = 20;
+  Options options = GetOptions();
+  options.write_buffer_size = 64 << 10;
+  Reopen(options);
+
+  WriteOptions write_options;
+  write_options.memtable_insert_hint_per_batch = true;
+  // Each batch holds a sorted run of keys, which interleaves with the runs
+  // of the other threads, and deletes the first key of its previous batch.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.push_back(port::Thread([&, t]() {
+      for (int b = 0; b < kNumBatches; b++) {
+        WriteBatch batch;
+        for (int i = 0; i < kBatchSize; i++) {
+          char key[32];
+          snprintf(key, sizeof(key), "key%06d_%d", b * kBatchSize + i, t);
+          ASSERT_OK(batch.Put(key, std::string(100, 'v')));
+        }
+        if (b > 0) {
+          char key[32];
+          snprintf(key, sizeof(key), "key%06d_%d", (b - 1) * kBatchSize, t);
+          ASSERT_OK(batch.Delete(key));
+        }
+        ASSERT_OK(dbfull()->Write(write_options, &batch));
+      }
+    }));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int k = 0; k < kNumBatches * kBatchSize; k++) {
+      char key[32];
+      snprintf(key, sizeof(key), "key%06d_%d", k, t);
+      bool deleted = k % kBatchSize == 0 && k / kBatchSize < kNumBatches - 1;
+      ASSERT_EQ(deleted ? "NOT_FOUND" : std::string(100, 'v'), Get(key));
+    }
+  }
+}
+
+TEST_P(DBWriteTest, PrecomputedWALChecksums) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 100;
+  Options options = GetOptions();
+  options.precompute_wal_checksums = true;
+  // Fail the reopen on any WAL record with a bad checksum.
+  options.wal_recovery_mode = WALRecoveryMode::kAbsoluteConsistency;
+  Reopen(options);
+
+  // Values of varying sizes mix batches checksummed by the writers with
+  // ones left to the leader, and records larger than a WAL block.
+  auto value_size = [](int t, int i) {
+    return (i % 20 == 0) ? 40000 : (t * 37 + i * 11) % 2000;
+  };
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.push_back(port::Thread([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        ASSERT_OK(Put(key, std::string(value_size(t, i), 'a' + t)));
+      }
+    }));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  Reopen(options);
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(std::string(value_size(t, i), 'a' + t),
+                Get("key" + ToString(t) + "_" + ToString(i)));
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
-                                        DBTestBase::kPipelinedWrite));
+                                        DBTestBase::kPipelinedWrite,
+                                        DBTestBase::kUnorderedWrite));
 
 }  // namespace rocksdb
 
@@ -179,6 +179,11 @@ class InternalKeyComparator
 
   const Comparator* user_comparator() const { return user_comparator_; }
 
+  // Whether keys are ordered by their user key first, so that searches can
+  // be narrowed down on the user key alone. Test comparators that order the
+  // raw keys with the user comparator return false.
+  virtual bool OrdersByUserKey() const { return true; }
+
   int Compare(const InternalKey& a, const InternalKey& b) const;
   int Compare(const ParsedInternalKey& a, const ParsedInternalKey& b) const;
   virtual const Comparator* GetRootComparator() const override {
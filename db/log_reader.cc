@@ -394,8 +394,8 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
       // Skip zero length record without reporting any drops since
       // such records are produced by the mmap based writing code in
       // env_posix.cc that preallocates file regions.
-      // NOTE: this should never happen in DB written by new RocksDB versions,
-      // since we turn off mmap writes to manifest and log files
+      // NOTE: in DBs written by new RocksDB versions, this only happens to
+      // log files written with use_pmem_for_wal
       buffer_.clear();
       return kBadRecord;
     }
@@ -7,8 +7,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <stdio.h>
+#include <vector>
+
+#include "db/concurrent_log_writer.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
+#include "port/port.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
@@ -266,6 +271,21 @@ class LogTest : public ::testing::TestWithParam<int> {
     }
   }
 
+  // Read all the records of the log in *contents.
+  std::vector<std::string> ReadAllRecords(Slice* contents) {
+    unique_ptr<SequentialFileReader> file_reader(test::GetSequentialFileReader(
+        new StringSource(*contents), "" /* fname */));
+    Reader reader(nullptr, std::move(file_reader), &report_, true /*checksum*/,
+                  0 /*initial_offset*/, 123);
+    std::vector<std::string> records;
+    Slice record;
+    std::string scratch;
+    while (reader.ReadRecord(&record, &scratch)) {
+      records.push_back(record.ToString());
+    }
+    return records;
+  }
+
   void CheckOffsetPastEndReturnsNoRecords(uint64_t offset_past_end) {
     WriteInitialOffsetLog();
     unique_ptr<SequentialFileReader> file_reader(test::GetSequentialFileReader(
@@ -728,6 +748,85 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, TailChecksumSameFormat) {
+  // Records with a checksum of their tail are written the same whether they
+  // fit in a fragment or not.
+  test::StringSink* sink = new test::StringSink();
+  Writer tail_crc_writer(
+      unique_ptr<WritableFileWriter>(test::GetWritableFileWriter(sink)), 123,
+      GetParam());
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    std::string record = RandomSkewedString(i, &rnd);
+    size_t offset = rnd.Uniform(static_cast<int>(record.size()) + 1);
+    Write(record);
+    ASSERT_OK(tail_crc_writer.AddRecord(
+        Slice(record), offset,
+        crc32c::Value(record.data() + offset, record.size() - offset)));
+  }
+  ASSERT_EQ(get_reader_contents()->ToString(), sink->contents());
+}
+
+TEST_P(LogTest, ConcurrentWriterSameFormat) {
+  // With the smallest buffer, the records larger than two blocks are copied
+  // in pieces.
+  test::StringSink* sink = new test::StringSink();
+  ConcurrentWriter concurrent_writer(
+      unique_ptr<WritableFileWriter>(test::GetWritableFileWriter(sink)), 123,
+      GetParam(), 0 /* buffer_size */);
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    std::string record = RandomSkewedString(i, &rnd);
+    Write(record);
+    ASSERT_OK(concurrent_writer.AddRecord(Slice(record), i % 10 == 0));
+  }
+  ASSERT_OK(concurrent_writer.AddRecord(Slice()));
+  Write("");
+  ASSERT_OK(concurrent_writer.Close());
+  ASSERT_EQ(get_reader_contents()->ToString(), sink->contents());
+}
+
+TEST_P(LogTest, ConcurrentWriterMultipleThreads) {
+  const int kNumThreads = 8;
+  const int kNumRecords = 200;
+  Slice contents;
+  ConcurrentWriter concurrent_writer(
+      unique_ptr<WritableFileWriter>(
+          test::GetWritableFileWriter(new test::StringSink(&contents))),
+      123, GetParam(), 1 << 17 /* buffer_size */);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      for (int i = 0; i < kNumRecords; i++) {
+        std::string record = NumberString(t) + NumberString(i) +
+                             BigString("x", rnd.Skewed(18));
+        ASSERT_OK(concurrent_writer.AddRecord(Slice(record), i % 50 == 0));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(concurrent_writer.Close());
+
+  // Every record is read back once, and the records of a thread are in the
+  // order it added them.
+  std::vector<int> next_record(kNumThreads, 0);
+  for (const auto& record : ReadAllRecords(&contents)) {
+    int t, i;
+    ASSERT_EQ(2, sscanf(record.c_str(), "%d.%d.", &t, &i));
+    ASSERT_GE(t, 0);
+    ASSERT_LT(t, kNumThreads);
+    ASSERT_EQ(next_record[t], i);
+    next_record[t]++;
+  }
+  for (int t = 0; t < kNumThreads; t++) {
+    ASSERT_EQ(kNumRecords, next_record[t]);
+  }
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
 INSTANTIATE_TEST_CASE_P(bool, LogTest, ::testing::Values(0, 2));
 
 }  // namespace log
@@ -36,6 +36,17 @@ Writer::~Writer() { WriteBuffer(); }
 Status Writer::WriteBuffer() { return dest_->Flush(); }
 
 Status Writer::AddRecord(const Slice& slice) {
+  return AddRecordImpl(slice, nullptr, 0);
+}
+
+Status Writer::AddRecord(const Slice& slice, size_t offset,
+                         uint32_t tail_crc) {
+  assert(offset <= slice.size());
+  return AddRecordImpl(slice, &offset, tail_crc);
+}
+
+Status Writer::AddRecordImpl(const Slice& slice, const size_t* offset,
+                             uint32_t tail_crc) {
   const char* ptr = slice.data();
   size_t left = slice.size();
 
@@ -84,7 +95,12 @@ Status Writer::AddRecord(const Slice& slice) {
       type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
     }
 
-    s = EmitPhysicalRecord(type, ptr, fragment_length);
+    if (begin && end) {
+      // tail_crc can only be used when the fragment is the whole record
+      s = EmitPhysicalRecord(type, ptr, fragment_length, offset, tail_crc);
+    } else {
+      s = EmitPhysicalRecord(type, ptr, fragment_length);
+    }
     ptr += fragment_length;
     left -= fragment_length;
     begin = false;
@@ -94,7 +110,8 @@ Status Writer::AddRecord(const Slice& slice) {
 
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
-Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
+Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n,
+                                  const size_t* offset, uint32_t tail_crc) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -125,7 +142,12 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   }
 
   // Compute the crc of the record type and the payload.
-  crc = crc32c::Extend(crc, ptr, n);
+  if (offset != nullptr) {
+    crc = crc32c::Extend(crc, ptr, *offset);
+    crc = crc32c::Combine(crc, tail_crc, n - *offset);
+  } else {
+    crc = crc32c::Extend(crc, ptr, n);
+  }
   crc = crc32c::Mask(crc);  // Adjust for storage
   EncodeFixed32(buf, crc);
 
@@ -78,6 +78,11 @@ class Writer {
 
   Status AddRecord(const Slice& slice);
 
+  // Same as AddRecord(slice), for a caller that already has the crc32c of
+  // the bytes of slice from offset on, tail_crc. A record that fits in one
+  // fragment then only has the bytes before offset checksummed here.
+  Status AddRecord(const Slice& slice, size_t offset, uint32_t tail_crc);
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -98,7 +103,13 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
-  Status EmitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+  Status AddRecordImpl(const Slice& slice, const size_t* offset,
+                       uint32_t tail_crc);
+
+  // If offset is not null, tail_crc is the crc32c of ptr[*offset, length).
+  Status EmitPhysicalRecord(RecordType type, const char* ptr, size_t length,
+                            const size_t* offset = nullptr,
+                            uint32_t tail_crc = 0);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
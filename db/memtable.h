@@ -84,6 +84,9 @@ class MemTable {
                            const char* prefix_len_key2) const override;
     virtual int operator()(const char* prefix_len_key,
                            const DecodedType& key) const override;
+    virtual const Comparator* user_comparator() const override {
+      return comparator.user_comparator();
+    }
   };
 
   // MemTables are reference counted.  The initial reference count
@@ -167,11 +170,17 @@ class MemTable {
   // REQUIRES: if allow_concurrent = false, external synchronization to prevent
   // simultaneous operations on the same MemTable.
   //
+  // If allow_concurrent = true and hint is not null, *hint keeps the position
+  // of the last insert of the caller, and the insert starts its search from
+  // there. *hint must be null on the first call, and may not be shared by
+  // concurrent callers. Range deletions do not use the hint.
+  //
   // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
   // the <key, seq> already exists.
   bool Add(SequenceNumber seq, ValueType type, const Slice& key,
            const Slice& value, bool allow_concurrent = false,
-           MemTablePostProcessInfo* post_process_info = nullptr);
+           MemTablePostProcessInfo* post_process_info = nullptr,
+           void** hint = nullptr);
 
   // If memtable contains a value for key, store it in *value and return true.
   // If memtable contains a deletion for key, store a NotFound() error
@@ -447,6 +447,91 @@ Status MemTableList::InstallMemtableFlushResults(
   return s;
 }
 
+Status MemTableList::InstallMemtableAtomicFlushResults(
+    const autovector<ColumnFamilyData*>& cfds,
+    const autovector<const MutableCFOptions*>& mutable_cf_options_list,
+    const autovector<const autovector<MemTable*>*>& mems_list,
+    VersionSet* vset, InstrumentedMutex* mu,
+    const autovector<const FileMetaData*>& file_metas,
+    autovector<MemTable*>* to_delete, Directory* db_directory,
+    LogBuffer* log_buffer) {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_MEMTABLE_INSTALL_FLUSH_RESULTS);
+  mu->AssertHeld();
+
+  size_t num = mems_list.size();
+  assert(cfds.size() == num);
+  assert(mutable_cf_options_list.size() == num);
+  assert(file_metas.size() == num);
+
+  // flush was successful
+  for (size_t k = 0; k != num; ++k) {
+    const auto& mems = *mems_list[k];
+    assert(!mems.empty());
+    for (size_t i = 0; i != mems.size(); ++i) {
+      // All the edits are associated with the first memtable of this batch.
+      assert(i == 0 || mems[i]->GetEdits()->NumEntries() == 0);
+
+      mems[i]->flush_completed_ = true;
+      mems[i]->file_number_ = file_metas[k]->fd.GetNumber();
+    }
+  }
+
+  // The edits of all the column families are written as one atomic group,
+  // so that recovery applies either all or none of them.
+  std::vector<ColumnFamilyData*> tmp_cfds;
+  std::vector<MutableCFOptions> tmp_mutable_cf_options_list;
+  std::vector<autovector<VersionEdit*>> edit_lists;
+  uint32_t remaining = static_cast<uint32_t>(num);
+  for (size_t k = 0; k != num; ++k) {
+    VersionEdit* edit = (*mems_list[k])[0]->GetEdits();
+    edit->MarkAtomicGroup(--remaining);
+    tmp_cfds.push_back(cfds[k]);
+    tmp_mutable_cf_options_list.push_back(*mutable_cf_options_list[k]);
+    edit_lists.emplace_back(autovector<VersionEdit*>{edit});
+  }
+
+  // this can release and reacquire the mutex.
+  Status s = vset->LogAndApply(tmp_cfds, tmp_mutable_cf_options_list,
+                               edit_lists, mu, db_directory);
+
+  for (size_t k = 0; k != num; ++k) {
+    ColumnFamilyData* cfd = cfds[k];
+    MemTableList* imm = cfd->imm();
+    const auto& mems = *mems_list[k];
+    // we will be changing the version in the next code path,
+    // so we better create a new one, since versions are immutable
+    imm->InstallNewVersion();
+    // commit new state only if the column family is NOT dropped, as in
+    // InstallMemtableFlushResults().
+    if (s.ok() && !cfd->IsDropped()) {
+      for (size_t i = 0; i != mems.size(); ++i) {
+        MemTable* m = imm->current_->memlist_.back();
+        assert(m == mems[i]);
+        ROCKS_LOG_BUFFER(log_buffer, "[%s] Level-0 commit table #%" PRIu64
+                                     ": memtable #%" ROCKSDB_PRIszt " done",
+                         cfd->GetName().c_str(), m->file_number_, i + 1);
+        imm->current_->Remove(m, to_delete);
+      }
+    } else {
+      for (size_t i = 0; i != mems.size(); ++i) {
+        MemTable* m = mems[i];
+        // commit failed. setup state so that we can flush again.
+        ROCKS_LOG_BUFFER(log_buffer, "Level-0 commit table #%" PRIu64
+                                     ": memtable #%" ROCKSDB_PRIszt " failed",
+                         m->file_number_, i + 1);
+        m->flush_completed_ = false;
+        m->flush_in_progress_ = false;
+        m->edit_.Clear();
+        imm->num_flush_not_started_++;
+        m->file_number_ = 0;
+        imm->imm_flush_needed.store(true, std::memory_order_release);
+      }
+    }
+  }
+  return s;
+}
+
 // New memtables are inserted at the front of the list.
 void MemTableList::Add(MemTable* m, autovector<MemTable*>* to_delete) {
   assert(static_cast<int>(current_->memlist_.size()) >= num_flush_not_started_);
@@ -216,6 +216,19 @@ class MemTableList {
       autovector<MemTable*>* to_delete, Directory* db_directory,
       LogBuffer* log_buffer);
 
+  // Commit the successful flushes of several column families with a single
+  // atomic group of edits in the manifest file. mems_list[i] are the
+  // memtables of cfds[i] that were flushed to *file_metas[i], and must be
+  // the earliest memtables of its list.
+  static Status InstallMemtableAtomicFlushResults(
+      const autovector<ColumnFamilyData*>& cfds,
+      const autovector<const MutableCFOptions*>& mutable_cf_options_list,
+      const autovector<const autovector<MemTable*>*>& mems_list,
+      VersionSet* vset, InstrumentedMutex* mu,
+      const autovector<const FileMetaData*>& file_metas,
+      autovector<MemTable*>* to_delete, Directory* db_directory,
+      LogBuffer* log_buffer);
+
   // New memtables are inserted at the front of the list.
   // Takes ownership of the referenced held on *m by the caller of Add().
   void Add(MemTable* m, autovector<MemTable*>* to_delete);
@@ -211,6 +211,27 @@ InternalIterator* TableCache::NewIterator(
     create_new_table_reader = readahead > 0;
   }
 
+  // With async readahead the table iterator reads ahead by itself through a
+  // double-buffered FilePrefetchBuffer, so the file must not be wrapped in
+  // the synchronous readahead file too. The window size reaches the iterator
+  // through ReadOptions::readahead_size.
+  ReadOptions async_readahead_options;
+  const ReadOptions* iter_options = &options;
+  if (options.async_readahead) {
+    async_readahead_options = options;
+    iter_options = &async_readahead_options;
+    if (env_options.use_mmap_reads) {
+      // Nothing to read ahead into buffers
+      async_readahead_options.async_readahead = false;
+    } else {
+      async_readahead_options.readahead_size = readahead;
+      readahead = 0;
+      if (!for_compaction) {
+        create_new_table_reader = false;
+      }
+    }
+  }
+
   auto& fd = file_meta.fd;
   if (create_new_table_reader) {
     unique_ptr<TableReader> table_reader_unique_ptr;
@@ -240,8 +261,8 @@ InternalIterator* TableCache::NewIterator(
         !options.table_filter(*table_reader->GetTableProperties())) {
       result = NewEmptyInternalIterator<Slice>(arena);
     } else {
-      result = table_reader->NewIterator(options, prefix_extractor, arena,
-                                         skip_filters, for_compaction);
+      result = table_reader->NewIterator(*iter_options, prefix_extractor,
+                                         arena, skip_filters, for_compaction);
     }
     if (create_new_table_reader) {
       assert(handle == nullptr);
@@ -406,6 +427,98 @@ Status TableCache::Get(const ReadOptions& options,
   return s;
 }
 
+void TableCache::MultiGet(const ReadOptions& options,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileMetaData& file_meta, size_t num_keys,
+                          const Slice* ks, GetContext** get_contexts,
+                          Status* statuses,
+                          const SliceTransform* prefix_extractor,
+                          HistogramImpl* file_read_hist, bool skip_filters,
+                          int level) {
+#ifndef ROCKSDB_LITE
+  if (ioptions_.row_cache) {
+    // The row cache is keyed and filled one user key at a time.
+    for (size_t i = 0; i < num_keys; ++i) {
+      statuses[i] = Get(options, internal_comparator, file_meta, ks[i],
+                        get_contexts[i], prefix_extractor, file_read_hist,
+                        skip_filters, level);
+    }
+    return;
+  }
+#endif  // ROCKSDB_LITE
+  auto& fd = file_meta.fd;
+  Status s;
+  TableReader* t = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(env_options_, internal_comparator, fd, &handle,
+                  prefix_extractor,
+                  options.read_tier == kBlockCacheTier /* no_io */,
+                  true /* record_read_stats */, file_read_hist, skip_filters,
+                  level);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    }
+  }
+  if (!s.ok()) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+        // Couldn't find Table in cache but treat as kFound if no_io set
+        get_contexts[i]->MarkKeyMayExist();
+        statuses[i] = Status::OK();
+      } else {
+        statuses[i] = s;
+      }
+    }
+    return;
+  }
+
+  // Keys whose range tombstones could not be loaded are answered with the
+  // error and left out of the batch.
+  std::vector<Slice> batch_keys;
+  std::vector<GetContext*> batch_contexts;
+  std::vector<size_t> batch_index;
+  for (size_t i = 0; i < num_keys; ++i) {
+    statuses[i] = Status::OK();
+    GetContext* get_context = get_contexts[i];
+    if (get_context->range_del_agg() != nullptr &&
+        !options.ignore_range_deletions) {
+      std::unique_ptr<InternalIterator> range_del_iter(
+          t->NewRangeTombstoneIterator(options));
+      if (range_del_iter != nullptr) {
+        statuses[i] = range_del_iter->status();
+      }
+      if (statuses[i].ok()) {
+        statuses[i] = get_context->range_del_agg()->AddTombstones(
+            std::move(range_del_iter), &file_meta.smallest,
+            &file_meta.largest);
+      }
+    }
+    if (statuses[i].ok()) {
+      batch_keys.push_back(ks[i]);
+      batch_contexts.push_back(get_context);
+      batch_index.push_back(i);
+    }
+  }
+
+  if (batch_index.size() == num_keys) {
+    t->MultiGet(options, num_keys, ks, get_contexts, statuses,
+                prefix_extractor, skip_filters);
+  } else if (!batch_index.empty()) {
+    std::vector<Status> batch_statuses(batch_index.size());
+    t->MultiGet(options, batch_keys.size(), batch_keys.data(),
+                batch_contexts.data(), batch_statuses.data(), prefix_extractor,
+                skip_filters);
+    for (size_t j = 0; j < batch_index.size(); ++j) {
+      statuses[batch_index[j]] = batch_statuses[j];
+    }
+  }
+
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+}
+
 Status TableCache::GetTableProperties(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
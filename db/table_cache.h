@@ -74,6 +74,18 @@ class TableCache {
              HistogramImpl* file_read_hist = nullptr, bool skip_filters = false,
              int level = -1);
 
+  // Batched version of Get() for the sorted internal keys ks[0..num_keys-1],
+  // all of which may fall into the specified file. The table reader is
+  // looked up once for the batch and handed all of the keys together. The
+  // result for ks[i] is reported through get_contexts[i] and statuses[i].
+  void MultiGet(const ReadOptions& options,
+                const InternalKeyComparator& internal_comparator,
+                const FileMetaData& file_meta, size_t num_keys,
+                const Slice* ks, GetContext** get_contexts, Status* statuses,
+                const SliceTransform* prefix_extractor = nullptr,
+                HistogramImpl* file_read_hist = nullptr,
+                bool skip_filters = false, int level = -1);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
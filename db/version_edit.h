@@ -287,6 +287,14 @@ class VersionEdit {
     is_column_family_drop_ = true;
   }
 
+  // Mark this edit as part of an atomic group of edits that are applied
+  // together, followed by remaining_entries more edits of the group. Recovery
+  // ignores a group whose edits are not all in the MANIFEST.
+  void MarkAtomicGroup(uint32_t remaining_entries) {
+    is_in_atomic_group_ = true;
+    remaining_entries_ = remaining_entries;
+  }
+
   // return true on success.
   bool EncodeTo(std::string* dst) const;
   Status DecodeFrom(const Slice& src);
@@ -338,6 +346,9 @@ class VersionEdit {
   bool is_column_family_drop_;
   bool is_column_family_add_;
   std::string column_family_name_;
+
+  bool is_in_atomic_group_;
+  uint32_t remaining_entries_;
 };
 
 }  // namespace rocksdb
@@ -191,6 +191,22 @@ TEST_F(VersionEditTest, MinLogNumberToKeep) {
   TestEncodeDecode(edit);
 }
 
+TEST_F(VersionEditTest, AtomicGroupTest) {
+  VersionEdit edit;
+  edit.MarkAtomicGroup(1);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  ASSERT_OK(parsed.DecodeFrom(encoded));
+  ASSERT_NE(std::string::npos, parsed.DebugString().find("AtomicGroup: 1"));
+
+  edit.Clear();
+  edit.MarkAtomicGroup(0);
+  TestEncodeDecode(edit);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
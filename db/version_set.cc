@@ -1275,6 +1275,174 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   }
 }
 
+void Version::MultiGet(const ReadOptions& read_options,
+                       MultiGetKeyContext* keys, size_t num_keys) {
+  std::unique_ptr<PinnedIteratorsManager[]> pinned_iters_mgrs(
+      new PinnedIteratorsManager[num_keys]);
+  std::vector<std::unique_ptr<GetContext>> get_contexts(num_keys);
+  std::vector<std::unique_ptr<FilePicker>> file_pickers(num_keys);
+  // The file each key has to be searched in next, nullptr once the search
+  // of the key has ended
+  std::vector<FdWithKeyRange*> next_files(num_keys);
+  std::vector<bool> done(num_keys, false);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    MultiGetKeyContext& key = keys[i];
+    assert(key.status->ok() || key.status->IsMergeInProgress());
+    Slice user_key = key.lkey->user_key();
+    get_contexts[i].reset(new GetContext(
+        user_comparator(), merge_operator_, info_log_, db_statistics_,
+        key.status->ok() ? GetContext::kNotFound : GetContext::kMerge,
+        user_key, key.value, nullptr /* value_found */, key.merge_context,
+        key.range_del_agg, this->env_, nullptr /* seq */,
+        merge_operator_ ? &pinned_iters_mgrs[i] : nullptr));
+    // Pin blocks that we read to hold merge operands
+    if (merge_operator_) {
+      pinned_iters_mgrs[i].StartPinning();
+    }
+    file_pickers[i].reset(new FilePicker(
+        storage_info_.files_, user_key, key.lkey->internal_key(),
+        &storage_info_.level_files_brief_,
+        storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
+        user_comparator(), internal_comparator()));
+    next_files[i] = file_pickers[i]->GetNextFile();
+  }
+
+  std::vector<size_t> batch;
+  std::vector<Slice> batch_keys;
+  std::vector<GetContext*> batch_contexts;
+  std::vector<Status> batch_statuses;
+  while (true) {
+    // Every key visits its files in (level, position in level) order, so
+    // searching the pending files in that order lets each file be searched
+    // once for all of the keys that need it.
+    FdWithKeyRange* f = nullptr;
+    unsigned int level = 0;
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (next_files[i] == nullptr) {
+        continue;
+      }
+      unsigned int key_level = file_pickers[i]->GetHitFileLevel();
+      if (f == nullptr || key_level < level ||
+          (key_level == level && next_files[i] < f)) {
+        f = next_files[i];
+        level = key_level;
+      }
+    }
+    if (f == nullptr) {
+      break;
+    }
+
+    batch.clear();
+    batch_keys.clear();
+    batch_contexts.clear();
+    bool is_file_last_in_level = false;
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (next_files[i] != f) {
+        continue;
+      }
+      if (get_contexts[i]->sample()) {
+        sample_file_read_inc(f->file_metadata);
+      }
+      is_file_last_in_level = file_pickers[i]->IsHitFileLastInLevel();
+      batch.push_back(i);
+      batch_keys.push_back(keys[i].lkey->internal_key());
+      batch_contexts.push_back(get_contexts[i].get());
+    }
+    batch_statuses.resize(batch.size());
+
+    table_cache_->MultiGet(
+        read_options, *internal_comparator(), *f->file_metadata,
+        batch.size(), batch_keys.data(), batch_contexts.data(),
+        batch_statuses.data(), mutable_cf_options_.prefix_extractor.get(),
+        cfd_->internal_stats()->GetFileReadHist(level),
+        IsFilterSkipped(static_cast<int>(level), is_file_last_in_level),
+        static_cast<int>(level));
+
+    for (size_t j = 0; j < batch.size(); ++j) {
+      size_t i = batch[j];
+      GetContext& get_context = *get_contexts[i];
+      Status* status = keys[i].status;
+      *status = batch_statuses[j];
+      next_files[i] = nullptr;
+      // TODO: examine the behavior for corrupted key
+      if (!status->ok()) {
+        done[i] = true;
+        continue;
+      }
+
+      // report the counters before returning
+      if (get_context.State() != GetContext::kNotFound &&
+          get_context.State() != GetContext::kMerge &&
+          db_statistics_ != nullptr) {
+        get_context.ReportCounters();
+      }
+      switch (get_context.State()) {
+        case GetContext::kNotFound:
+        case GetContext::kMerge:
+          // Keep searching in other files
+          next_files[i] = file_pickers[i]->GetNextFile();
+          break;
+        case GetContext::kFound:
+          if (level == 0) {
+            RecordTick(db_statistics_, GET_HIT_L0);
+          } else if (level == 1) {
+            RecordTick(db_statistics_, GET_HIT_L1);
+          } else if (level >= 2) {
+            RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+          }
+          done[i] = true;
+          break;
+        case GetContext::kDeleted:
+          // Use empty error message for speed
+          *status = Status::NotFound();
+          done[i] = true;
+          break;
+        case GetContext::kCorrupt:
+          *status =
+              Status::Corruption("corrupted key for ", keys[i].lkey->user_key());
+          done[i] = true;
+          break;
+        case GetContext::kBlobIndex:
+          ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
+          *status = Status::NotSupported(
+              "Encounter unexpected blob index. Please open DB with "
+              "rocksdb::blob_db::BlobDB instead.");
+          done[i] = true;
+          break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (done[i]) {
+      continue;
+    }
+    GetContext& get_context = *get_contexts[i];
+    Status* status = keys[i].status;
+    if (db_statistics_ != nullptr) {
+      get_context.ReportCounters();
+    }
+    if (GetContext::kMerge == get_context.State()) {
+      if (!merge_operator_) {
+        *status = Status::InvalidArgument(
+            "merge_operator is not properly initialized.");
+        continue;
+      }
+      // merge_operands are in saver and we hit the beginning of the key
+      // history do a final merge of nullptr and operands;
+      PinnableSlice* value = keys[i].value;
+      *status = MergeHelper::TimedFullMerge(
+          merge_operator_, keys[i].lkey->user_key(), nullptr,
+          keys[i].merge_context->GetOperands(), value->GetSelf(), info_log_,
+          db_statistics_, env_, nullptr /* result_operand */, true);
+      value->PinSelf();
+    } else {
+      *status = Status::NotFound();  // Use an empty error message for speed
+    }
+  }
+}
+
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
@@ -2810,6 +2978,19 @@ Status VersionSet::ProcessManifestWrites(
       assert(last_writer != nullptr);
       assert(last_writer->cfd != nullptr);
       if (last_writer->cfd != nullptr && last_writer->cfd->IsDropped()) {
+        // The edits of an atomic group that are skipped are no longer
+        // counted by the edits of the group written before them.
+        for (const auto& e : last_writer->edit_list) {
+          if (!e->is_in_atomic_group_) {
+            continue;
+          }
+          for (auto rit = batch_edits.rbegin(); rit != batch_edits.rend() &&
+                                                (*rit)->is_in_atomic_group_ &&
+                                                (*rit)->remaining_entries_ > 0;
+               ++rit) {
+            --(*rit)->remaining_entries_;
+          }
+        }
         continue;
       }
       // We do a linear search on versions because versions is small.
@@ -2934,6 +3115,7 @@ Status VersionSet::ProcessManifestWrites(
         }
         TEST_KILL_RANDOM("VersionSet::LogAndApply:BeforeAddRecord",
                          rocksdb_kill_odds * REDUCE_ODDS2);
+        TEST_SYNC_POINT("VersionSet::LogAndApply:BeforeAddRecord");
         s = descriptor_log_->AddRecord(record);
         if (!s.ok()) {
           break;
@@ -3296,12 +3478,46 @@ Status VersionSet::Recover(
                        true /*checksum*/, 0 /*initial_offset*/, 0);
     Slice record;
     std::string scratch;
-    while (reader.ReadRecord(&record, &scratch) && s.ok()) {
-      VersionEdit edit;
-      s = edit.DecodeFrom(record);
-      if (!s.ok()) {
-        break;
+    // Edits ready to be applied. The edits of an atomic group are buffered
+    // in atomic_group until the last one of the group is read, so that a
+    // group that was not completely written is not applied.
+    std::deque<VersionEdit> pending_edits;
+    std::vector<VersionEdit> atomic_group;
+    while (s.ok()) {
+      if (pending_edits.empty()) {
+        if (!reader.ReadRecord(&record, &scratch)) {
+          break;
+        }
+        VersionEdit read_edit;
+        s = read_edit.DecodeFrom(record);
+        if (!s.ok()) {
+          break;
+        }
+        if (read_edit.is_in_atomic_group_) {
+          if (!atomic_group.empty() &&
+              atomic_group.back().remaining_entries_ !=
+                  read_edit.remaining_entries_ + 1) {
+            s = Status::Corruption("Manifest",
+                                   "inconsistent atomic group entry count");
+            break;
+          }
+          atomic_group.push_back(read_edit);
+          if (read_edit.remaining_entries_ == 0) {
+            pending_edits.insert(pending_edits.end(), atomic_group.begin(),
+                                 atomic_group.end());
+            atomic_group.clear();
+          }
+        } else if (!atomic_group.empty()) {
+          s = Status::Corruption("Manifest",
+                                 "atomic group interrupted by another edit");
+          break;
+        } else {
+          pending_edits.push_back(read_edit);
+        }
+        continue;
       }
+      VersionEdit edit = pending_edits.front();
+      pending_edits.pop_front();
 
       // Not found means that user didn't supply that column
       // family option AND we encountered column family add
@@ -3422,6 +3638,16 @@ Status VersionSet::Recover(
         have_last_sequence = true;
       }
     }
+
+    if (s.ok() && !atomic_group.empty()) {
+      // The MANIFEST write of the group was cut short, e.g. by a crash, so
+      // none of its edits took effect.
+      ROCKS_LOG_WARN(db_options_->info_log,
+                     "Ignoring %" ROCKSDB_PRIszt
+                     " edits of an incomplete atomic group at the end of "
+                     "the MANIFEST",
+                     atomic_group.size());
+    }
   }
 
   if (s.ok()) {
@@ -4150,6 +4376,7 @@ InternalIterator* VersionSet::MakeInputIterator(
   // (a) concurrent compactions,
   // (b) CompactionFilter::Decision::kRemoveAndSkipUntil.
   read_options.total_order_seek = true;
+  read_options.async_readahead = db_options_->compaction_async_readahead;
 
   // Level-0 files have to be merged together.  For other levels,
   // we will make a concatenating iterator per level.
@@ -89,6 +89,24 @@ extern void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
                                       const std::vector<FileMetaData*>& files,
                                       Arena* arena);
 
+// The state of one key of a batched point lookup. See Version::MultiGet().
+struct MultiGetKeyContext {
+  MultiGetKeyContext(const LookupKey* _lkey, PinnableSlice* _value,
+                     Status* _status, MergeContext* _merge_context,
+                     RangeDelAggregator* _range_del_agg)
+      : lkey(_lkey),
+        value(_value),
+        status(_status),
+        merge_context(_merge_context),
+        range_del_agg(_range_del_agg) {}
+
+  const LookupKey* lkey;
+  PinnableSlice* value;
+  Status* status;
+  MergeContext* merge_context;
+  RangeDelAggregator* range_del_agg;
+};
+
 class VersionStorageInfo {
  public:
   VersionStorageInfo(const InternalKeyComparator* internal_comparator,
@@ -565,6 +583,16 @@ class Version {
            bool* key_exists = nullptr, SequenceNumber* seq = nullptr,
            ReadCallback* callback = nullptr, bool* is_blob = nullptr);
 
+  // Batched version of Get() for keys[0..num_keys-1], whose lookup keys must
+  // be sorted in internal key order. Instead of walking the levels once per
+  // key, every file is searched once for all of the keys that may be in it,
+  // so the table reader can share index/filter lookups and block reads
+  // across the batch. Results are reported the same way as Get() reports
+  // them, through each key's value and status.
+  //
+  // REQUIRES: lock is not held
+  void MultiGet(const ReadOptions&, MultiGetKeyContext* keys, size_t num_keys);
+
   // Loads some stats information from files. Call without mutex held. It needs
   // to be called before applying the version to the version set.
   void PrepareApply(const MutableCFOptions& mutable_cf_options,
@@ -137,6 +137,10 @@ class WriteBatchInternal {
     return batch->rep_.size();
   }
 
+  // Returns the part of the batch after the header that goes to the WAL,
+  // which is what Append(dst, batch, /*WAL_only*/ true) appends.
+  static Slice WALContents(const WriteBatch* batch);
+
   static Status SetContents(WriteBatch* batch, const Slice& contents);
 
   static Status CheckSlicePartsLength(const SliceParts& key,
@@ -183,7 +187,8 @@ class WriteBatchInternal {
                            uint64_t log_number = 0, DB* db = nullptr,
                            bool concurrent_memtable_writes = false,
                            bool seq_per_batch = false, size_t batch_cnt = 0,
-                           bool batch_per_txn = true);
+                           bool batch_per_txn = true,
+                           bool hint_per_batch = false);
 
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
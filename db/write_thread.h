@@ -129,6 +129,8 @@ class WriteThread {
     SequenceNumber sequence;  // the sequence number to use for the first key
     Status status;            // status of memtable inserter
     Status callback_status;   // status returned by callback->Callback()
+    bool has_wal_checksum;    // if wal_checksum was computed by the writer
+    uint32_t wal_checksum;    // crc32c of WriteBatchInternal::WALContents()
 
     std::aligned_storage<sizeof(std::mutex)>::type state_mutex_bytes;
     std::aligned_storage<sizeof(std::condition_variable)>::type state_cv_bytes;
@@ -150,6 +152,8 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          has_wal_checksum(false),
+          wal_checksum(0),
           link_older(nullptr),
           link_newer(nullptr) {}
 
@@ -171,6 +175,8 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          has_wal_checksum(false),
+          wal_checksum(0),
           link_older(nullptr),
           link_newer(nullptr) {}
 
@@ -374,6 +374,10 @@ EnvOptions Env::OptimizeForLogWrite(const EnvOptions& env_options,
   optimized_env_options.bytes_per_sync = db_options.wal_bytes_per_sync;
   optimized_env_options.writable_file_max_buffer_size =
       db_options.writable_file_max_buffer_size;
+  if (db_options.use_pmem_for_wal) {
+    optimized_env_options.use_mmap_writes = true;
+    optimized_env_options.use_pmem_writes = true;
+  }
   return optimized_env_options;
 }
 
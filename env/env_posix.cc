@@ -900,7 +900,8 @@ class PosixEnv : public Env {
   EnvOptions OptimizeForLogWrite(const EnvOptions& env_options,
                                  const DBOptions& db_options) const override {
     EnvOptions optimized = env_options;
-    optimized.use_mmap_writes = false;
+    optimized.use_mmap_writes = db_options.use_pmem_for_wal;
+    optimized.use_pmem_writes = db_options.use_pmem_for_wal;
     optimized.use_direct_writes = false;
     optimized.bytes_per_sync = db_options.wal_bytes_per_sync;
     // TODO(icanadi) it's faster if fallocate_with_keep_size is false, but it
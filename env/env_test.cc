@@ -247,6 +247,51 @@ TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
   ASSERT_EQ(expected_data, actual_data);
 }
 
+TEST_F(EnvPosixTest, PmemWritableFile) {
+  // Take the cache line flush path even if the file is not on DAX
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "PosixMmapFile::MapNewRegion:MapSync",
+      [&](void* arg) { *static_cast<bool*>(arg) = true; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  std::string expected_data;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+  {
+    unique_ptr<WritableFile> wfile;
+    EnvOptions soptions;
+    soptions.use_mmap_writes = true;
+    soptions.use_pmem_writes = true;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+
+    // Append records of various sizes across several mapped regions,
+    // syncing some of them
+    Random rnd(301);
+    for (int i = 0; i < 100; i++) {
+      std::string record;
+      test::RandomString(&rnd, rnd.Uniform(8000), &record);
+      ASSERT_OK(wfile->Append(record));
+      expected_data.append(record);
+      if (i % 3 == 0) {
+        ASSERT_OK(wfile->Sync());
+      }
+    }
+    ASSERT_OK(wfile->Fsync());
+    ASSERT_OK(wfile->Close());
+  }
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  uint64_t file_size;
+  ASSERT_OK(env_->GetFileSize(fname, &file_size));
+  ASSERT_EQ(expected_data.size(), file_size);
+  unique_ptr<SequentialFile> seq_file;
+  ASSERT_OK(env_->NewSequentialFile(fname, &seq_file, EnvOptions()));
+  std::string scratch(expected_data.size(), '\0');
+  Slice result;
+  ASSERT_OK(seq_file->Read(scratch.size(), &result, &scratch[0]));
+  ASSERT_EQ(expected_data, result.ToString());
+}
+
 TEST_P(EnvPosixTestWithParam, UnSchedule) {
   std::atomic<bool> called(false);
   env_->SetBackgroundThreads(1, Env::LOW);
@@ -843,6 +888,55 @@ TEST_F(EnvPosixTest, PositionedAppend) {
 }
 #endif  // !ROCKSDB_LITE
 
+TEST_F(EnvPosixTest, SubmitReads) {
+  const std::string fname = test::TmpDir(env_) + "/submit_reads";
+  const size_t kFileSize = 1 << 20;
+  std::string data;
+  Random rnd(301);
+  test::RandomString(&rnd, static_cast<int>(kFileSize), &data);
+  {
+    unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, EnvOptions()));
+    ASSERT_OK(wfile->Append(data));
+    ASSERT_OK(wfile->Close());
+  }
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, EnvOptions()));
+
+  // Two batches in flight at once, the second one polled first. The last
+  // requests of each run past the end of the file.
+  const size_t kNumReqs = 300;
+  const size_t kLen = 5000;
+  std::vector<ReadRequest> reqs(2 * kNumReqs);
+  std::vector<std::unique_ptr<char[]>> scratch(reqs.size());
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    reqs[i].offset = (i * 7919 * kLen) % (kFileSize + 2 * kLen);
+    reqs[i].len = kLen;
+    scratch[i].reset(new char[kLen]);
+    reqs[i].scratch = scratch[i].get();
+  }
+  void* handles[2];
+  ASSERT_OK(file->SubmitReads(&reqs[0], kNumReqs, &handles[0]));
+  ASSERT_OK(file->SubmitReads(&reqs[kNumReqs], kNumReqs, &handles[1]));
+  Status s;
+  while ((s = file->PollReads(handles[1], false /* wait */)).IsIncomplete()) {
+  }
+  ASSERT_OK(s);
+  ASSERT_OK(file->PollReads(handles[0], true /* wait */));
+
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_len =
+        reqs[i].offset >= kFileSize
+            ? 0
+            : std::min(kLen, kFileSize - static_cast<size_t>(reqs[i].offset));
+    ASSERT_EQ(Slice(data.data() + std::min<size_t>(reqs[i].offset, kFileSize),
+                    expected_len),
+              reqs[i].result);
+  }
+  ASSERT_OK(env_->DeleteFile(fname));
+}
+
 // Only works in linux platforms
 TEST_P(EnvPosixTestWithParam, RandomAccessUniqueID) {
   // Create file.
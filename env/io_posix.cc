@@ -27,6 +27,11 @@
 #include <sys/syscall.h>
 #include <sys/sysmacros.h>
 #endif
+#ifdef ROCKSDB_IOURING_PRESENT
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <vector>
+#endif
 #include "env/posix_logger.h"
 #include "monitoring/iostats_context_imp.h"
 #include "port/port.h"
@@ -34,6 +39,7 @@
 #include "util/coding.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
+#include "util/thread_local.h"
 
 #if defined(OS_LINUX) && !defined(F_SET_RW_HINT)
 #define F_LINUX_SPECIFIC_BASE 1024
@@ -300,6 +306,343 @@ size_t PosixHelper::GetUniqueIdFromFile(int fd, char* id, size_t max_size) {
   return static_cast<size_t>(rid - id);
 }
 #endif
+
+#ifdef ROCKSDB_IOURING_PRESENT
+namespace {
+// A minimal io_uring instance driven through the raw system calls. Every
+// thread gets its own ring, so none of this needs to be thread-safe; the
+// only sharing is with the kernel, through the ring buffers.
+class IOUring {
+ public:
+  static const unsigned kQueueDepth = 256;
+
+  // Returns the ring of the calling thread, creating it on first use, or
+  // nullptr if the kernel does not support io_uring.
+  static IOUring* ForThisThread();
+
+  ~IOUring();
+
+  // Number of reads that can be queued right now.
+  size_t Capacity() const {
+    return std::min<size_t>(sq_entries_ - queued_, cq_entries_ - in_flight_);
+  }
+
+  size_t in_flight() const { return in_flight_; }
+
+  // Queue a read of iov at offset of fd. Capacity() must be non-zero.
+  void QueueRead(int fd, const struct iovec* iov, uint64_t offset,
+                 void* user_data);
+
+  // Hand the queued reads to the kernel and return how many of them it
+  // took, in queueing order. Reads it did not take are dropped from the
+  // queue, so the caller can retry them later or read them itself.
+  size_t Submit();
+
+  // Pop one completion. If none is available and wait is true, block until
+  // one is (as long as any read is in flight). Returns false if there was no
+  // completion to return.
+  bool Reap(bool wait, void** user_data, int* res);
+
+ private:
+  IOUring() = default;
+  bool Init();
+
+  int ring_fd_ = -1;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+  unsigned cq_entries_ = 0;
+
+  // Queued but not yet submitted
+  size_t queued_ = 0;
+  // Submitted but not yet reaped
+  size_t in_flight_ = 0;
+};
+
+IOUring* IOUring::ForThisThread() {
+  // Leaked on purpose, like the other ThreadLocalPtr singletons, so that
+  // threads exiting during shutdown can still release their rings.
+  static ThreadLocalPtr* rings = new ThreadLocalPtr(
+      [](void* ptr) { delete static_cast<IOUring*>(ptr); });
+  static std::atomic<bool> unsupported(false);
+
+  if (unsupported.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  IOUring* ring = static_cast<IOUring*>(rings->Get());
+  if (ring == nullptr) {
+    ring = new IOUring();
+    if (!ring->Init()) {
+      // Old kernel, or io_uring blocked by policy. Fall back to pread for
+      // good rather than retrying on every read.
+      delete ring;
+      unsupported.store(true, std::memory_order_relaxed);
+      return nullptr;
+    }
+    rings->Reset(ring);
+  }
+  return ring;
+}
+
+bool IOUring::Init() {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, kQueueDepth, &p));
+  if (fd < 0) {
+    return false;
+  }
+  ring_fd_ = fd;
+
+  sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+  single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  void* ptr = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+  sq_ring_ = ptr;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    ptr = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (ptr == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = ptr;
+  }
+  sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+  ptr = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(ptr);
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+  sq_entries_ = p.sq_entries;
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+  cq_entries_ = p.cq_entries;
+  return true;
+}
+
+IOUring::~IOUring() {
+  // A thread only exits with reads in flight if some batch was never polled
+  // to completion, which the SubmitReads() contract forbids.
+  assert(in_flight_ == 0);
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IOUring::QueueRead(int fd, const struct iovec* iov, uint64_t offset,
+                        void* user_data) {
+  assert(Capacity() > 0);
+  // Only this thread moves the tail; the kernel moves the head.
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & sq_mask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->addr = reinterpret_cast<uint64_t>(iov);
+  sqe->len = 1;
+  sqe->user_data = reinterpret_cast<uint64_t>(user_data);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++queued_;
+}
+
+size_t IOUring::Submit() {
+  size_t submitted = 0;
+  while (submitted < queued_) {
+    int ret = static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd_,
+                static_cast<unsigned>(queued_ - submitted), 0, 0, nullptr, 0));
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      // e.g. EAGAIN / EBUSY under memory or completion queue pressure
+      break;
+    }
+    submitted += ret;
+  }
+  if (submitted < queued_) {
+    // Without SQPOLL the kernel only consumes entries inside
+    // io_uring_enter(), so the ones it did not take can be withdrawn.
+    __atomic_store_n(sq_tail_,
+                     *sq_tail_ - static_cast<unsigned>(queued_ - submitted),
+                     __ATOMIC_RELEASE);
+  }
+  queued_ = 0;
+  in_flight_ += submitted;
+  return submitted;
+}
+
+bool IOUring::Reap(bool wait, void** user_data, int* res) {
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+      *user_data = reinterpret_cast<void*>(cqe->user_data);
+      *res = cqe->res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      --in_flight_;
+      return true;
+    }
+    if (!wait || in_flight_ == 0) {
+      return false;
+    }
+    // Errors (EINTR most likely) just lead to another look at the ring: the
+    // reads in flight still own their buffers, so giving up is not an option.
+    syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+            nullptr, 0);
+  }
+}
+
+// The reads of one PosixRandomAccessFile::SubmitReads() call, handed out as
+// its io_handle.
+struct AsyncReadBatch {
+  struct Read {
+    AsyncReadBatch* batch;
+    ReadRequest* req;
+    struct iovec iov;
+  };
+
+  AsyncReadBatch(const PosixRandomAccessFile* _file,
+                 const std::string* _file_name, int _fd, IOUring* _ring,
+                 ReadRequest* reqs, size_t num_reqs)
+      : file(_file),
+        file_name(_file_name),
+        fd(_fd),
+        ring(_ring),
+        reads(num_reqs) {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      reads[i].batch = this;
+      reads[i].req = &reqs[i];
+      reads[i].iov.iov_base = reqs[i].scratch;
+      reads[i].iov.iov_len = reqs[i].len;
+    }
+  }
+
+  bool Done() const { return next == reads.size() && in_flight == 0; }
+
+  // Queue as many of the not yet submitted reads as the ring has room for.
+  void SubmitMore();
+
+  // Record the outcome of one read as reported by the kernel.
+  void Complete(Read* read, int res);
+
+  const PosixRandomAccessFile* file;
+  const std::string* file_name;
+  int fd;
+  IOUring* ring;
+  std::vector<Read> reads;
+  // reads[0, next) have been submitted
+  size_t next = 0;
+  size_t in_flight = 0;
+};
+
+void AsyncReadBatch::SubmitMore() {
+  while (next < reads.size()) {
+    size_t n = std::min(ring->Capacity(), reads.size() - next);
+    if (n == 0) {
+      // The ring is busy with other reads; retry once some of them complete.
+      return;
+    }
+    for (size_t i = next; i < next + n; ++i) {
+      ring->QueueRead(fd, &reads[i].iov, reads[i].req->offset, &reads[i]);
+    }
+    size_t submitted = ring->Submit();
+    next += submitted;
+    in_flight += submitted;
+    if (submitted < n) {
+      if (ring->in_flight() == 0) {
+        // Nothing in flight that could free up the kernel, so read the rest
+        // ourselves instead of waiting for the ring.
+        for (; next < reads.size(); ++next) {
+          ReadRequest* req = reads[next].req;
+          req->status =
+              file->Read(req->offset, req->len, &req->result, req->scratch);
+        }
+      }
+      return;
+    }
+  }
+}
+
+void AsyncReadBatch::Complete(Read* read, int res) {
+  ReadRequest* req = read->req;
+  assert(in_flight > 0);
+  --in_flight;
+  if (res == -EINTR || res == -EAGAIN) {
+    req->status = file->Read(req->offset, req->len, &req->result, req->scratch);
+    return;
+  }
+  if (res < 0) {
+    req->status = IOError("While reading offset " + ToString(req->offset) +
+                              " len " + ToString(req->len),
+                          *file_name, -res);
+    req->result = Slice(req->scratch, 0);
+    return;
+  }
+  size_t n = static_cast<size_t>(res);
+  if (n > 0 && n < req->len &&
+      (!file->use_direct_io() ||
+       n % file->GetRequiredBufferAlignment() == 0)) {
+    // A short read that is not at the end of the file, which pread() would
+    // have retried too.
+    Slice rest;
+    req->status = file->Read(req->offset + n, req->len - n, &rest,
+                             req->scratch + n);
+    n += rest.size();
+  } else {
+    req->status = Status::OK();
+  }
+  req->result = Slice(req->scratch, n);
+}
+}  // namespace
+#endif  // ROCKSDB_IOURING_PRESENT
+
 /*
  * PosixRandomAccessFile
  *
@@ -356,6 +699,88 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status PosixRandomAccessFile::MultiRead(ReadRequest* reqs, size_t num_reqs) {
+#ifdef ROCKSDB_IOURING_PRESENT
+  if (num_reqs > 1 && IOUring::ForThisThread() != nullptr) {
+    void* io_handle = nullptr;
+    Status s = SubmitReads(reqs, num_reqs, &io_handle);
+    if (s.ok()) {
+      s = PollReads(io_handle, true /* wait */);
+    }
+    return s;
+  }
+#endif
+  if (!use_direct_io() && num_reqs > 1) {
+    // Let the kernel start reading all of the ranges before we block on the
+    // first one, so the device sees the whole batch at once instead of one
+    // pread at a time.
+    for (size_t i = 1; i < num_reqs; ++i) {
+      Fadvise(fd_, static_cast<off_t>(reqs[i].offset), reqs[i].len,
+              POSIX_FADV_WILLNEED);
+    }
+  }
+  for (size_t i = 0; i < num_reqs; ++i) {
+    ReadRequest& req = reqs[i];
+    req.status = Read(req.offset, req.len, &req.result, req.scratch);
+  }
+  return Status::OK();
+}
+
+Status PosixRandomAccessFile::SubmitReads(ReadRequest* reqs, size_t num_reqs,
+                                          void** io_handle) {
+  *io_handle = nullptr;
+#ifdef ROCKSDB_IOURING_PRESENT
+  IOUring* ring = num_reqs > 0 ? IOUring::ForThisThread() : nullptr;
+  if (ring != nullptr) {
+    if (use_direct_io()) {
+      for (size_t i = 0; i < num_reqs; ++i) {
+        assert(IsSectorAligned(reqs[i].offset, GetRequiredBufferAlignment()));
+        assert(IsSectorAligned(reqs[i].len, GetRequiredBufferAlignment()));
+        assert(IsSectorAligned(reqs[i].scratch, GetRequiredBufferAlignment()));
+      }
+    }
+    AsyncReadBatch* batch =
+        new AsyncReadBatch(this, &filename_, fd_, ring, reqs, num_reqs);
+    batch->SubmitMore();
+    *io_handle = batch;
+    return Status::OK();
+  }
+#endif
+  return MultiRead(reqs, num_reqs);
+}
+
+Status PosixRandomAccessFile::PollReads(void* io_handle, bool wait) {
+  if (io_handle == nullptr) {
+    return Status::OK();
+  }
+#ifdef ROCKSDB_IOURING_PRESENT
+  AsyncReadBatch* batch = static_cast<AsyncReadBatch*>(io_handle);
+  IOUring* ring = batch->ring;
+  assert(ring == IOUring::ForThisThread());
+  while (true) {
+    batch->SubmitMore();
+    if (batch->Done()) {
+      delete batch;
+      return Status::OK();
+    }
+    // The completion may belong to another batch of this thread, possibly of
+    // another file; it is recorded there all the same.
+    void* user_data = nullptr;
+    int res = 0;
+    if (ring->Reap(wait, &user_data, &res)) {
+      AsyncReadBatch::Read* read = static_cast<AsyncReadBatch::Read*>(user_data);
+      read->batch->Complete(read, res);
+    } else if (!wait) {
+      return Status::Incomplete();
+    }
+  }
+#else
+  (void)wait;
+  assert(false);
+  return Status::OK();
+#endif
+}
+
 Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
   Status s;
   if (!use_direct_io()) {
@@ -490,6 +915,61 @@ Status PosixMmapReadableFile::InvalidateCache(size_t offset, size_t length) {
 #endif
 }
 
+#if defined(OS_LINUX) && defined(__x86_64__) && defined(MAP_SYNC) && \
+    defined(MAP_SHARED_VALIDATE)
+#define ROCKSDB_MAP_SYNC_PRESENT
+
+namespace {
+
+enum class CacheFlushInstruction { kClflush, kClflushopt, kClwb };
+
+CacheFlushInstruction DetectCacheFlushInstruction() {
+  uint32_t max_leaf, ebx, ecx, edx;
+  __asm__("cpuid" : "=a"(max_leaf), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0));
+  if (max_leaf < 7) {
+    return CacheFlushInstruction::kClflush;
+  }
+  uint32_t eax;
+  __asm__("cpuid"
+          : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+          : "a"(7), "c"(0));
+  if (ebx & (1U << 24)) {
+    return CacheFlushInstruction::kClwb;
+  } else if (ebx & (1U << 23)) {
+    return CacheFlushInstruction::kClflushopt;
+  }
+  return CacheFlushInstruction::kClflush;
+}
+
+// Write the cache lines of [begin, end) back to memory, which makes them
+// durable if the memory is persistent. clwb and clflushopt are encoded by
+// hand, as they need newer assemblers.
+void PersistRange(const char* begin, const char* end) {
+  static const CacheFlushInstruction instruction =
+      DetectCacheFlushInstruction();
+  uintptr_t line =
+      reinterpret_cast<uintptr_t>(begin) & ~(uintptr_t{CACHE_LINE_SIZE} - 1);
+  for (; line < reinterpret_cast<uintptr_t>(end); line += CACHE_LINE_SIZE) {
+    volatile char* p = reinterpret_cast<volatile char*>(line);
+    switch (instruction) {
+      case CacheFlushInstruction::kClwb:
+        __asm__ volatile(".byte 0x66; xsaveopt %0" : "+m"(*p));
+        break;
+      case CacheFlushInstruction::kClflushopt:
+        __asm__ volatile(".byte 0x66; clflush %0" : "+m"(*p));
+        break;
+      default:
+        __asm__ volatile("clflush %0" : "+m"(*p));
+        break;
+    }
+  }
+  // Order the write-backs before the stores that follow
+  __asm__ volatile("sfence" : : : "memory");
+}
+
+}  // namespace
+#endif  // OS_LINUX && __x86_64__ && MAP_SYNC && MAP_SHARED_VALIDATE
+
 /*
  * PosixMmapFile
  *
@@ -497,10 +977,16 @@ Status PosixMmapReadableFile::InvalidateCache(size_t offset, size_t length) {
  * data to the file.  This is safe since we either properly close the
  * file before reading from it, or for log files, the reading code
  * knows enough to skip zero suffixes.
+ *
+ * With use_pmem_writes, the regions are mapped with MAP_SYNC where the file
+ * system supports it (DAX), and then syncs only flush the CPU cache lines
+ * of the appended data.
  */
 Status PosixMmapFile::UnmapCurrentRegion() {
   TEST_KILL_RANDOM("PosixMmapFile::UnmapCurrentRegion:0", rocksdb_kill_odds);
   if (base_ != nullptr) {
+    // The next sync only covers the next region
+    PersistAppended();
     int munmap_status = munmap(base_, limit_ - base_);
     if (munmap_status != 0) {
       return IOError("While munmap", filename_, munmap_status);
@@ -538,8 +1024,22 @@ Status PosixMmapFile::MapNewRegion() {
   }
 
   TEST_KILL_RANDOM("PosixMmapFile::Append:1", rocksdb_kill_odds);
-  void* ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
-                   file_offset_);
+  void* ptr = MAP_FAILED;
+#ifdef ROCKSDB_MAP_SYNC_PRESENT
+  if (map_sync_) {
+    ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED_VALIDATE | MAP_SYNC, fd_, file_offset_);
+    if (ptr == MAP_FAILED) {
+      // Not a DAX file system: sync with msync() and fdatasync() instead
+      map_sync_ = false;
+    }
+  }
+#endif
+  if (ptr == MAP_FAILED) {
+    ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+               file_offset_);
+  }
+  TEST_SYNC_POINT_CALLBACK("PosixMmapFile::MapNewRegion:MapSync", &map_sync_);
   if (ptr == MAP_FAILED) {
     return Status::IOError("MMap failed on " + filename_);
   }
@@ -571,6 +1071,15 @@ Status PosixMmapFile::Msync() {
   return Status::OK();
 }
 
+void PosixMmapFile::PersistAppended() {
+#ifdef ROCKSDB_MAP_SYNC_PRESENT
+  if (map_sync_ && dst_ != last_sync_) {
+    PersistRange(last_sync_, dst_);
+    last_sync_ = dst_;
+  }
+#endif
+}
+
 PosixMmapFile::PosixMmapFile(const std::string& fname, int fd, size_t page_size,
                              const EnvOptions& options)
     : filename_(fname),
@@ -581,7 +1090,12 @@ PosixMmapFile::PosixMmapFile(const std::string& fname, int fd, size_t page_size,
       limit_(nullptr),
       dst_(nullptr),
       last_sync_(nullptr),
-      file_offset_(0) {
+      file_offset_(0),
+#ifdef ROCKSDB_MAP_SYNC_PRESENT
+      map_sync_(options.use_pmem_writes) {
+#else
+      map_sync_(false) {
+#endif
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   allow_fallocate_ = options.allow_fallocate;
   fallocate_with_keep_size_ = options.fallocate_with_keep_size;
@@ -657,6 +1171,11 @@ Status PosixMmapFile::Close() {
 Status PosixMmapFile::Flush() { return Status::OK(); }
 
 Status PosixMmapFile::Sync() {
+  if (map_sync_) {
+    // MAP_SYNC page faults already made the file metadata durable
+    PersistAppended();
+    return Status::OK();
+  }
   if (fdatasync(fd_) < 0) {
     return IOError("While fdatasync mmapped file", filename_, errno);
   }
@@ -668,6 +1187,10 @@ Status PosixMmapFile::Sync() {
  * Flush data as well as metadata to stable storage.
  */
 Status PosixMmapFile::Fsync() {
+  if (map_sync_) {
+    PersistAppended();
+    return Status::OK();
+  }
   if (fsync(fd_) < 0) {
     return IOError("While fsync mmaped file", filename_, errno);
   }
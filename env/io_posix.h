@@ -91,6 +91,15 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const override;
 
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) override;
+
+  // Backed by a per-thread io_uring when the kernel supports it; otherwise
+  // the reads are done synchronously through MultiRead().
+  virtual Status SubmitReads(ReadRequest* reqs, size_t num_reqs,
+                             void** io_handle) override;
+
+  virtual Status PollReads(void* io_handle, bool wait) override;
+
   virtual Status Prefetch(uint64_t offset, size_t n) override;
 
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
@@ -177,6 +186,9 @@ class PosixMmapFile : public WritableFile {
   char* dst_;             // Where to write next  (in range [base_,limit_])
   char* last_sync_;       // Where have we synced up to
   uint64_t file_offset_;  // Offset of base_ in file
+  // If the regions are mapped with MAP_SYNC, so that flushing the CPU caches
+  // makes the data durable
+  bool map_sync_;
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   bool allow_fallocate_;  // If false, fallocate calls are bypassed
   bool fallocate_with_keep_size_;
@@ -194,6 +206,8 @@ class PosixMmapFile : public WritableFile {
   Status MapNewRegion();
   Status UnmapCurrentRegion();
   Status Msync();
+  // With map_sync_, makes the data appended since the last sync durable
+  void PersistAppended();
 
  public:
   PosixMmapFile(const std::string& fname, int fd, size_t page_size,
@@ -137,13 +137,27 @@ struct CompressionOptions {
   // Default: false.
   bool enabled;
 
+  // Number of threads compressing the data blocks of each block-based table
+  // file being built. With more than one, the thread building the file hands
+  // each finished data block to a pool of this many compression threads and
+  // writes the blocks in order as they complete, so that compression of one
+  // file can use several cores. Useful when compression is most of the cost
+  // of flushes and compactions, e.g. with ZSTD at high levels.
+  //
+  // Tables with block-based or partitioned filters, or with the hash index,
+  // are always compressed by the building thread.
+  //
+  // Default: 1.
+  uint32_t parallel_threads;
+
   CompressionOptions()
       : window_bits(-14),
         level(kDefaultCompressionLevel),
         strategy(0),
         max_dict_bytes(0),
         zstd_max_train_bytes(0),
-        enabled(false) {}
+        enabled(false),
+        parallel_threads(1) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes,
                      int _zstd_max_train_bytes, bool _enabled)
       : window_bits(wbits),
@@ -151,7 +165,8 @@ struct CompressionOptions {
         strategy(_strategy),
         max_dict_bytes(_max_dict_bytes),
         zstd_max_train_bytes(_zstd_max_train_bytes),
-        enabled(_enabled) {}
+        enabled(_enabled),
+        parallel_threads(1) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
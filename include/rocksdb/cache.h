@@ -23,6 +23,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include "rocksdb/slice.h"
@@ -32,6 +33,7 @@
 namespace rocksdb {
 
 class Cache;
+class SecondaryCache;
 
 struct LRUCacheOptions {
   // Capacity of the cache.
@@ -58,6 +60,20 @@ struct LRUCacheOptions {
   // BlockBasedTableOptions::cache_index_and_filter_blocks_with_high_priority.
   double high_pri_pool_ratio = 0.0;
 
+  // If true, once a shard is full a new low priority entry is only admitted
+  // if its estimated access frequency is higher than that of the entry it
+  // would evict (TinyLFU). Frequencies are tracked by a small count-min
+  // sketch of 4-bit counters per shard that is periodically halved, so
+  // scans and other one-time accesses cannot flush frequently used blocks.
+  // Rejected entries behave as if they were inserted and immediately
+  // evicted; a handle requested by the caller stays valid until released.
+  bool tiny_lfu_admission = false;
+
+  // If non-null, entries inserted with Cache::InsertWithHelper() are demoted
+  // to this cache when they are evicted, and Cache::LookupWithHelper()
+  // promotes them back on a hit. See rocksdb/secondary_cache.h.
+  std::shared_ptr<SecondaryCache> secondary_cache;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio)
@@ -83,10 +99,12 @@ extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
-// more detail.
+// better concurrent performance in some cases. Cache hits take no lock: the
+// lookup walks a hash table without locking, and entries are referenced and
+// marked as used with atomic operations. Inserts and evictions still take a
+// per shard mutex. See cache/clock_cache.cc for more detail.
 //
-// Return nullptr if it is not supported.
+// Return nullptr if it is not supported (in ROCKSDB_LITE).
 extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
                                             int num_shard_bits = -1,
                                             bool strict_capacity_limit = false);
@@ -108,6 +126,23 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // Callbacks that let a cache with a secondary tier save the value of an
+  // evicted entry in serialized form. See InsertWithHelper().
+  struct CacheItemHelper {
+    // Returns the size of the serialized form of value.
+    size_t (*size_cb)(void* value);
+    // Writes the serialized form of value, size_cb(value) bytes, to out.
+    void (*saveto_cb)(void* value, char* out);
+    // Deleter of the value, as passed to Insert().
+    void (*del_cb)(const Slice& key, void* value);
+  };
+
+  // Rebuilds a value from its serialized form and returns it with its
+  // charge. See LookupWithHelper().
+  typedef std::function<Status(const Slice& data, void** value,
+                               size_t* charge)>
+      CreateCallback;
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -140,6 +175,27 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Same as Insert(), with helper->del_cb as the deleter, but if the cache
+  // has a secondary tier, the entry is saved there through helper when it
+  // is evicted. helper must outlive the cache.
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+
+  // Same as Lookup(), but if the key is only found in the secondary tier,
+  // its value is rebuilt with create_cb and moved back into the cache as if
+  // by InsertWithHelper(key, value, helper, charge, handle, priority).
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* /*helper*/,
+                                   const CreateCallback& /*create_cb*/,
+                                   Priority /*priority*/,
+                                   Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
@@ -0,0 +1,93 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+#include "rocksdb/types.h"
+
+namespace rocksdb {
+
+// A compaction picked by a DB, as handed to its CompactionService
+struct CompactionServiceInput {
+  // The path of the DB, and the column family to compact
+  std::string db_name;
+  std::string column_family_name;
+
+  // The paths of the input table files
+  std::vector<std::string> input_files;
+  int output_level = 0;
+  // If the output level is the last level with data in the key range of the
+  // compaction, so that deletions can be dropped
+  bool bottommost_level = false;
+
+  CompressionType compression = kNoCompression;
+  uint64_t max_output_file_size = 0;
+
+  // The sequence numbers of the live snapshots, in increasing order, and the
+  // earliest one that transactions check write conflicts against
+  std::vector<SequenceNumber> snapshots;
+  SequenceNumber earliest_write_conflict_snapshot = 0;
+
+  // The directory to write the output files to. The DB creates it before
+  // the compaction and deletes it afterwards.
+  std::string output_directory;
+};
+
+// An output file of a compaction run by a CompactionService
+struct CompactionServiceOutputFile {
+  // The name of the file in CompactionServiceInput::output_directory
+  std::string file_name;
+  uint64_t file_size = 0;
+  std::string smallest_internal_key;
+  std::string largest_internal_key;
+  SequenceNumber smallest_seqno = 0;
+  SequenceNumber largest_seqno = 0;
+};
+
+struct CompactionServiceResult {
+  std::vector<CompactionServiceOutputFile> output_files;
+  uint64_t num_input_records = 0;
+  uint64_t num_output_records = 0;
+};
+
+// CompactionService lets a DB hand the compactions it picks over to another
+// process or host (see DBOptions::compaction_service), so that they do not
+// take CPU and memory away from the DB's reads and writes. The executor
+// runs the compaction with DB::OpenAndCompact(), which only reads the input
+// files, and the DB then moves the output files into its directory and
+// installs them as if it had written them itself.
+class CompactionService {
+ public:
+  virtual ~CompactionService() {}
+
+  virtual const char* Name() const = 0;
+
+  // Runs the compaction described by input, and fills in result once the
+  // output files are in input.output_directory. Called from the thread that
+  // runs the compaction, which waits for it to return.
+  //
+  // Return Status::NotSupported() for the DB to run this compaction itself.
+  // If any other error is returned, the DB also runs the compaction itself.
+  virtual Status Compact(const CompactionServiceInput& input,
+                         CompactionServiceResult* result) = 0;
+};
+
+// Returns a CompactionService that runs the compactions on its own pool of
+// num_threads threads in this process, with DB::OpenAndCompact() and the
+// given options. It stands in for a remote executor in tests and db_bench.
+// options must be the options of the DB, and are used for all its column
+// families. If bottommost_only, only compactions into the bottommost level
+// are run by the service, and the others by the DB.
+extern std::shared_ptr<CompactionService> NewThreadPoolCompactionService(
+    const Options& options, int num_threads, bool bottommost_only = false);
+
+}  // namespace rocksdb
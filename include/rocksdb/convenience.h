@@ -219,6 +219,11 @@ Status GetDBOptionsFromMap(
 //     - Pass {"filter_policy", "bloomfilter:4:true"} in
 //       GetBlockBasedTableOptionsFromMap to use a BloomFilter with 4-bits
 //       per key and use_block_based_builder enabled.
+//   - RibbonFilter: use
+//     "ribbonfilter:[bloom_equivalent_bits_per_key]:[ribbon_start_level]",
+//     which is equivalent to calling NewRibbonFilterPolicy(
+//     bloom_equivalent_bits_per_key, ribbon_start_level). The start level
+//     is optional and defaults to 0.
 //
 // * block_cache / block_cache_compressed:
 //   We currently only support LRU cache in the GetOptions API.  The LRU
@@ -47,6 +47,8 @@ struct ReadOptions;
 struct WriteOptions;
 struct FlushOptions;
 struct CompactionOptions;
+struct CompactionServiceInput;
+struct CompactionServiceResult;
 struct CompactRangeOptions;
 struct TableProperties;
 struct ExternalSstFileInfo;
@@ -153,6 +155,18 @@ class DB {
       std::vector<ColumnFamilyHandle*>* handles, DB** dbptr,
       bool error_if_log_file_exist = false);
 
+  // Run a compaction that the DB at input.db_name handed over to its
+  // CompactionService, usually in another process. The DB is opened for
+  // read only with options, which must be the options of the DB and of the
+  // column family to compact, and the output files are written to
+  // input.output_directory instead of being installed.
+  //
+  // Not supported in ROCKSDB_LITE, in which case the function will
+  // return Status::NotSupported.
+  static Status OpenAndCompact(const Options& options,
+                               const CompactionServiceInput& input,
+                               CompactionServiceResult* result);
+
   // Open DB with column families.
   // db_options specify database specific options
   // column_families is the vector of all column families in the database,
@@ -369,6 +383,21 @@ class DB {
                     keys, values);
   }
 
+  // Batched MultiGet of num_keys keys from a single column family. The
+  // result for keys[i] is stored in values[i] and statuses[i], both of
+  // which must point to arrays of num_keys elements. Unlike the overloads
+  // above, implementations may look up the keys as a batch: DBImpl probes
+  // each memtable once for the whole batch, groups the remaining keys by SST
+  // file and data block, and issues the block reads that miss in the block
+  // cache together. If sorted_input is true, the keys must already be sorted
+  // by the column family's comparator, which saves sorting them again.
+  // The default implementation calls Get() for each key.
+  virtual void MultiGet(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family,
+                        const size_t num_keys, const Slice* keys,
+                        PinnableSlice* values, Status* statuses,
+                        const bool sorted_input = false);
+
   // If the key definitely does not exist in the database, then this method
   // returns false, else true. If the caller wants to obtain value when the key
   // is found in memory, a bool for 'value_found' must be passed. 'value_found'
@@ -71,6 +71,11 @@ struct EnvOptions {
    // If true, then use mmap to write data
   bool use_mmap_writes = true;
 
+  // If true along with use_mmap_writes, map the file with MAP_SYNC where
+  // the file system supports it, and sync by flushing the CPU cache lines
+  // of the written data
+  bool use_pmem_writes = false;
+
   // If true, then use O_DIRECT for reading data
   bool use_direct_reads = false;
 
@@ -542,6 +547,26 @@ class SequentialFile {
   }
 };
 
+// A read request for RandomAccessFile::MultiRead().
+struct ReadRequest {
+  // File offset in bytes
+  uint64_t offset;
+
+  // Length to read in bytes
+  size_t len;
+
+  // A buffer that MultiRead() can optionally place data in. It can
+  // ignore this and allocate its own buffer
+  char* scratch;
+
+  // Output parameter set by MultiRead() to point to the data buffer, and
+  // the number of valid bytes
+  Slice result;
+
+  // Status of read
+  Status status;
+};
+
 // A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -567,6 +592,42 @@ class RandomAccessFile {
     return Status::OK();
   }
 
+  // Read a bunch of blocks as described by reqs. The blocks can
+  // optionally be read in parallel. This is a synchronous call, i.e it
+  // should return after all reads have completed. The reads will be
+  // non-overlapping. If the function return Status is not ok, status of
+  // individual requests will be ignored and return status will be assumed
+  // for all read requests. The function return status is only meant for
+  // errors that occur before even processing specific read requests
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+
+  // Start the reads described by reqs without waiting for them to complete,
+  // so that a single thread can keep several reads in flight. On success
+  // *io_handle identifies the batch and must be passed to PollReads() on the
+  // same thread until it returns OK; only then are the status and result of
+  // each request set. reqs and their scratch buffers must stay valid until
+  // then. Implementations without asynchronous I/O perform the reads before
+  // returning and set *io_handle to nullptr, which PollReads() accepts.
+  virtual Status SubmitReads(ReadRequest* reqs, size_t num_reqs,
+                             void** io_handle) {
+    *io_handle = nullptr;
+    return MultiRead(reqs, num_reqs);
+  }
+
+  // Check on a batch started by SubmitReads(). If wait is true, block until
+  // every read of the batch has completed and return OK. Otherwise return
+  // Status::Incomplete() right away if some of them are still in flight.
+  // Once OK is returned the handle is released and must not be used again.
+  virtual Status PollReads(void* /*io_handle*/, bool /*wait*/) {
+    return Status::OK();
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -30,6 +30,13 @@ namespace rocksdb {
 
 class Slice;
 
+// Contextual information passed to FilterPolicy::GetBuilderWithContext
+struct FilterBuildingContext {
+  // The level of the LSM tree the table is built for, or -1 if it is not
+  // known, e.g. for files written with SstFileWriter.
+  int level_at_creation = -1;
+};
+
 // A class that takes a bunch of keys, then generates filter
 class FilterBitsBuilder {
  public:
@@ -71,6 +78,16 @@ class FilterBitsReader {
 
   // Check if the entry match the bits in filter
   virtual bool MayMatch(const Slice& entry) = 0;
+
+  // Check if an array of entries match the bits in filter, setting
+  // may_match[i] for keys[i]. Implementations can overlap the memory
+  // accesses of the entries.
+  virtual void BatchMayMatch(int num_keys, const Slice* const* keys,
+                             bool* may_match) {
+    for (int i = 0; i < num_keys; ++i) {
+      may_match[i] = MayMatch(*keys[i]);
+    }
+  }
 };
 
 // We add a new format of filter block called full filter block
@@ -119,6 +136,14 @@ class FilterPolicy {
     return nullptr;
   }
 
+  // Get the FilterBitsBuilder for a table described by context, which lets a
+  // policy build different filters, for example, for different levels.
+  // The default ignores the context.
+  virtual FilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext& /*context*/) const {
+    return GetFilterBitsBuilder();
+  }
+
   // Get the FilterBitsReader, which is ONLY used for full filter block
   // It contains interface to tell if key can be in filter
   // The input slice should NOT be deleted by FilterPolicy
@@ -135,6 +160,17 @@ class FilterPolicy {
 // is 10, which yields a filter with ~ 1% false positive rate.
 // use_block_based_builder: use block based filter rather than full filter.
 // If you want to builder full filter, it needs to be set to false.
+// full_filter_format_version: format of the full filters that are built. The
+// format is recorded in each filter, and filters of every format can be read
+// regardless of this setting.
+//   0 -- Probes are spread over a CPU cache line with double hashing. Can be
+//        read by all RocksDB versions.
+//   1 -- Split block Bloom filter: each key sets 8 bits in a single 32-byte
+//        block, which is checked with one SIMD compare when built with AVX2.
+//        Versions of RocksDB that cannot read it treat every key as a
+//        match.
+//   2 -- Ribbon filter, see NewRibbonFilterPolicy(). Built for tables of
+//        every level.
 //
 // Callers must delete the result after any database that is using the
 // result has been closed.
@@ -147,7 +183,30 @@ class FilterPolicy {
 // FilterPolicy (like NewBloomFilterPolicy) that does not ignore
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-    bool use_block_based_builder = true);
+    bool use_block_based_builder = true, int full_filter_format_version = 0);
+
+// Return a new filter policy that builds Ribbon filters (full filter format
+// version 2), a static filter that needs about 1.1 * log2(1/fp_rate) bits per
+// key where a Bloom filter needs 1.44 * log2(1/fp_rate) or more. It is thus
+// about 20-25% smaller than a Bloom filter of the same false positive rate,
+// but is several times slower to build and somewhat slower to query.
+//
+// bloom_equivalent_bits_per_key: the Ribbon filters get at most the false
+// positive rate of a Bloom filter with this many bits per key. With 10, they
+// take about 7.8 bits per key for a ~0.8% false positive rate.
+// ribbon_start_level: tables built for a lower level, which are short lived
+// and hold a small part of the data, get full Bloom filters of
+// bloom_equivalent_bits_per_key instead. Tables of an unknown level, such as
+// files ingested after writing them with SstFileWriter, get Ribbon filters.
+// 0 builds Ribbon filters for all the tables.
+//
+// Filters built by this policy and by NewBloomFilterPolicy() can be read by
+// either, so a database can switch between them. Versions of RocksDB that
+// cannot read Ribbon filters treat every key as a match.
+//
+// The ownership and comparator notes on NewBloomFilterPolicy() apply here.
+extern const FilterPolicy* NewRibbonFilterPolicy(
+    int bloom_equivalent_bits_per_key, int ribbon_start_level = 0);
 }
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_FILTER_POLICY_H_
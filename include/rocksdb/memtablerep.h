@@ -28,6 +28,11 @@
 // vector is sorted. It is intelligent about sorting; once the MarkReadOnly()
 // has been called, the vector will only be sorted once. It is optimized for
 // random-write-heavy workloads.
+//  - BPlusTreeRep: This is backed by a B+-tree whose nodes are sized and
+// aligned to cache lines. Like SkipListRep, it supports ordered iteration
+// and concurrent inserts.
+//  - ShardedRep: This partitions the memtable into shards by the hash of
+// the user key, each backed by another representation.
 //
 // The last four implementations are designed for situations in which
 // iteration over the entire collection is rare since doing so requires all the
@@ -45,6 +50,7 @@ namespace rocksdb {
 
 class Arena;
 class Allocator;
+class Comparator;
 class LookupKey;
 class SliceTransform;
 class Logger;
@@ -75,6 +81,12 @@ class MemTableRep {
     virtual int operator()(const char* prefix_len_key,
                            const Slice& key) const = 0;
 
+    // Returns the comparator of the user keys if the keys are internal keys
+    // ordered by user key first, as in a MemTable, or nullptr otherwise.
+    // Lets a MemTableRep order keys by their user key bytes when it is
+    // BytewiseComparator().
+    virtual const Comparator* user_comparator() const { return nullptr; }
+
     virtual ~KeyComparator() { }
   };
 
@@ -135,6 +147,21 @@ class MemTableRep {
     return true;
   }
 
+  // Like InsertWithHint(handle, hint), but may be called concurrent with
+  // other inserts, as long as no two concurrent calls share the same hint.
+  virtual void InsertWithHintConcurrently(KeyHandle handle, void** /*hint*/) {
+    // Ignore the hint by default.
+    InsertConcurrently(handle);
+  }
+
+  // Same as ::InsertWithHintConcurrently
+  // Returns false if MemTableRepFactory::CanHandleDuplicatedKey() is true and
+  // the <key, seq> already exists.
+  virtual bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) {
+    InsertWithHintConcurrently(handle, hint);
+    return true;
+  }
+
   // Returns true iff an entry that compares equal to key is in the collection.
   virtual bool Contains(const char* key) const = 0;
 
@@ -321,6 +348,25 @@ class VectorRepFactory : public MemTableRepFactory {
   }
 };
 
+// This creates MemTableReps that are backed by a B+-tree. Its nodes are a
+// few cache lines long, so a search visits fewer nodes than in a skip list,
+// and with BytewiseComparator() they keep the first 8 bytes of the user key
+// of each entry, so that most key comparisons do not need to load the
+// entry. It supports concurrent inserts, ordered iteration and Seek(), like
+// SkipListFactory, and uses more memory per entry.
+class BPlusTreeFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                         Allocator*, const SliceTransform*,
+                                         Logger* logger) override;
+  virtual const char* Name() const override { return "BPlusTreeFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
@@ -388,5 +434,18 @@ extern MemTableRepFactory* NewHashLinkListRepFactory(
 extern MemTableRepFactory* NewHashCuckooRepFactory(
     size_t write_buffer_size, size_t average_data_size = 64,
     unsigned int hash_function_count = 4);
+
+// This factory partitions each memtable into shard_count shards by the hash
+// of the user key. Each shard is a MemTableRep created by base_factory, so
+// concurrent writers of different keys mostly insert into different shards
+// instead of contending on the same data structure. Point lookups only
+// search the shard of their key, while iterators merge the iterators of all
+// the shards.
+//
+// Keys are allocated by one of the shards and inserted into another, which
+// the skip list, vector and B+-tree representations support.
+extern MemTableRepFactory* NewShardedRepFactory(
+    const std::shared_ptr<MemTableRepFactory>& base_factory,
+    size_t shard_count = 16);
 #endif  // ROCKSDB_LITE
 }  // namespace rocksdb
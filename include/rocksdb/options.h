@@ -33,6 +33,7 @@ namespace rocksdb {
 
 class Cache;
 class CompactionFilter;
+class CompactionService;
 class CompactionFilterFactory;
 class Comparator;
 class Env;
@@ -614,6 +615,16 @@ struct DBOptions {
   // Default: false
   bool allow_mmap_writes = false;
 
+  // Write the WAL through a memory mapping of a preallocated file instead of
+  // write() calls. Where the file system supports mapping with MAP_SYNC
+  // (a DAX mount of persistent memory), syncing the WAL then only writes
+  // the CPU cache lines of the new records back to memory, without any
+  // system calls. Elsewhere the WAL is synced with msync() and fdatasync().
+  // Combine with recycle_log_file_num to reuse the preallocated files.
+  // DB::SyncWAL() and two_write_queues are not supported with this option.
+  // Default: false
+  bool use_pmem_for_wal = false;
+
   // Enable direct I/O mode for read/write
   // they may or may not improve performance depending on the use case
   //
@@ -712,6 +723,14 @@ struct DBOptions {
   // Default: 0
   size_t compaction_readahead_size = 0;
 
+  // If true, compaction input iterators read ahead asynchronously: the next
+  // window is read in the background while the current one is merged, see
+  // ReadOptions::async_readahead. The window is compaction_readahead_size
+  // if non-zero, otherwise it grows automatically.
+  //
+  // Default: false
+  bool compaction_async_readahead = false;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -812,6 +831,25 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // If true, the write group leader only writes the WAL and assigns the
+  // sequence numbers, and each writer then inserts its own batch into the
+  // memtable, concurrently with the writers of the following write groups.
+  // A slow memtable insert thus no longer holds back the whole group.
+  //
+  // The sequence numbers of a group are published once it is written to the
+  // WAL, before the memtable inserts complete. Reads, including reads from a
+  // snapshot, may therefore miss a write or see only part of a write batch
+  // until its Write() call returns. Use it for workloads that do not rely on
+  // snapshot consistency, or with WritePrepared transactions, which order
+  // their commits separately. Batches with merge operands are still inserted
+  // in order, by the write group leader.
+  //
+  // Requires allow_concurrent_memtable_write, and is not compatible with
+  // enable_pipelined_write.
+  //
+  // Default: false
+  bool unordered_write = false;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
   // is implemented only for SkipListFactory.  Concurrent memtable writes
@@ -944,6 +982,38 @@ struct DBOptions {
   // relies on manual invocation of FlushWAL to write the WAL buffer to its
   // file.
   bool manual_wal_flush = false;
+
+  // If true, a flush of any column family switches the memtables of all the
+  // column families that have data, and their results are installed together
+  // with a single atomic group of edits in the MANIFEST. After a crash, the
+  // column families are therefore recovered to the same point, even if the
+  // WAL is disabled or not replayed. A MANIFEST written with this option
+  // cannot be opened by older versions of RocksDB.
+  //
+  // Not supported with allow_2pc.
+  //
+  // Default: false
+  bool atomic_flush = false;
+
+  // If true, each writer computes the crc32c of its WriteBatch before it
+  // joins a write group, and the group leader combines these into the
+  // checksum of the WAL record instead of checksumming the whole group
+  // itself. This shortens the serial part of a group commit with many or
+  // large batches, and the WAL checksum then also covers any corruption of
+  // a batch between the write call and the WAL write. Batches under 1KB,
+  // which are cheaper to checksum than to combine, and records larger than
+  // a WAL block are still checksummed by the leader.
+  //
+  // Default: false
+  bool precompute_wal_checksums = false;
+
+  // If not nullptr, the compactions picked by the DB are handed over to this
+  // service, which may run them in another process or on another host (see
+  // rocksdb/compaction_service.h), and their output files are then installed
+  // by the DB. Compactions that the service declines or fails are run by the
+  // DB as usual. Not supported in ROCKSDB_LITE.
+  // Default: nullptr
+  std::shared_ptr<CompactionService> compaction_service = nullptr;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1034,6 +1104,16 @@ struct ReadOptions {
   // Default: 0
   size_t readahead_size;
 
+  // If true, iterators read ahead in the background: the next readahead
+  // window is read asynchronously into a second buffer while the current one
+  // is consumed, so that a long scan does not stall at every window
+  // boundary. The window is readahead_size if non-zero; otherwise it starts
+  // small and grows like the automatic readahead of iterators. Only applies
+  // to block based tables read without mmap, and only overlaps the reads
+  // when the Env implements RandomAccessFile::SubmitReads() asynchronously.
+  // Default: false
+  bool async_readahead;
+
   // A threshold for the number of keys that can be skipped before failing an
   // iterator seek as incomplete. The default value of 0 should be used to
   // never fail a request as incomplete, even on skipping too many keys.
@@ -1170,12 +1250,26 @@ struct WriteOptions {
   // Default: false
   bool low_pri;
 
+  // If true, and allow_concurrent_memtable_write is true, the write batch
+  // keeps the position of its last insert into each memtable as a hint for
+  // the next insert, so that a run of keys that are sorted within the batch
+  // is inserted without searching the memtable from the top for every key.
+  // This can make writes of batches with sorted keys faster, and has a small
+  // cost for batches with keys in random order.
+  //
+  // Inserts that are not concurrent always start from the last insert
+  // position, so this option does not affect them.
+  //
+  // Default: false
+  bool memtable_insert_hint_per_batch;
+
   WriteOptions()
       : sync(false),
         disableWAL(false),
         ignore_missing_column_families(false),
         no_slowdown(false),
-        low_pri(false) {}
+        low_pri(false),
+        memtable_insert_hint_per_batch(false) {}
 };
 
 // Options that control flush operations
@@ -0,0 +1,85 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// SecondaryCache is a second tier behind an LRU cache (see
+// LRUCacheOptions::secondary_cache). Entries that were inserted into the LRU
+// cache with Cache::InsertWithHelper() are demoted to the secondary cache
+// when they are evicted, instead of being dropped, and a
+// Cache::LookupWithHelper() that misses in the LRU cache promotes them back.
+// A secondary cache holds entries in their serialized form, so it can keep
+// them in a more compact representation than the primary tier.
+//
+// The two tiers are exclusive: an entry is moved, not copied, between them.
+// Each tier has its own capacity and usage.
+class SecondaryCache {
+ public:
+  virtual ~SecondaryCache() {}
+
+  virtual const char* Name() const = 0;
+
+  // Store the serialized form of value, obtained through helper, under key.
+  // Called when an entry is evicted from the primary tier, so it must not
+  // keep a reference to value.
+  virtual Status Insert(const Slice& key, void* value,
+                        const Cache::CacheItemHelper* helper) = 0;
+
+  // If the secondary cache has an entry for key, rebuild the object with
+  // create_cb, remove the entry from the secondary cache and return OK.
+  // Return Status::NotFound() otherwise.
+  virtual Status Lookup(const Slice& key, const Cache::CreateCallback& create_cb,
+                        void** value, size_t* charge) = 0;
+
+  // If the secondary cache contains an entry for key, erase it.
+  virtual void Erase(const Slice& key) = 0;
+
+  // The maximum configured capacity, and the memory used by the entries
+  // residing in the secondary cache.
+  virtual size_t GetCapacity() const = 0;
+  virtual size_t GetUsage() const = 0;
+
+  virtual std::string GetPrintableOptions() const { return ""; }
+};
+
+struct CompressedSecondaryCacheOptions {
+  // Capacity of the compressed tier, charged with the compressed size of
+  // its entries.
+  size_t capacity = 0;
+
+  // Number of shard bits of the underlying LRU cache. -1 means it is
+  // determined from the capacity, as for NewLRUCache().
+  int num_shard_bits = -1;
+
+  // Compression used for demoted entries. An entry is kept uncompressed if
+  // the compression is not supported by the build or does not save at least
+  // 12.5% of its size.
+  CompressionType compression_type = kLZ4Compression;
+
+  CompressedSecondaryCacheOptions() {}
+  CompressedSecondaryCacheOptions(size_t _capacity, int _num_shard_bits,
+                                  CompressionType _compression_type)
+      : capacity(_capacity),
+        num_shard_bits(_num_shard_bits),
+        compression_type(_compression_type) {}
+};
+
+// Create an in-memory secondary cache that stores demoted entries
+// compressed. Returns nullptr if the options are invalid.
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+}  // namespace rocksdb
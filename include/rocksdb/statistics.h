@@ -323,6 +323,11 @@ enum Tickers : uint32_t {
   // Number of keys actually found in MultiGet calls (vs number requested by caller)
   // NUMBER_MULTIGET_KEYS_READ gives the number requested by caller
   NUMBER_MULTIGET_KEYS_FOUND,
+
+  // # of block cache misses served from, or also missed in, the secondary
+  // cache tier (LRUCacheOptions::secondary_cache).
+  SECONDARY_CACHE_HITS,
+  SECONDARY_CACHE_MISSES,
   TICKER_ENUM_MAX
 };
 
@@ -475,6 +480,8 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {TXN_DUPLICATE_KEY_OVERHEAD, "rocksdb.txn.overhead.duplicate.key"},
     {TXN_SNAPSHOT_MUTEX_OVERHEAD, "rocksdb.txn.overhead.mutex.snapshot"},
     {NUMBER_MULTIGET_KEYS_FOUND, "rocksdb.number.multiget.keys.found"},
+    {SECONDARY_CACHE_HITS, "rocksdb.secondary.cache.hits"},
+    {SECONDARY_CACHE_MISSES, "rocksdb.secondary.cache.misses"},
 };
 
 /**
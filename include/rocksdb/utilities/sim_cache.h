@@ -36,6 +36,14 @@ extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
                                              size_t sim_capacity,
                                              int num_shard_bits);
 
+// Same as above, but simulates `sim_cache` instead of a plain LRU cache of
+// the given capacity. This allows evaluating other cache configurations, such
+// as an LRU cache with LRUCacheOptions::tiny_lfu_admission, against the
+// workload served by `cache`. `sim_cache` should not be shared with anything
+// else, since SimCache inserts entries without values into it.
+extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                             std::shared_ptr<Cache> cache);
+
 class SimCache : public Cache {
  public:
   SimCache() {}
@@ -12,24 +12,48 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include "rocksdb/cache.h"
 
 namespace rocksdb {
 
+// How a DB picks the column family to flush when its WriteBufferManager
+// asks for a flush.
+enum class WriteBufferFlushPolicy : char {
+  // Flush the column family whose mutable memtable is the oldest.
+  kOldestMemtable = 0x0,
+  // Score each column family by the share of memory its mutable memtable
+  // would free, by how old the oldest entry of the memtable is, and by
+  // whether the memtable keeps the oldest WAL alive, and flush the one with
+  // the highest score.
+  kCostAware = 0x1,
+};
+
 class WriteBufferManager {
  public:
   // _buffer_size = 0 indicates no limit. Memory won't be capped.
   // memory_usage() won't be valid and ShouldFlush() will always return true.
   // if `cache` is provided, we'll put dummy entries in the cache and cost
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
-  explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {});
+  // If `allow_stall` is true, the writes of the DBs sharing this manager are
+  // slowed down more and more as memory_usage() goes past _buffer_size, see
+  // StallLevel().
+  // `flush_policy` is how the DBs pick the column family to flush.
+  explicit WriteBufferManager(
+      size_t _buffer_size, std::shared_ptr<Cache> cache = {},
+      bool allow_stall = false,
+      WriteBufferFlushPolicy flush_policy =
+          WriteBufferFlushPolicy::kOldestMemtable);
   ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
+  bool allow_stall() const { return allow_stall_; }
+
+  WriteBufferFlushPolicy flush_policy() const { return flush_policy_; }
+
   // Only valid if enabled()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
@@ -56,6 +80,28 @@ class WriteBufferManager {
     return false;
   }
 
+  static const int kMaxStallLevel = 8;
+
+  // Returns how much the writes should be slowed down because memory_usage()
+  // is over buffer_size(): 0 if they should not, then from 1 right past
+  // buffer_size() up to kMaxStallLevel at 1.5 times buffer_size(). Each level
+  // halves the rate the DBs let writes through at, so that writers slow down
+  // gradually while the flushes catch up instead of all stopping at once.
+  // Always 0 unless allow_stall().
+  int StallLevel() const {
+    if (!allow_stall_ || !enabled()) {
+      return 0;
+    }
+    const size_t usage = memory_usage();
+    if (usage < buffer_size_) {
+      return 0;
+    }
+    const size_t step =
+        std::max(buffer_size_ / 2 / kMaxStallLevel, static_cast<size_t>(1));
+    return static_cast<int>(std::min(1 + (usage - buffer_size_) / step,
+                                     static_cast<size_t>(kMaxStallLevel)));
+  }
+
   void ReserveMem(size_t mem) {
     if (cache_rep_ != nullptr) {
       ReserveMemWithCache(mem);
@@ -84,6 +130,8 @@ class WriteBufferManager {
  private:
   const size_t buffer_size_;
   const size_t mutable_limit_;
+  const bool allow_stall_;
+  const WriteBufferFlushPolicy flush_policy_;
   std::atomic<size_t> memory_used_;
   // Memory that hasn't been scheduled to free.
   std::atomic<size_t> memory_active_;
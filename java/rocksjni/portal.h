@@ -3345,8 +3345,12 @@ class TickerTypeJni {
         return 0x5D;
       case rocksdb::Tickers::NUMBER_MULTIGET_KEYS_FOUND:
         return 0x5E;
-      case rocksdb::Tickers::TICKER_ENUM_MAX:
+      case rocksdb::Tickers::SECONDARY_CACHE_HITS:
         return 0x5F;
+      case rocksdb::Tickers::SECONDARY_CACHE_MISSES:
+        return 0x60;
+      case rocksdb::Tickers::TICKER_ENUM_MAX:
+        return 0x61;
 
       default:
         // undefined/default
@@ -3549,6 +3553,10 @@ class TickerTypeJni {
       case 0x5E:
         return rocksdb::Tickers::NUMBER_MULTIGET_KEYS_FOUND;
       case 0x5F:
+        return rocksdb::Tickers::SECONDARY_CACHE_HITS;
+      case 0x60:
+        return rocksdb::Tickers::SECONDARY_CACHE_MISSES;
+      case 0x61:
         return rocksdb::Tickers::TICKER_ENUM_MAX;
 
       default:
@@ -475,7 +475,17 @@ public enum TickerType {
      */
     NUMBER_MULTIGET_KEYS_FOUND((byte) 0x5E),
 
-    TICKER_ENUM_MAX((byte) 0x5F);
+    /**
+     * Number of block cache misses found in the secondary cache tier.
+     */
+    SECONDARY_CACHE_HITS((byte) 0x5F),
+
+    /**
+     * Number of block cache misses also missed in the secondary cache tier.
+     */
+    SECONDARY_CACHE_MISSES((byte) 0x60),
+
+    TICKER_ENUM_MAX((byte) 0x61);
 
 
     private final byte value;
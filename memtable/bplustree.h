@@ -0,0 +1,968 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// BPlusTree is an ordered set of keys that, like InlineSkipList, are
+// allocated by the caller and referenced by pointer, but it keeps the key
+// pointers in the nodes of a B+-tree. The nodes are allocated from the
+// allocator, aligned to cache lines and a few cache lines long, so that a
+// search visits a handful of nodes instead of one node per skip list level.
+// Next to each key pointer a node can keep a 64-bit prefix of the key that
+// orders like the key, so that a search within a node only dereferences the
+// keys that share the target's prefix.
+//
+// Thread safety -------------
+//
+// Insert can be called concurrently with reads and with other inserts.
+// Each node has a version that writers increment when they lock and when
+// they unlock the node (optimistic lock coupling). Readers take no locks:
+// they read a node, then check that its version did not change, and start
+// over from the root if it did. Writers only lock the nodes they modify,
+// and restart in the same way if a node changed since they read it. Reads
+// require a guarantee that the BPlusTree will not be destroyed while the
+// read is in progress.
+//
+// Invariants:
+//
+// (1) Nodes are never freed or merged until the BPlusTree is destroyed,
+// and keys are never removed, so a reader that reads a node while a writer
+// changes it only reads pointers to keys and nodes of the tree.
+//
+// (2) The key range of a node only changes when the node is split, which
+// changes the version of the node and of its parent.
+//
+// (3) Key and child pointers are stored with release stores after the key
+// or node they point to is initialized, and the number of keys of a node is
+// stored with a release store after its key and child pointers, so readers
+// that load them with acquire loads never see uninitialized data.
+
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "port/likely.h"
+#include "port/port.h"
+#include "util/allocator.h"
+
+namespace rocksdb {
+
+template <class Comparator>
+class BPlusTree {
+ private:
+  struct Node;
+  struct Leaf;
+  struct Inner;
+
+ public:
+  using DecodedKey =
+      typename std::remove_reference<Comparator>::type::DecodedType;
+
+  // Maps a key to a number that orders like the key: if key_prefix(a) <
+  // key_prefix(b), then a must order before b.
+  typedef uint64_t (*KeyPrefixFunc)(const DecodedKey& key);
+
+  // Create a new BPlusTree object that will use "cmp" for comparing keys,
+  // and will allocate memory using "*allocator".  Objects allocated in the
+  // allocator must remain allocated for the lifetime of the tree. If
+  // key_prefix is not null, the nodes keep the prefixes of their keys, and
+  // only call "cmp" for the keys whose prefix is equal to the target's.
+  explicit BPlusTree(Comparator cmp, Allocator* allocator,
+                     KeyPrefixFunc key_prefix = nullptr);
+
+  // Inserts key, which the caller allocated and must keep allocated for the
+  // lifetime of the tree. Returns false, without inserting the key, if a key
+  // that compares equal to it is already in the tree.
+  // Can be called concurrently with reads and with other inserts.
+  bool Insert(const char* key);
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const char* key) const;
+
+  // Validate the structure of the tree.
+  // REQUIRES: no concurrent inserts.
+  void TEST_Validate() const;
+
+ private:
+  // A key of the tree that an iterator is positioned at, and the leaf that
+  // holds it, in the version of the leaf the key was read in.
+  struct Position {
+    const Leaf* leaf;
+    uint32_t index;
+    uint64_t version;
+    // nullptr if the iterator is not valid
+    const char* key;
+  };
+
+ public:
+  // Iteration over the contents of a tree
+  class Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const BPlusTree* tree);
+
+    // Change the underlying tree used for this iterator
+    void SetTree(const BPlusTree* tree);
+
+    // Returns true iff the iterator is positioned at a valid entry.
+    bool Valid() const;
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const;
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next();
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev();
+
+    // Advance to the first entry with a key >= target
+    void Seek(const char* target);
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const char* target);
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst();
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast();
+
+   private:
+    const BPlusTree* tree_;
+    Position pos_;
+    // Intentionally copyable
+  };
+
+ private:
+  // Leaves take 8 and inner nodes 12 cache lines of 64 bytes.
+  static const uint32_t kLeafSlots = 30;
+  static const uint32_t kInnerSlots = 31;
+
+  struct Node {
+    // Odd while a writer holds the lock of the node. Writers add one to it
+    // when they lock and when they unlock the node, so a reader knows that
+    // the node changed while it read it if the version changed.
+    std::atomic<uint64_t> version;
+    // Number of keys, or of separator keys for inner nodes
+    std::atomic<uint32_t> count;
+    // 0 for leaves, and one more than the level of its children for inner
+    // nodes. Immutable.
+    uint32_t level;
+  };
+
+  struct Leaf : public Node {
+    // The next leaf in key order, or nullptr for the last leaf
+    std::atomic<Leaf*> next;
+    char padding[8];
+    std::atomic<uint64_t> prefixes[kLeafSlots];
+    std::atomic<const char*> keys[kLeafSlots];
+  };
+
+  struct Inner : public Node {
+    std::atomic<uint64_t> prefixes[kInnerSlots];
+    std::atomic<const char*> keys[kInnerSlots];
+    // children[i] holds the keys >= keys[i - 1] and < keys[i].
+    std::atomic<Node*> children[kInnerSlots + 1];
+  };
+
+  static_assert(sizeof(Leaf) % CACHE_LINE_SIZE == 0,
+                "leaves should fill whole cache lines");
+  static_assert(sizeof(Inner) % CACHE_LINE_SIZE == 0,
+                "inner nodes should fill whole cache lines");
+
+  // A key to search for, decoded once for all the comparisons.
+  struct Target {
+    DecodedKey key;
+    uint64_t prefix;
+  };
+
+  enum InsertResult { kInserted, kDuplicate, kRestart };
+
+  Allocator* const allocator_;
+  // Immutable after construction
+  Comparator const compare_;
+  const KeyPrefixFunc key_prefix_;
+  std::atomic<Node*> root_;
+
+  Target MakeTarget(const char* key) const;
+  char* AllocateNode(size_t size);
+  Leaf* NewLeaf();
+  Inner* NewInner(uint32_t level);
+
+  // Compares the i-th key of a node with t.
+  int CompareSlot(const std::atomic<uint64_t>* prefixes,
+                  const std::atomic<const char*>* keys, uint32_t i,
+                  const Target& t) const;
+
+  // Returns the number of the first n keys of a node that are less than t,
+  // or less than or equal to t if or_equal. Sets *found if found is not null
+  // and one of the keys compared is equal to t.
+  uint32_t Rank(const std::atomic<uint64_t>* prefixes,
+                const std::atomic<const char*>* keys, uint32_t n,
+                const Target& t, bool or_equal, bool* found) const;
+
+  // Waits until no writer holds the lock of node, and sets *version to the
+  // version of the node.
+  static void ReadLock(const Node* node, uint64_t* version);
+  // Returns true iff node did not change since its version was version.
+  static bool Validate(const Node* node, uint64_t version);
+  // Locks node if it did not change since its version was version. Returns
+  // false if it changed.
+  static bool UpgradeLock(Node* node, uint64_t version);
+  static void Unlock(Node* node);
+
+  InsertResult TryInsert(const char* key, const Target& t);
+
+  // Splits node in two, and inserts the new node into parent, or into a
+  // new root if parent is null, if neither of them changed since their
+  // versions were version and parent_version. If append, the node is
+  // split before its last key, for keys that are inserted in order.
+  void Split(Node* node, uint64_t version, Inner* parent,
+             uint64_t parent_version, bool append);
+  // Inserts separator key and the node right, which holds the keys from it,
+  // into locked parent, which has room for it.
+  void InsertChild(Inner* parent, uint64_t prefix, const char* key,
+                   Node* right);
+
+  // Positions pos at the first key > *t if after_equal, or >= *t otherwise,
+  // or at the first key of the tree if t is null.
+  void SeekFirst(const Target* t, bool after_equal, Position* pos) const;
+  // Positions pos at the last key <= *t if or_equal, or < *t otherwise, or
+  // at the last key of the tree if t is null.
+  void SeekLast(const Target* t, bool or_equal, Position* pos) const;
+  void Next(Position* pos) const;
+  void Prev(Position* pos) const;
+
+  // The Try functions return false, without changing *pos, if a node they
+  // read changed in the meantime.
+  bool TrySeekFirst(const Target* t, bool after_equal, Position* pos) const;
+  bool TrySeekLast(const Target* t, bool or_equal, Position* pos) const;
+  // Positions pos at the first key of leaf or of the leaves that follow it.
+  bool TryFirstOfLeaf(const Leaf* leaf, Position* pos) const;
+
+  void ValidateNode(const Node* node, const char* lower, const char* upper,
+                    std::vector<const Leaf*>* leaves) const;
+
+  // No copying allowed
+  BPlusTree(const BPlusTree&);
+  BPlusTree& operator=(const BPlusTree&);
+};
+
+// Implementation details follow
+
+template <class Comparator>
+const uint32_t BPlusTree<Comparator>::kLeafSlots;
+
+template <class Comparator>
+const uint32_t BPlusTree<Comparator>::kInnerSlots;
+
+template <class Comparator>
+inline BPlusTree<Comparator>::Iterator::Iterator(const BPlusTree* tree) {
+  SetTree(tree);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::SetTree(const BPlusTree* tree) {
+  tree_ = tree;
+  pos_.leaf = nullptr;
+  pos_.index = 0;
+  pos_.version = 0;
+  pos_.key = nullptr;
+}
+
+template <class Comparator>
+inline bool BPlusTree<Comparator>::Iterator::Valid() const {
+  return pos_.key != nullptr;
+}
+
+template <class Comparator>
+inline const char* BPlusTree<Comparator>::Iterator::key() const {
+  assert(Valid());
+  return pos_.key;
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::Next() {
+  assert(Valid());
+  tree_->Next(&pos_);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::Prev() {
+  assert(Valid());
+  tree_->Prev(&pos_);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::Seek(const char* target) {
+  Target t = tree_->MakeTarget(target);
+  tree_->SeekFirst(&t, false /* after_equal */, &pos_);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::SeekForPrev(const char* target) {
+  Target t = tree_->MakeTarget(target);
+  tree_->SeekLast(&t, true /* or_equal */, &pos_);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::SeekToFirst() {
+  tree_->SeekFirst(nullptr, false /* after_equal */, &pos_);
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Iterator::SeekToLast() {
+  tree_->SeekLast(nullptr, false /* or_equal */, &pos_);
+}
+
+template <class Comparator>
+BPlusTree<Comparator>::BPlusTree(Comparator cmp, Allocator* allocator,
+                                 KeyPrefixFunc key_prefix)
+    : allocator_(allocator),
+      compare_(cmp),
+      key_prefix_(key_prefix),
+      root_(NewLeaf()) {}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::Target BPlusTree<Comparator>::MakeTarget(
+    const char* key) const {
+  Target t;
+  t.key = compare_.decode_key(key);
+  t.prefix = key_prefix_ != nullptr ? key_prefix_(t.key) : 0;
+  return t;
+}
+
+template <class Comparator>
+char* BPlusTree<Comparator>::AllocateNode(size_t size) {
+  // Align nodes to cache lines, so that no cache line is shared by two nodes.
+  char* mem = allocator_->AllocateAligned(size + CACHE_LINE_SIZE - 1);
+  uintptr_t addr = reinterpret_cast<uintptr_t>(mem);
+  addr = (addr + CACHE_LINE_SIZE - 1) &
+         ~static_cast<uintptr_t>(CACHE_LINE_SIZE - 1);
+  return reinterpret_cast<char*>(addr);
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::Leaf* BPlusTree<Comparator>::NewLeaf() {
+  Leaf* leaf = new (AllocateNode(sizeof(Leaf))) Leaf;
+  leaf->version.store(0, std::memory_order_relaxed);
+  leaf->count.store(0, std::memory_order_relaxed);
+  leaf->level = 0;
+  leaf->next.store(nullptr, std::memory_order_relaxed);
+  for (uint32_t i = 0; i < kLeafSlots; i++) {
+    leaf->prefixes[i].store(0, std::memory_order_relaxed);
+    leaf->keys[i].store(nullptr, std::memory_order_relaxed);
+  }
+  return leaf;
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::Inner* BPlusTree<Comparator>::NewInner(
+    uint32_t level) {
+  Inner* inner = new (AllocateNode(sizeof(Inner))) Inner;
+  inner->version.store(0, std::memory_order_relaxed);
+  inner->count.store(0, std::memory_order_relaxed);
+  inner->level = level;
+  for (uint32_t i = 0; i < kInnerSlots; i++) {
+    inner->prefixes[i].store(0, std::memory_order_relaxed);
+    inner->keys[i].store(nullptr, std::memory_order_relaxed);
+  }
+  for (uint32_t i = 0; i <= kInnerSlots; i++) {
+    inner->children[i].store(nullptr, std::memory_order_relaxed);
+  }
+  return inner;
+}
+
+template <class Comparator>
+inline int BPlusTree<Comparator>::CompareSlot(
+    const std::atomic<uint64_t>* prefixes,
+    const std::atomic<const char*>* keys, uint32_t i, const Target& t) const {
+  if (key_prefix_ != nullptr) {
+    uint64_t prefix = prefixes[i].load(std::memory_order_relaxed);
+    if (prefix != t.prefix) {
+      return prefix < t.prefix ? -1 : 1;
+    }
+  }
+  return compare_(keys[i].load(std::memory_order_acquire), t.key);
+}
+
+template <class Comparator>
+uint32_t BPlusTree<Comparator>::Rank(const std::atomic<uint64_t>* prefixes,
+                                     const std::atomic<const char*>* keys,
+                                     uint32_t n, const Target& t,
+                                     bool or_equal, bool* found) const {
+  uint32_t lo = 0;
+  uint32_t hi = n;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int cmp = CompareSlot(prefixes, keys, mid, t);
+    if (cmp == 0 && found != nullptr) {
+      *found = true;
+    }
+    if (cmp < 0 || (cmp == 0 && or_equal)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::ReadLock(const Node* node,
+                                            uint64_t* version) {
+  uint64_t v = node->version.load(std::memory_order_acquire);
+  for (int spins = 0; (v & 1) != 0; spins++) {
+    if (spins < 64) {
+      port::AsmVolatilePause();
+    } else {
+      std::this_thread::yield();
+    }
+    v = node->version.load(std::memory_order_acquire);
+  }
+  *version = v;
+}
+
+template <class Comparator>
+inline bool BPlusTree<Comparator>::Validate(const Node* node,
+                                            uint64_t version) {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return node->version.load(std::memory_order_relaxed) == version;
+}
+
+template <class Comparator>
+inline bool BPlusTree<Comparator>::UpgradeLock(Node* node,
+                                               uint64_t version) {
+  if (!node->version.compare_exchange_strong(version, version + 1,
+                                             std::memory_order_acquire)) {
+    return false;
+  }
+  // Readers that see any of the stores that follow must also see the node
+  // locked when they validate it.
+  std::atomic_thread_fence(std::memory_order_release);
+  return true;
+}
+
+template <class Comparator>
+inline void BPlusTree<Comparator>::Unlock(Node* node) {
+  node->version.fetch_add(1, std::memory_order_release);
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::Insert(const char* key) {
+  Target t = MakeTarget(key);
+  while (true) {
+    InsertResult result = TryInsert(key, t);
+    if (result != kRestart) {
+      return result == kInserted;
+    }
+  }
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::InsertResult BPlusTree<Comparator>::TryInsert(
+    const char* key, const Target& t) {
+  Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version;
+  ReadLock(node, &version);
+  if (node != root_.load(std::memory_order_acquire)) {
+    return kRestart;
+  }
+  Inner* parent = nullptr;
+  uint64_t parent_version = 0;
+  while (node->level > 0) {
+    Inner* inner = static_cast<Inner*>(node);
+    if (parent != nullptr && !Validate(parent, parent_version)) {
+      return kRestart;
+    }
+    uint32_t n = inner->count.load(std::memory_order_acquire);
+    if (n == kInnerSlots) {
+      // Inner nodes are split on the way down, so that the parent of a node
+      // that is split always has room for the new separator.
+      Split(inner, version, parent, parent_version, false /* append */);
+      return kRestart;
+    }
+    uint32_t idx = Rank(inner->prefixes, inner->keys, n, t,
+                        true /* or_equal */, nullptr /* found */);
+    parent = inner;
+    parent_version = version;
+    node = inner->children[idx].load(std::memory_order_acquire);
+    if (!Validate(inner, version)) {
+      return kRestart;
+    }
+    ReadLock(node, &version);
+  }
+
+  Leaf* leaf = static_cast<Leaf*>(node);
+  uint32_t n = leaf->count.load(std::memory_order_acquire);
+  bool found = false;
+  uint32_t pos =
+      Rank(leaf->prefixes, leaf->keys, n, t, false /* or_equal */, &found);
+  if (found) {
+    // Keys are never removed, so the key is in the tree even if the leaf
+    // changed in the meantime.
+    return kDuplicate;
+  }
+  if (n == kLeafSlots) {
+    Split(leaf, version, parent, parent_version, pos == n /* append */);
+    return kRestart;
+  }
+  if (!UpgradeLock(leaf, version)) {
+    return kRestart;
+  }
+  // The leaf may have been split between the read of the parent and of its
+  // version, in which case the key may belong to its new sibling.
+  if (parent != nullptr && !Validate(parent, parent_version)) {
+    Unlock(leaf);
+    return kRestart;
+  }
+  for (uint32_t i = n; i > pos; i--) {
+    leaf->prefixes[i].store(
+        leaf->prefixes[i - 1].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    leaf->keys[i].store(leaf->keys[i - 1].load(std::memory_order_relaxed),
+                        std::memory_order_release);
+  }
+  leaf->prefixes[pos].store(t.prefix, std::memory_order_relaxed);
+  leaf->keys[pos].store(key, std::memory_order_release);
+  leaf->count.store(n + 1, std::memory_order_release);
+  Unlock(leaf);
+  return kInserted;
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Split(Node* node, uint64_t version, Inner* parent,
+                                  uint64_t parent_version, bool append) {
+  if (parent != nullptr && !UpgradeLock(parent, parent_version)) {
+    return;
+  }
+  if (!UpgradeLock(node, version)) {
+    if (parent != nullptr) {
+      Unlock(parent);
+    }
+    return;
+  }
+  // The root only changes when it is split, which changes its version.
+  assert(parent != nullptr || node == root_.load(std::memory_order_relaxed));
+
+  uint32_t n = node->count.load(std::memory_order_relaxed);
+  uint64_t sep_prefix;
+  const char* sep_key;
+  Node* right;
+  if (node->level == 0) {
+    Leaf* leaf = static_cast<Leaf*>(node);
+    uint32_t split = append ? n - 1 : n / 2;
+    Leaf* new_leaf = NewLeaf();
+    for (uint32_t i = split; i < n; i++) {
+      new_leaf->prefixes[i - split].store(
+          leaf->prefixes[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      new_leaf->keys[i - split].store(
+          leaf->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    new_leaf->count.store(n - split, std::memory_order_relaxed);
+    new_leaf->next.store(leaf->next.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    sep_prefix = leaf->prefixes[split].load(std::memory_order_relaxed);
+    sep_key = leaf->keys[split].load(std::memory_order_relaxed);
+    leaf->next.store(new_leaf, std::memory_order_release);
+    leaf->count.store(split, std::memory_order_release);
+    right = new_leaf;
+  } else {
+    // The separator in the middle moves up to the parent.
+    Inner* inner = static_cast<Inner*>(node);
+    uint32_t mid = n / 2;
+    Inner* new_inner = NewInner(inner->level);
+    for (uint32_t i = mid + 1; i < n; i++) {
+      new_inner->prefixes[i - mid - 1].store(
+          inner->prefixes[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      new_inner->keys[i - mid - 1].store(
+          inner->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    for (uint32_t i = mid + 1; i <= n; i++) {
+      new_inner->children[i - mid - 1].store(
+          inner->children[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    new_inner->count.store(n - mid - 1, std::memory_order_relaxed);
+    sep_prefix = inner->prefixes[mid].load(std::memory_order_relaxed);
+    sep_key = inner->keys[mid].load(std::memory_order_relaxed);
+    inner->count.store(mid, std::memory_order_release);
+    right = new_inner;
+  }
+
+  if (parent != nullptr) {
+    InsertChild(parent, sep_prefix, sep_key, right);
+  } else {
+    Inner* root = NewInner(node->level + 1);
+    root->prefixes[0].store(sep_prefix, std::memory_order_relaxed);
+    root->keys[0].store(sep_key, std::memory_order_relaxed);
+    root->children[0].store(node, std::memory_order_relaxed);
+    root->children[1].store(right, std::memory_order_relaxed);
+    root->count.store(1, std::memory_order_relaxed);
+    root_.store(root, std::memory_order_release);
+  }
+  Unlock(node);
+  if (parent != nullptr) {
+    Unlock(parent);
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::InsertChild(Inner* parent, uint64_t prefix,
+                                        const char* key, Node* right) {
+  uint32_t n = parent->count.load(std::memory_order_relaxed);
+  assert(n < kInnerSlots);
+  Target t;
+  t.key = compare_.decode_key(key);
+  t.prefix = prefix;
+  uint32_t pos = Rank(parent->prefixes, parent->keys, n, t,
+                      true /* or_equal */, nullptr /* found */);
+  for (uint32_t i = n; i > pos; i--) {
+    parent->prefixes[i].store(
+        parent->prefixes[i - 1].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    parent->keys[i].store(parent->keys[i - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    parent->children[i + 1].store(
+        parent->children[i].load(std::memory_order_relaxed),
+        std::memory_order_release);
+  }
+  parent->prefixes[pos].store(prefix, std::memory_order_relaxed);
+  parent->keys[pos].store(key, std::memory_order_release);
+  parent->children[pos + 1].store(right, std::memory_order_release);
+  parent->count.store(n + 1, std::memory_order_release);
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::Contains(const char* key) const {
+  Target t = MakeTarget(key);
+  Position pos;
+  SeekFirst(&t, false /* after_equal */, &pos);
+  return pos.key != nullptr && compare_(pos.key, t.key) == 0;
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::SeekFirst(const Target* t, bool after_equal,
+                                      Position* pos) const {
+  while (!TrySeekFirst(t, after_equal, pos)) {
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::SeekLast(const Target* t, bool or_equal,
+                                     Position* pos) const {
+  while (!TrySeekLast(t, or_equal, pos)) {
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Next(Position* pos) const {
+  const Leaf* leaf = pos->leaf;
+  if (pos->index + 1 < leaf->count.load(std::memory_order_acquire)) {
+    const char* key =
+        leaf->keys[pos->index + 1].load(std::memory_order_acquire);
+    if (Validate(leaf, pos->version)) {
+      pos->index++;
+      pos->key = key;
+      return;
+    }
+  } else {
+    const Leaf* next = leaf->next.load(std::memory_order_acquire);
+    if (Validate(leaf, pos->version) && TryFirstOfLeaf(next, pos)) {
+      return;
+    }
+  }
+  // The leaf changed since the key was read from it, so look the next key
+  // up from the root.
+  Target t = MakeTarget(pos->key);
+  SeekFirst(&t, true /* after_equal */, pos);
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Prev(Position* pos) const {
+  const Leaf* leaf = pos->leaf;
+  if (pos->index > 0) {
+    const char* key =
+        leaf->keys[pos->index - 1].load(std::memory_order_acquire);
+    if (Validate(leaf, pos->version)) {
+      pos->index--;
+      pos->key = key;
+      return;
+    }
+  }
+  // Leaves are only linked forward, so the previous key of the first key
+  // of a leaf is looked up from the root.
+  Target t = MakeTarget(pos->key);
+  SeekLast(&t, false /* or_equal */, pos);
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::TrySeekFirst(const Target* t, bool after_equal,
+                                         Position* pos) const {
+  const Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version;
+  ReadLock(node, &version);
+  if (node != root_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  const Inner* parent = nullptr;
+  uint64_t parent_version = 0;
+  while (node->level > 0) {
+    const Inner* inner = static_cast<const Inner*>(node);
+    if (parent != nullptr && !Validate(parent, parent_version)) {
+      return false;
+    }
+    uint32_t n = inner->count.load(std::memory_order_acquire);
+    uint32_t idx = t == nullptr ? 0
+                                : Rank(inner->prefixes, inner->keys, n, *t,
+                                       true /* or_equal */, nullptr);
+    parent = inner;
+    parent_version = version;
+    node = inner->children[idx].load(std::memory_order_acquire);
+    if (!Validate(inner, version)) {
+      return false;
+    }
+    ReadLock(node, &version);
+  }
+
+  const Leaf* leaf = static_cast<const Leaf*>(node);
+  uint32_t n = leaf->count.load(std::memory_order_acquire);
+  uint32_t idx =
+      t == nullptr
+          ? 0
+          : Rank(leaf->prefixes, leaf->keys, n, *t, after_equal, nullptr);
+  const char* key =
+      idx < n ? leaf->keys[idx].load(std::memory_order_acquire) : nullptr;
+  const Leaf* next = leaf->next.load(std::memory_order_acquire);
+  if (!Validate(leaf, version) ||
+      (parent != nullptr && !Validate(parent, parent_version))) {
+    return false;
+  }
+  if (key != nullptr) {
+    pos->leaf = leaf;
+    pos->index = idx;
+    pos->version = version;
+    pos->key = key;
+    return true;
+  }
+  // All the keys of the leaf are before the target, and any key between
+  // them and the first key of the next leaf would be in this leaf.
+  return TryFirstOfLeaf(next, pos);
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::TryFirstOfLeaf(const Leaf* leaf,
+                                           Position* pos) const {
+  // Only an empty root has no keys, so this normally reads a single leaf.
+  while (leaf != nullptr) {
+    uint64_t version;
+    ReadLock(leaf, &version);
+    uint32_t n = leaf->count.load(std::memory_order_acquire);
+    const char* key =
+        n > 0 ? leaf->keys[0].load(std::memory_order_acquire) : nullptr;
+    const Leaf* next = leaf->next.load(std::memory_order_acquire);
+    if (!Validate(leaf, version)) {
+      return false;
+    }
+    if (key != nullptr) {
+      pos->leaf = leaf;
+      pos->index = 0;
+      pos->version = version;
+      pos->key = key;
+      return true;
+    }
+    leaf = next;
+  }
+  pos->leaf = nullptr;
+  pos->key = nullptr;
+  return true;
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::TrySeekLast(const Target* t, bool or_equal,
+                                        Position* pos) const {
+  const Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version;
+  ReadLock(node, &version);
+  if (node != root_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  const Inner* parent = nullptr;
+  uint64_t parent_version = 0;
+  // The deepest inner node of the path with a child left of the path. The
+  // last key of that child is the last key before the leaf of the path.
+  const Inner* left_parent = nullptr;
+  uint64_t left_version = 0;
+  uint32_t left_idx = 0;
+  while (node->level > 0) {
+    const Inner* inner = static_cast<const Inner*>(node);
+    if (parent != nullptr && !Validate(parent, parent_version)) {
+      return false;
+    }
+    uint32_t n = inner->count.load(std::memory_order_acquire);
+    uint32_t idx = t == nullptr ? n
+                                : Rank(inner->prefixes, inner->keys, n, *t,
+                                       or_equal, nullptr);
+    if (idx > 0) {
+      left_parent = inner;
+      left_version = version;
+      left_idx = idx - 1;
+    }
+    parent = inner;
+    parent_version = version;
+    node = inner->children[idx].load(std::memory_order_acquire);
+    if (!Validate(inner, version)) {
+      return false;
+    }
+    ReadLock(node, &version);
+  }
+
+  const Leaf* leaf = static_cast<const Leaf*>(node);
+  uint32_t n = leaf->count.load(std::memory_order_acquire);
+  uint32_t idx =
+      t == nullptr
+          ? n
+          : Rank(leaf->prefixes, leaf->keys, n, *t, or_equal, nullptr);
+  const char* key =
+      idx > 0 ? leaf->keys[idx - 1].load(std::memory_order_acquire) : nullptr;
+  if (!Validate(leaf, version) ||
+      (parent != nullptr && !Validate(parent, parent_version))) {
+    return false;
+  }
+  if (key != nullptr) {
+    pos->leaf = leaf;
+    pos->index = idx - 1;
+    pos->version = version;
+    pos->key = key;
+    return true;
+  }
+  if (left_parent == nullptr) {
+    // The leaf is the first one.
+    pos->leaf = nullptr;
+    pos->key = nullptr;
+    return true;
+  }
+
+  // Find the last key of the subtree left of the path.
+  node = left_parent->children[left_idx].load(std::memory_order_acquire);
+  if (!Validate(left_parent, left_version)) {
+    return false;
+  }
+  ReadLock(node, &version);
+  parent = left_parent;
+  parent_version = left_version;
+  while (node->level > 0) {
+    const Inner* inner = static_cast<const Inner*>(node);
+    if (!Validate(parent, parent_version)) {
+      return false;
+    }
+    uint32_t inner_n = inner->count.load(std::memory_order_acquire);
+    parent = inner;
+    parent_version = version;
+    node = inner->children[inner_n].load(std::memory_order_acquire);
+    if (!Validate(inner, version)) {
+      return false;
+    }
+    ReadLock(node, &version);
+  }
+  leaf = static_cast<const Leaf*>(node);
+  n = leaf->count.load(std::memory_order_acquire);
+  key = n > 0 ? leaf->keys[n - 1].load(std::memory_order_acquire) : nullptr;
+  // If the subtree was split since left_parent was read, its last key may
+  // have moved to a new node between the subtree and the path.
+  if (!Validate(leaf, version) || !Validate(parent, parent_version) ||
+      !Validate(left_parent, left_version)) {
+    return false;
+  }
+  assert(key != nullptr);
+  if (key == nullptr) {
+    return false;
+  }
+  pos->leaf = leaf;
+  pos->index = n - 1;
+  pos->version = version;
+  pos->key = key;
+  return true;
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::TEST_Validate() const {
+  std::vector<const Leaf*> leaves;
+  ValidateNode(root_.load(std::memory_order_acquire), nullptr, nullptr,
+               &leaves);
+  // The leaves are linked in key order.
+  assert(!leaves.empty());
+  const Leaf* leaf = leaves[0];
+  for (const Leaf* expected : leaves) {
+    assert(leaf == expected);
+    (void)expected;
+    leaf = leaf->next.load(std::memory_order_acquire);
+  }
+  assert(leaf == nullptr);
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::ValidateNode(
+    const Node* node, const char* lower, const char* upper,
+    std::vector<const Leaf*>* leaves) const {
+  assert((node->version.load(std::memory_order_acquire) & 1) == 0);
+  uint32_t n = node->count.load(std::memory_order_acquire);
+  const std::atomic<uint64_t>* prefixes;
+  const std::atomic<const char*>* keys;
+  if (node->level == 0) {
+    const Leaf* leaf = static_cast<const Leaf*>(node);
+    assert(n <= kLeafSlots);
+    // Only an empty tree has an empty leaf.
+    assert(n > 0 || node == root_.load(std::memory_order_acquire));
+    prefixes = leaf->prefixes;
+    keys = leaf->keys;
+    leaves->push_back(leaf);
+  } else {
+    assert(n > 0 && n <= kInnerSlots);
+    prefixes = static_cast<const Inner*>(node)->prefixes;
+    keys = static_cast<const Inner*>(node)->keys;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    const char* key = keys[i].load(std::memory_order_acquire);
+    assert(key != nullptr);
+    if (key_prefix_ != nullptr) {
+      assert(prefixes[i].load(std::memory_order_acquire) ==
+             key_prefix_(compare_.decode_key(key)));
+    }
+    assert(i == 0 || compare_(keys[i - 1].load(std::memory_order_acquire),
+                              compare_.decode_key(key)) < 0);
+    assert(lower == nullptr || compare_(lower, compare_.decode_key(key)) <= 0);
+    assert(upper == nullptr || compare_(key, compare_.decode_key(upper)) < 0);
+    (void)key;
+    (void)lower;
+    (void)upper;
+  }
+  (void)prefixes;
+  if (node->level > 0) {
+    const Inner* inner = static_cast<const Inner*>(node);
+    for (uint32_t i = 0; i <= n; i++) {
+      const Node* child = inner->children[i].load(std::memory_order_acquire);
+      assert(child != nullptr && child->level + 1 == node->level);
+      ValidateNode(child,
+                   i == 0 ? lower : keys[i - 1].load(std::memory_order_acquire),
+                   i == n ? upper : keys[i].load(std::memory_order_acquire),
+                   leaves);
+    }
+  }
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,160 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+#include <algorithm>
+
+#include "db/memtable.h"
+#include "memtable/bplustree.h"
+#include "rocksdb/comparator.h"
+#include "util/arena.h"
+
+namespace rocksdb {
+namespace {
+
+// The first 8 bytes of the user key of an internal key, in big-endian
+// order, so that the prefixes order like BytewiseComparator() orders the
+// user keys. Shorter user keys are padded with zeroes.
+uint64_t BytewiseUserKeyPrefix(const Slice& internal_key) {
+  assert(internal_key.size() >= 8);
+  const size_t n = std::min(internal_key.size() - 8, sizeof(uint64_t));
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < n; i++) {
+    prefix |= static_cast<uint64_t>(static_cast<unsigned char>(internal_key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
+
+class BPlusTreeRep : public MemTableRep {
+  BPlusTree<const MemTableRep::KeyComparator&> tree_;
+
+ public:
+  BPlusTreeRep(const MemTableRep::KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator),
+        tree_(compare, allocator,
+              compare.user_comparator() == BytewiseComparator()
+                  ? &BytewiseUserKeyPrefix
+                  : nullptr) {}
+
+  // Insert key into the tree.
+  // REQUIRES: nothing that compares equal to key is currently in the tree.
+  virtual void Insert(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  virtual bool InsertKey(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  // The tree is always safe for concurrent inserts.
+  virtual void InsertConcurrently(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  virtual bool Contains(const char* key) const override {
+    return tree_.Contains(key);
+  }
+
+  virtual size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  virtual void Get(const LookupKey& k, void* callback_args,
+                   bool (*callback_func)(void* arg,
+                                         const char* entry)) override {
+    BPlusTreeRep::Iterator iter(&tree_);
+    Slice dummy_slice;
+    for (iter.Seek(dummy_slice, k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  virtual ~BPlusTreeRep() override {}
+
+  // Iteration over the contents of a B+-tree
+  class Iterator : public MemTableRep::Iterator {
+    BPlusTree<const MemTableRep::KeyComparator&>::Iterator iter_;
+
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const BPlusTree<const MemTableRep::KeyComparator&>* tree)
+        : iter_(tree) {}
+
+    virtual ~Iterator() override {}
+
+    // Returns true iff the iterator is positioned at a valid entry.
+    virtual bool Valid() const override { return iter_.Valid(); }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    virtual const char* key() const override { return iter_.key(); }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    virtual void Next() override { iter_.Next(); }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    virtual void Prev() override { iter_.Prev(); }
+
+    // Advance to the first entry with a key >= target
+    virtual void Seek(const Slice& user_key,
+                      const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Retreat to the last entry with a key <= target
+    virtual void SeekForPrev(const Slice& user_key,
+                             const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    virtual void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    virtual void SeekToLast() override { iter_.SeekToLast(); }
+
+   protected:
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  virtual MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(BPlusTreeRep::Iterator))
+                      : operator new(sizeof(BPlusTreeRep::Iterator));
+    return new (mem) BPlusTreeRep::Iterator(&tree_);
+  }
+};
+}  // namespace
+
+MemTableRep* BPlusTreeFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new BPlusTreeRep(compare, allocator);
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
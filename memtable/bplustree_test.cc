@@ -0,0 +1,265 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/bplustree.h"
+#include <atomic>
+#include <set>
+#include <vector>
+#include "port/port.h"
+#include "util/arena.h"
+#include "util/concurrent_arena.h"
+#include "util/random.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+// Our test tree stores 8-byte unsigned integers
+typedef uint64_t Key;
+
+static const char* Encode(const uint64_t* key) {
+  return reinterpret_cast<const char*>(key);
+}
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+struct TestComparator {
+  typedef Key DecodedType;
+
+  static DecodedType decode_key(const char* b) { return Decode(b); }
+
+  int operator()(const char* a, const char* b) const {
+    return operator()(a, Decode(b));
+  }
+
+  int operator()(const char* a, const DecodedType b) const {
+    if (Decode(a) < b) {
+      return -1;
+    } else if (Decode(a) > b) {
+      return +1;
+    } else {
+      return 0;
+    }
+  }
+};
+
+// Only the high bits, so that the keys of a node share prefixes and the
+// comparator is still called.
+static uint64_t TestKeyPrefix(const Key& key) { return key >> 4; }
+
+typedef BPlusTree<TestComparator> TestBPlusTree;
+
+class BPlusTreeTest : public testing::TestWithParam<bool> {
+ public:
+  BPlusTreeTest()
+      : tree_(cmp_, &arena_, GetParam() ? &TestKeyPrefix : nullptr) {}
+
+  bool Insert(Key key) {
+    char* buf = arena_.AllocateAligned(sizeof(Key));
+    memcpy(buf, &key, sizeof(Key));
+    return tree_.Insert(buf);
+  }
+
+  // Check the tree against keys_ with seeks from every key in [0, range).
+  void Validate(Key range) {
+    tree_.TEST_Validate();
+    for (Key i = 0; i < range; i++) {
+      ASSERT_EQ(keys_.count(i), tree_.Contains(Encode(&i)) ? 1U : 0U);
+    }
+
+    // Full scans in both directions
+    TestBPlusTree::Iterator iter(&tree_);
+    iter.SeekToFirst();
+    for (Key k : keys_) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(k, Decode(iter.key()));
+      iter.Next();
+    }
+    ASSERT_TRUE(!iter.Valid());
+    iter.SeekToLast();
+    for (auto it = keys_.rbegin(); it != keys_.rend(); ++it) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(*it, Decode(iter.key()));
+      iter.Prev();
+    }
+    ASSERT_TRUE(!iter.Valid());
+
+    for (Key i = 0; i < range; i++) {
+      // Forward iteration, compared against the model iterator
+      iter.Seek(Encode(&i));
+      std::set<Key>::iterator model_iter = keys_.lower_bound(i);
+      for (int j = 0; j < 3; j++) {
+        if (model_iter == keys_.end()) {
+          ASSERT_TRUE(!iter.Valid());
+          break;
+        }
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*model_iter, Decode(iter.key()));
+        ++model_iter;
+        iter.Next();
+      }
+
+      // Backward iteration
+      iter.SeekForPrev(Encode(&i));
+      model_iter = keys_.upper_bound(i);
+      for (int j = 0; j < 3; j++) {
+        if (model_iter == keys_.begin()) {
+          ASSERT_TRUE(!iter.Valid());
+          break;
+        }
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*--model_iter, Decode(iter.key()));
+        iter.Prev();
+      }
+    }
+  }
+
+ protected:
+  Arena arena_;
+  TestComparator cmp_;
+  TestBPlusTree tree_;
+  std::set<Key> keys_;
+};
+
+TEST_P(BPlusTreeTest, Empty) {
+  Key key = 10;
+  ASSERT_TRUE(!tree_.Contains(Encode(&key)));
+
+  TestBPlusTree::Iterator iter(&tree_);
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekToFirst();
+  ASSERT_TRUE(!iter.Valid());
+  key = 100;
+  iter.Seek(Encode(&key));
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekForPrev(Encode(&key));
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekToLast();
+  ASSERT_TRUE(!iter.Valid());
+}
+
+TEST_P(BPlusTreeTest, InsertAndLookup) {
+  const int N = 2000;
+  const Key R = 5000;
+  Random rnd(1000);
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    ASSERT_EQ(keys_.insert(key).second, Insert(key));
+  }
+  Validate(R);
+}
+
+TEST_P(BPlusTreeTest, InsertDuplicate) {
+  for (Key i = 0; i < 1000; i++) {
+    ASSERT_TRUE(Insert(i * 2));
+    keys_.insert(i * 2);
+  }
+  for (Key i = 0; i < 1000; i++) {
+    ASSERT_FALSE(Insert(i * 2));
+  }
+  Validate(2000);
+}
+
+TEST_P(BPlusTreeTest, InsertAscending) {
+  // Appending to the last leaf splits it unevenly, which Validate() checks
+  // the tree is still correct with.
+  for (Key i = 0; i < 20000; i++) {
+    ASSERT_TRUE(Insert(i));
+    keys_.insert(i);
+  }
+  Validate(20001);
+}
+
+TEST_P(BPlusTreeTest, InsertDescending) {
+  for (Key i = 20000; i > 0; i--) {
+    ASSERT_TRUE(Insert(i));
+    keys_.insert(i);
+  }
+  Validate(20002);
+}
+
+INSTANTIATE_TEST_CASE_P(BPlusTreeTest, BPlusTreeTest, ::testing::Bool());
+
+// Writers insert disjoint keys in ascending order while a reader scans the
+// tree: the reader must see the keys in order, and see every key that was
+// inserted before the scan started.
+TEST(BPlusTreeConcurrentTest, ConcurrentInsertAndRead) {
+  const int kWriters = 4;
+  const Key kKeysPerWriter = 20000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestBPlusTree tree(cmp, &arena, &TestKeyPrefix);
+  std::atomic<Key> done[kWriters];
+  for (int t = 0; t < kWriters; t++) {
+    done[t].store(0);
+  }
+  std::atomic<bool> stop(false);
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kWriters; t++) {
+    threads.emplace_back([&, t]() {
+      for (Key i = 0; i < kKeysPerWriter; i++) {
+        Key key = i * kWriters + t;
+        char* buf = arena.AllocateAligned(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        ASSERT_TRUE(tree.Insert(buf));
+        done[t].store(i + 1, std::memory_order_release);
+      }
+    });
+  }
+
+  std::atomic<int> scans(0);
+  port::Thread reader([&]() {
+    do {
+      Key snapshot[kWriters];
+      for (int t = 0; t < kWriters; t++) {
+        snapshot[t] = done[t].load(std::memory_order_acquire);
+      }
+      TestBPlusTree::Iterator iter(&tree);
+      Key seen[kWriters] = {0};
+      bool first = true;
+      Key prev = 0;
+      for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+        Key key = Decode(iter.key());
+        ASSERT_TRUE(first || prev < key);
+        first = false;
+        prev = key;
+        int t = static_cast<int>(key % kWriters);
+        if (key / kWriters < snapshot[t]) {
+          seen[t]++;
+        }
+      }
+      for (int t = 0; t < kWriters; t++) {
+        ASSERT_EQ(snapshot[t], seen[t]);
+      }
+      scans.fetch_add(1);
+    } while (!stop.load(std::memory_order_acquire));
+  });
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  stop.store(true, std::memory_order_release);
+  reader.join();
+  ASSERT_GT(scans.load(), 0);
+
+  tree.TEST_Validate();
+  TestBPlusTree::Iterator iter(&tree);
+  Key expected = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    ASSERT_EQ(expected++, Decode(iter.key()));
+  }
+  ASSERT_EQ(kWriters * kKeysPerWriter, expected);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
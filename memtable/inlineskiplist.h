@@ -105,6 +105,13 @@ class InlineSkipList {
   // Like Insert, but external synchronization is not required.
   bool InsertConcurrently(const char* key);
 
+  // Like InsertWithHint, but external synchronization is not required, as
+  // long as each thread uses its own hint. The hint is allocated from the
+  // arena, which is thread-safe for concurrent inserts.
+  //
+  // REQUIRES: no concurrent calls that use the same hint.
+  bool InsertWithHintConcurrently(const char* key, void** hint);
+
   // Inserts a node into the skip list.  key must have been allocated by
   // AllocateKey and then filled in by the caller.  If UseCAS is true,
   // then external synchronization is not required, otherwise this method
@@ -669,6 +676,18 @@ bool InlineSkipList<Comparator>::InsertWithHint(const char* key, void** hint) {
   return Insert<false>(key, splice, true);
 }
 
+template <class Comparator>
+bool InlineSkipList<Comparator>::InsertWithHintConcurrently(const char* key,
+                                                            void** hint) {
+  assert(hint != nullptr);
+  Splice* splice = reinterpret_cast<Splice*>(*hint);
+  if (splice == nullptr) {
+    splice = AllocateSplice();
+    *hint = reinterpret_cast<void*>(splice);
+  }
+  return Insert<true>(key, splice, true);
+}
+
 template <class Comparator>
 template <bool prefetch_before>
 void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
@@ -10,6 +10,7 @@
 #include "memtable/inlineskiplist.h"
 #include <set>
 #include <unordered_set>
+#include <vector>
 #include "rocksdb/env.h"
 #include "util/concurrent_arena.h"
 #include "util/hash.h"
@@ -78,6 +79,9 @@ class InlineSkipTest : public testing::Test {
     return res;
   }
 
+  // Record a key inserted into the list by the test itself.
+  void InsertKeyForValidation(Key key) { keys_.insert(key); }
+
   void Validate(TestInlineSkipList* list) {
     // Check keys exist.
     for (Key key : keys_) {
@@ -309,6 +313,35 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, InsertWithHintConcurrently) {
+  const int kNumThreads = 4;
+  const int N = 10000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  // Each thread inserts its own sorted run of keys, which interleaves with
+  // the runs of the other threads, using its own hint.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      void* hint = nullptr;
+      for (int i = 0; i < N; i++) {
+        Key key = i * kNumThreads + t;
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        ASSERT_TRUE(list.InsertWithHintConcurrently(buf, &hint));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (Key key = 0; key < static_cast<Key>(kNumThreads * N); key++) {
+    InsertKeyForValidation(key);
+  }
+  Validate(&list);
+}
+
 #ifndef ROCKSDB_VALGRIND_RUN
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
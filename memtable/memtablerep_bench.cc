@@ -49,6 +49,9 @@ DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
               "\tfillseq                -- write N values in sequential order\n"
+              "\tfillsortedbatches      -- write N values in batches of\n"
+              "\t                          --batch_size sequential keys that\n"
+              "\t                          start at random keys\n"
               "\treadrandom             -- read N values in random order\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
@@ -63,6 +66,7 @@ DEFINE_string(memtablerep, "skiplist",
               "  more details. Options:\n"
               "\tskiplist            -- backed by a skiplist\n"
               "\tvector              -- backed by an std::vector\n"
+              "\tbplustree           -- backed by a B+-tree\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
               "\tcuckoo              -- backed by a cuckoo hash table");
@@ -122,6 +126,22 @@ DEFINE_int32(num_scans, 10,
 
 DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 
+DEFINE_int32(batch_size, 100,
+             "Number of keys in each batch of fillsortedbatches. With "
+             "--insert_with_hint, the hint is also reset after each batch");
+
+DEFINE_bool(insert_with_hint, false,
+            "Insert with a hint of the last insert position, as writes with "
+            "WriteOptions::memtable_insert_hint_per_batch do");
+
+DEFINE_bool(insert_concurrently, false,
+            "Use the concurrent insert API of the memtablerep, as writes with "
+            "allow_concurrent_memtable_write do");
+
+DEFINE_int32(memtable_shards, 0,
+             "If greater than 1, partition the memtablerep into this many "
+             "shards by the hash of the key, with NewShardedRepFactory");
+
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
@@ -168,12 +188,12 @@ class RandomGenerator {
   }
 };
 
-enum WriteMode { SEQUENTIAL, RANDOM, UNIQUE_RANDOM };
+enum WriteMode { SEQUENTIAL, RANDOM, UNIQUE_RANDOM, SORTED_BATCHES };
 
 class KeyGenerator {
  public:
   KeyGenerator(Random64* rand, WriteMode mode, uint64_t num)
-      : rand_(rand), mode_(mode), num_(num), next_(0) {
+      : rand_(rand), mode_(mode), num_(num), next_(0), batch_start_(0) {
     if (mode_ == UNIQUE_RANDOM) {
       // NOTE: if memory consumption of this approach becomes a concern,
       // we can either break it into pieces and only random shuffle a section
@@ -197,6 +217,13 @@ class KeyGenerator {
         return rand_->Next() % num_;
       case UNIQUE_RANDOM:
         return values_[next_++];
+      case SORTED_BATCHES: {
+        const uint64_t batch_size = static_cast<uint64_t>(FLAGS_batch_size);
+        if (next_ % batch_size == 0) {
+          batch_start_ = rand_->Next() % num_;
+        }
+        return (batch_start_ + next_++ % batch_size) % num_;
+      }
     }
     assert(false);
     return std::numeric_limits<uint64_t>::max();
@@ -207,6 +234,8 @@ class KeyGenerator {
   WriteMode mode_;
   const uint64_t num_;
   uint64_t next_;
+  // First key of the current batch in SORTED_BATCHES mode.
+  uint64_t batch_start_;
   std::vector<uint64_t> values_;
 };
 
@@ -244,7 +273,9 @@ class FillBenchmarkThread : public BenchmarkThread {
                       uint64_t* bytes_written, uint64_t* bytes_read,
                       uint64_t* sequence, uint64_t num_ops, uint64_t* read_hits)
       : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                        num_ops, read_hits) {}
+                        num_ops, read_hits),
+        hint_(nullptr),
+        num_filled_(0) {}
 
   void FillOne() {
     char* buf = nullptr;
@@ -263,10 +294,28 @@ class FillBenchmarkThread : public BenchmarkThread {
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
+    if (FLAGS_insert_with_hint) {
+      if (num_filled_++ % static_cast<uint64_t>(FLAGS_batch_size) == 0) {
+        // Start a new batch with a new hint, as a write batch would.
+        hint_ = nullptr;
+      }
+      if (FLAGS_insert_concurrently) {
+        table_->InsertWithHintConcurrently(handle, &hint_);
+      } else {
+        table_->InsertWithHint(handle, &hint_);
+      }
+    } else if (FLAGS_insert_concurrently) {
+      table_->InsertConcurrently(handle);
+    } else {
+      table_->Insert(handle);
+    }
     *bytes_written_ += encoded_len;
   }
 
+ private:
+  void* hint_;
+  uint64_t num_filled_;
+
   void operator()() override {
     for (unsigned int i = 0; i < num_ops_; ++i) {
       FillOne();
@@ -594,6 +643,8 @@ int main(int argc, char** argv) {
 #ifndef ROCKSDB_LITE
   } else if (FLAGS_memtablerep == "vector") {
     factory.reset(new rocksdb::VectorRepFactory);
+  } else if (FLAGS_memtablerep == "bplustree") {
+    factory.reset(new rocksdb::BPlusTreeFactory);
   } else if (FLAGS_memtablerep == "hashskiplist") {
     factory.reset(rocksdb::NewHashSkipListRepFactory(
         FLAGS_bucket_count, FLAGS_hashskiplist_height,
@@ -618,6 +669,22 @@ int main(int argc, char** argv) {
     fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
     exit(1);
   }
+#ifndef ROCKSDB_LITE
+  if (FLAGS_memtable_shards > 1) {
+    factory.reset(rocksdb::NewShardedRepFactory(
+        std::shared_ptr<rocksdb::MemTableRepFactory>(factory.release()),
+        static_cast<size_t>(FLAGS_memtable_shards)));
+  }
+#endif  // ROCKSDB_LITE
+  if (FLAGS_insert_concurrently && !factory->IsInsertConcurrentlySupported()) {
+    fprintf(stdout, "memtablerep %s does not support concurrent inserts\n",
+            FLAGS_memtablerep.c_str());
+    exit(1);
+  }
+  if (FLAGS_batch_size <= 0) {
+    fprintf(stdout, "batch_size must be positive\n");
+    exit(1);
+  }
 
   rocksdb::InternalKeyComparator internal_key_comp(
       rocksdb::BytewiseComparator());
@@ -658,6 +725,12 @@ int main(int argc, char** argv) {
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("fillsortedbatches")) {
+      memtablerep.reset(createMemtableRep());
+      key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::SORTED_BATCHES,
+                                              FLAGS_num_operations));
+      benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
+                                                 key_gen.get(), &sequence));
     } else if (name == rocksdb::Slice("readrandom")) {
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::RANDOM,
                                               FLAGS_num_operations));
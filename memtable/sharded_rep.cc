@@ -0,0 +1,362 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#ifndef ROCKSDB_LITE
+#include "rocksdb/memtablerep.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "db/memtable.h"
+#include "util/arena.h"
+#include "util/hash.h"
+#include "util/heap.h"
+
+namespace rocksdb {
+namespace {
+
+// Merges the iterators of the shards of a ShardedRep. A key is only ever in
+// one shard, so the children never hold keys that compare equal.
+class ShardedIterator : public MemTableRep::Iterator {
+ public:
+  // Takes ownership of children. If arena_mode, the children were allocated
+  // in an arena and are only destroyed.
+  ShardedIterator(const MemTableRep::KeyComparator& compare,
+                  std::vector<MemTableRep::Iterator*>&& children,
+                  bool arena_mode)
+      : children_(std::move(children)),
+        arena_mode_(arena_mode),
+        current_(nullptr),
+        forward_(true),
+        min_heap_(MinComparator(compare)),
+        max_heap_(MaxComparator(compare)) {}
+
+  virtual ~ShardedIterator() override {
+    for (auto child : children_) {
+      if (arena_mode_) {
+        child->~Iterator();
+      } else {
+        delete child;
+      }
+    }
+  }
+
+  virtual bool Valid() const override { return current_ != nullptr; }
+
+  virtual const char* key() const override {
+    assert(Valid());
+    return current_->key();
+  }
+
+  virtual void Next() override {
+    assert(Valid());
+    if (!forward_) {
+      // The other children are positioned before key(). Move them to the
+      // first entry after it, which they cannot hold.
+      const char* target = key();
+      Slice internal_key = GetLengthPrefixedSlice(target);
+      for (auto child : children_) {
+        if (child != current_) {
+          child->Seek(internal_key, target);
+        }
+      }
+      current_->Next();
+      InitMinHeap();
+      return;
+    }
+    current_->Next();
+    if (current_->Valid()) {
+      min_heap_.replace_top(current_);
+    } else {
+      min_heap_.pop();
+    }
+    current_ = min_heap_.empty() ? nullptr : min_heap_.top();
+  }
+
+  virtual void Prev() override {
+    assert(Valid());
+    if (forward_) {
+      // The other children are positioned after key(). Move them to the
+      // last entry before it.
+      const char* target = key();
+      Slice internal_key = GetLengthPrefixedSlice(target);
+      for (auto child : children_) {
+        if (child != current_) {
+          child->SeekForPrev(internal_key, target);
+        }
+      }
+      current_->Prev();
+      InitMaxHeap();
+      return;
+    }
+    current_->Prev();
+    if (current_->Valid()) {
+      max_heap_.replace_top(current_);
+    } else {
+      max_heap_.pop();
+    }
+    current_ = max_heap_.empty() ? nullptr : max_heap_.top();
+  }
+
+  virtual void Seek(const Slice& internal_key,
+                    const char* memtable_key) override {
+    for (auto child : children_) {
+      child->Seek(internal_key, memtable_key);
+    }
+    InitMinHeap();
+  }
+
+  virtual void SeekForPrev(const Slice& internal_key,
+                           const char* memtable_key) override {
+    for (auto child : children_) {
+      child->SeekForPrev(internal_key, memtable_key);
+    }
+    InitMaxHeap();
+  }
+
+  virtual void SeekToFirst() override {
+    for (auto child : children_) {
+      child->SeekToFirst();
+    }
+    InitMinHeap();
+  }
+
+  virtual void SeekToLast() override {
+    for (auto child : children_) {
+      child->SeekToLast();
+    }
+    InitMaxHeap();
+  }
+
+ private:
+  // BinaryHeap keeps the maximum on top, so the min heap orders its
+  // iterators by decreasing keys.
+  class MinComparator {
+   public:
+    explicit MinComparator(const MemTableRep::KeyComparator& compare)
+        : compare_(&compare) {}
+    bool operator()(MemTableRep::Iterator* a, MemTableRep::Iterator* b) const {
+      return (*compare_)(a->key(), b->key()) > 0;
+    }
+
+   private:
+    const MemTableRep::KeyComparator* compare_;
+  };
+
+  class MaxComparator {
+   public:
+    explicit MaxComparator(const MemTableRep::KeyComparator& compare)
+        : compare_(&compare) {}
+    bool operator()(MemTableRep::Iterator* a, MemTableRep::Iterator* b) const {
+      return (*compare_)(a->key(), b->key()) < 0;
+    }
+
+   private:
+    const MemTableRep::KeyComparator* compare_;
+  };
+
+  void InitMinHeap() {
+    forward_ = true;
+    min_heap_.clear();
+    for (auto child : children_) {
+      if (child->Valid()) {
+        min_heap_.push(child);
+      }
+    }
+    current_ = min_heap_.empty() ? nullptr : min_heap_.top();
+  }
+
+  void InitMaxHeap() {
+    forward_ = false;
+    max_heap_.clear();
+    for (auto child : children_) {
+      if (child->Valid()) {
+        max_heap_.push(child);
+      }
+    }
+    current_ = max_heap_.empty() ? nullptr : max_heap_.top();
+  }
+
+  std::vector<MemTableRep::Iterator*> children_;
+  const bool arena_mode_;
+  MemTableRep::Iterator* current_;
+  bool forward_;
+  BinaryHeap<MemTableRep::Iterator*, MinComparator> min_heap_;
+  BinaryHeap<MemTableRep::Iterator*, MaxComparator> max_heap_;
+};
+
+class ShardedRep : public MemTableRep {
+ public:
+  ShardedRep(const MemTableRep::KeyComparator& compare, Allocator* allocator,
+             std::vector<std::unique_ptr<MemTableRep>>&& shards)
+      : MemTableRep(allocator),
+        compare_(compare),
+        shards_(std::move(shards)) {}
+
+  // The shard of a key is only known once the key is written to the
+  // buffer, so keys are allocated by the first shard. The shards are
+  // created by the same factory, so they accept each other's keys.
+  virtual KeyHandle Allocate(const size_t len, char** buf) override {
+    return shards_[0]->Allocate(len, buf);
+  }
+
+  virtual void Insert(KeyHandle handle) override {
+    GetShard(static_cast<const char*>(handle))->Insert(handle);
+  }
+
+  virtual bool InsertKey(KeyHandle handle) override {
+    return GetShard(static_cast<const char*>(handle))->InsertKey(handle);
+  }
+
+  virtual void InsertConcurrently(KeyHandle handle) override {
+    GetShard(static_cast<const char*>(handle))->InsertConcurrently(handle);
+  }
+
+  virtual bool InsertKeyConcurrently(KeyHandle handle) override {
+    return GetShard(static_cast<const char*>(handle))
+        ->InsertKeyConcurrently(handle);
+  }
+
+  // Insert hints are positions in one shard, and consecutive keys are
+  // usually in different shards, so they are ignored (the default).
+
+  virtual bool Contains(const char* key) const override {
+    return GetShard(key)->Contains(key);
+  }
+
+  virtual void MarkReadOnly() override {
+    for (auto& shard : shards_) {
+      shard->MarkReadOnly();
+    }
+  }
+
+  // All the versions of a user key are in the same shard.
+  virtual void Get(const LookupKey& k, void* callback_args,
+                   bool (*callback_func)(void* arg,
+                                         const char* entry)) override {
+    shards_[ShardIndex(k.user_key())]->Get(k, callback_args, callback_func);
+  }
+
+  virtual uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                         const Slice& end_ikey) override {
+    uint64_t count = 0;
+    for (auto& shard : shards_) {
+      count += shard->ApproximateNumEntries(start_ikey, end_ikey);
+    }
+    return count;
+  }
+
+  virtual size_t ApproximateMemoryUsage() override {
+    size_t usage = 0;
+    for (auto& shard : shards_) {
+      usage += shard->ApproximateMemoryUsage();
+    }
+    return usage;
+  }
+
+  virtual ~ShardedRep() override {}
+
+  virtual MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    std::vector<MemTableRep::Iterator*> children;
+    children.reserve(shards_.size());
+    for (auto& shard : shards_) {
+      children.push_back(shard->GetIterator(arena));
+    }
+    return NewShardedIterator(std::move(children), arena);
+  }
+
+  virtual MemTableRep::Iterator* GetDynamicPrefixIterator(
+      Arena* arena = nullptr) override {
+    std::vector<MemTableRep::Iterator*> children;
+    children.reserve(shards_.size());
+    for (auto& shard : shards_) {
+      children.push_back(shard->GetDynamicPrefixIterator(arena));
+    }
+    return NewShardedIterator(std::move(children), arena);
+  }
+
+  virtual bool IsMergeOperatorSupported() const override {
+    return shards_[0]->IsMergeOperatorSupported();
+  }
+
+  virtual bool IsSnapshotSupported() const override {
+    return shards_[0]->IsSnapshotSupported();
+  }
+
+ private:
+  size_t ShardIndex(const Slice& user_key) const {
+    return GetSliceHash(user_key) % shards_.size();
+  }
+
+  MemTableRep* GetShard(const char* key) const {
+    return shards_[ShardIndex(UserKey(key))].get();
+  }
+
+  MemTableRep::Iterator* NewShardedIterator(
+      std::vector<MemTableRep::Iterator*>&& children, Arena* arena) {
+    void* mem = arena ? arena->AllocateAligned(sizeof(ShardedIterator))
+                      : operator new(sizeof(ShardedIterator));
+    return new (mem)
+        ShardedIterator(compare_, std::move(children), arena != nullptr);
+  }
+
+  const MemTableRep::KeyComparator& compare_;
+  std::vector<std::unique_ptr<MemTableRep>> shards_;
+};
+
+class ShardedRepFactory : public MemTableRepFactory {
+ public:
+  ShardedRepFactory(const std::shared_ptr<MemTableRepFactory>& base_factory,
+                    size_t shard_count)
+      : base_factory_(base_factory),
+        shard_count_(std::max(shard_count, static_cast<size_t>(1))) {}
+
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, Allocator* allocator,
+      const SliceTransform* transform, Logger* logger) override {
+    return CreateMemTableRep(compare, allocator, transform, logger,
+                             0 /* column_family_id */);
+  }
+
+  virtual MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, Allocator* allocator,
+      const SliceTransform* transform, Logger* logger,
+      uint32_t column_family_id) override {
+    std::vector<std::unique_ptr<MemTableRep>> shards;
+    shards.reserve(shard_count_);
+    for (size_t i = 0; i < shard_count_; i++) {
+      shards.emplace_back(base_factory_->CreateMemTableRep(
+          compare, allocator, transform, logger, column_family_id));
+    }
+    return new ShardedRep(compare, allocator, std::move(shards));
+  }
+
+  virtual const char* Name() const override { return "ShardedRepFactory"; }
+
+  virtual bool IsInsertConcurrentlySupported() const override {
+    return base_factory_->IsInsertConcurrentlySupported();
+  }
+
+  virtual bool CanHandleDuplicatedKey() const override {
+    return base_factory_->CanHandleDuplicatedKey();
+  }
+
+ private:
+  std::shared_ptr<MemTableRepFactory> base_factory_;
+  const size_t shard_count_;
+};
+
+}  // namespace
+
+MemTableRepFactory* NewShardedRepFactory(
+    const std::shared_ptr<MemTableRepFactory>& base_factory,
+    size_t shard_count) {
+  return new ShardedRepFactory(base_factory, shard_count);
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -58,6 +58,17 @@ public:
     return skip_list_.InsertConcurrently(static_cast<char*>(handle));
   }
 
+  virtual void InsertWithHintConcurrently(KeyHandle handle,
+                                          void** hint) override {
+    skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle), hint);
+  }
+
+  virtual bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                             void** hint) override {
+    return skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle),
+                                                 hint);
+  }
+
   // Returns true iff an entry that compares equal to key is in the list.
   virtual bool Contains(const char* key) const override {
     return skip_list_.Contains(key);
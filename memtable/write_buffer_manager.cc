@@ -48,10 +48,16 @@ struct WriteBufferManager::CacheRep {
 struct WriteBufferManager::CacheRep {};
 #endif  // ROCKSDB_LITE
 
+const int WriteBufferManager::kMaxStallLevel;
+
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
-                                       std::shared_ptr<Cache> cache)
+                                       std::shared_ptr<Cache> cache,
+                                       bool allow_stall,
+                                       WriteBufferFlushPolicy flush_policy)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
+      allow_stall_(allow_stall),
+      flush_policy_(flush_policy),
       memory_used_(0),
       memory_active_(0),
       cache_rep_(nullptr) {
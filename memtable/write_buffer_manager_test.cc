@@ -50,6 +50,33 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, StallLevel) {
+  // A write buffer manager of size 8MB
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(8 * 1024 * 1024));
+  wbf->ReserveMem(12 * 1024 * 1024);
+  ASSERT_EQ(0, wbf->StallLevel());
+
+  wbf.reset(new WriteBufferManager(8 * 1024 * 1024, {} /* cache */,
+                                   true /* allow_stall */));
+  wbf->ReserveMem(7 * 1024 * 1024);
+  ASSERT_EQ(0, wbf->StallLevel());
+  // Each step is 1/16 of the buffer size
+  wbf->ReserveMem(1 * 1024 * 1024);
+  ASSERT_EQ(1, wbf->StallLevel());
+  wbf->ReserveMem(512 * 1024);
+  ASSERT_EQ(2, wbf->StallLevel());
+  wbf->ScheduleFreeMem(8 * 1024 * 1024);
+  // Memory being flushed still counts
+  ASSERT_EQ(2, wbf->StallLevel());
+  wbf->ReserveMem(2 * 1024 * 1024);
+  ASSERT_EQ(6, wbf->StallLevel());
+  wbf->ReserveMem(8 * 1024 * 1024);
+  ASSERT_EQ(WriteBufferManager::kMaxStallLevel, wbf->StallLevel());
+  wbf->FreeMem(16 * 1024 * 1024);
+  ASSERT_EQ(0, wbf->StallLevel());
+}
+
 TEST_F(WriteBufferManagerTest, CacheCost) {
   // 1GB cache
   std::shared_ptr<Cache> cache = NewLRUCache(1024 * 1024 * 1024, 4);
@@ -13,6 +13,7 @@
 
 #include "port/port.h"
 #include "rocksdb/cache.h"
+#include "rocksdb/compaction_service.h"
 #include "rocksdb/env.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/wal_filter.h"
@@ -51,6 +52,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       manifest_preallocation_size(options.manifest_preallocation_size),
       allow_mmap_reads(options.allow_mmap_reads),
       allow_mmap_writes(options.allow_mmap_writes),
+      use_pmem_for_wal(options.use_pmem_for_wal),
       use_direct_reads(options.use_direct_reads),
       use_direct_io_for_flush_and_compaction(
           options.use_direct_io_for_flush_and_compaction),
@@ -62,11 +64,13 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       access_hint_on_compaction_start(options.access_hint_on_compaction_start),
       new_table_reader_for_compaction_inputs(
           options.new_table_reader_for_compaction_inputs),
+      compaction_async_readahead(options.compaction_async_readahead),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
       listeners(options.listeners),
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
+      unordered_write(options.unordered_write),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
@@ -85,7 +89,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       allow_ingest_behind(options.allow_ingest_behind),
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
-      manual_wal_flush(options.manual_wal_flush) {
+      manual_wal_flush(options.manual_wal_flush),
+      atomic_flush(options.atomic_flush),
+      precompute_wal_checksums(options.precompute_wal_checksums),
+      compaction_service(options.compaction_service) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -126,6 +133,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    allow_mmap_reads);
   ROCKS_LOG_HEADER(log, "                      Options.allow_mmap_writes: %d",
                    allow_mmap_writes);
+  ROCKS_LOG_HEADER(log, "                       Options.use_pmem_for_wal: %d",
+                   use_pmem_for_wal);
   ROCKS_LOG_HEADER(log, "                       Options.use_direct_reads: %d",
                    use_direct_reads);
   ROCKS_LOG_HEADER(log,
@@ -167,6 +176,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    static_cast<int>(access_hint_on_compaction_start));
   ROCKS_LOG_HEADER(log, " Options.new_table_reader_for_compaction_inputs: %d",
                    new_table_reader_for_compaction_inputs);
+  ROCKS_LOG_HEADER(log, "              Options.compaction_async_readahead: %d",
+                   compaction_async_readahead);
   ROCKS_LOG_HEADER(
       log, "          Options.random_access_max_buffer_size: %" ROCKSDB_PRIszt,
       random_access_max_buffer_size);
@@ -183,6 +194,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
+  ROCKS_LOG_HEADER(log, "                        Options.unordered_write: %d",
+                   unordered_write);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
@@ -216,6 +229,12 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "                Options.atomic_flush: %d",
+                   atomic_flush);
+  ROCKS_LOG_HEADER(log, "    Options.precompute_wal_checksums: %d",
+                   precompute_wal_checksums);
+  ROCKS_LOG_HEADER(log, "          Options.compaction_service: %s",
+                   compaction_service ? compaction_service->Name() : "None");
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -46,6 +46,7 @@ struct ImmutableDBOptions {
   size_t manifest_preallocation_size;
   bool allow_mmap_reads;
   bool allow_mmap_writes;
+  bool use_pmem_for_wal;
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
   bool allow_fallocate;
@@ -55,11 +56,13 @@ struct ImmutableDBOptions {
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
   DBOptions::AccessHint access_hint_on_compaction_start;
   bool new_table_reader_for_compaction_inputs;
+  bool compaction_async_readahead;
   size_t random_access_max_buffer_size;
   bool use_adaptive_mutex;
   std::vector<std::shared_ptr<EventListener>> listeners;
   bool enable_thread_tracking;
   bool enable_pipelined_write;
+  bool unordered_write;
   bool allow_concurrent_memtable_write;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
@@ -78,6 +81,9 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  bool atomic_flush;
+  bool precompute_wal_checksums;
+  std::shared_ptr<CompactionService> compaction_service;
 };
 
 struct MutableDBOptions {
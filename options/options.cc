@@ -181,6 +181,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(
         log, "                 Options.bottommost_compression_opts.enabled: %s",
         bottommost_compression_opts.enabled ? "true" : "false");
+    ROCKS_LOG_HEADER(
+        log, "        Options.bottommost_compression_opts.parallel_threads: %u",
+        bottommost_compression_opts.parallel_threads);
     ROCKS_LOG_HEADER(log, "           Options.compression_opts.window_bits: %d",
                      compression_opts.window_bits);
     ROCKS_LOG_HEADER(log, "                 Options.compression_opts.level: %d",
@@ -198,6 +201,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                 Options.compression_opts.enabled: %s",
                      compression_opts.enabled ? "true" : "false");
+    ROCKS_LOG_HEADER(log,
+                     "        Options.compression_opts.parallel_threads: %u",
+                     compression_opts.parallel_threads);
     ROCKS_LOG_HEADER(log, "     Options.level0_file_num_compaction_trigger: %d",
                      level0_file_num_compaction_trigger);
     ROCKS_LOG_HEADER(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -550,6 +556,7 @@ ReadOptions::ReadOptions()
       iterate_lower_bound(nullptr),
       iterate_upper_bound(nullptr),
       readahead_size(0),
+      async_readahead(false),
       max_skippable_internal_keys(0),
       read_tier(kReadAllTier),
       verify_checksums(true),
@@ -568,6 +575,7 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       iterate_lower_bound(nullptr),
       iterate_upper_bound(nullptr),
       readahead_size(0),
+      async_readahead(false),
       max_skippable_internal_keys(0),
       read_tier(kReadAllTier),
       verify_checksums(cksum),
@@ -73,6 +73,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.manifest_preallocation_size;
   options.allow_mmap_reads = immutable_db_options.allow_mmap_reads;
   options.allow_mmap_writes = immutable_db_options.allow_mmap_writes;
+  options.use_pmem_for_wal = immutable_db_options.use_pmem_for_wal;
   options.use_direct_reads = immutable_db_options.use_direct_reads;
   options.use_direct_io_for_flush_and_compaction =
       immutable_db_options.use_direct_io_for_flush_and_compaction;
@@ -86,6 +87,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.access_hint_on_compaction_start;
   options.new_table_reader_for_compaction_inputs =
       immutable_db_options.new_table_reader_for_compaction_inputs;
+  options.compaction_async_readahead =
+      immutable_db_options.compaction_async_readahead;
   options.compaction_readahead_size =
       mutable_db_options.compaction_readahead_size;
   options.random_access_max_buffer_size =
@@ -97,6 +100,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
+  options.unordered_write = immutable_db_options.unordered_write;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
   options.enable_write_thread_adaptive_yield =
@@ -126,6 +130,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.atomic_flush = immutable_db_options.atomic_flush;
+  options.precompute_wal_checksums =
+      immutable_db_options.precompute_wal_checksums;
+  options.compaction_service = immutable_db_options.compaction_service;
 
   return options;
 }
@@ -921,8 +929,19 @@ Status ParseCompressionOptions(const std::string& value, const std::string& name
       return Status::InvalidArgument(
           "unable to parse the specified CF option " + name);
     }
+    end = value.find(':', start);
     compression_opts.enabled =
-        ParseBoolean("", value.substr(start, value.size() - start));
+        ParseBoolean("", value.substr(start, end - start));
+  }
+  // parallel_threads is optional for backwards compatibility
+  if (end != std::string::npos) {
+    start = end + 1;
+    if (start >= value.size()) {
+      return Status::InvalidArgument(
+          "unable to parse the specified CF option " + name);
+    }
+    compression_opts.parallel_threads =
+        ParseUint32(value.substr(start, value.size() - start));
   }
   return Status::OK();
 }
@@ -1344,6 +1363,10 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"allow_mmap_writes",
          {offsetof(struct DBOptions, allow_mmap_writes), OptionType::kBoolean,
           OptionVerificationType::kNormal, false, 0}},
+        {"use_pmem_for_wal",
+         {offsetof(struct DBOptions, use_pmem_for_wal), OptionType::kBoolean,
+          OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, use_pmem_for_wal)}},
         {"use_direct_reads",
          {offsetof(struct DBOptions, use_direct_reads), OptionType::kBoolean,
           OptionVerificationType::kNormal, false, 0}},
@@ -1396,6 +1419,9 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, compaction_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal, true,
           offsetof(struct MutableDBOptions, compaction_readahead_size)}},
+        {"compaction_async_readahead",
+         {offsetof(struct DBOptions, compaction_async_readahead),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"random_access_max_buffer_size",
          {offsetof(struct DBOptions, random_access_max_buffer_size),
           OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
@@ -1497,6 +1523,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"enable_pipelined_write",
          {offsetof(struct DBOptions, enable_pipelined_write),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"unordered_write",
+         {offsetof(struct DBOptions, unordered_write), OptionType::kBoolean,
+          OptionVerificationType::kNormal, false, 0}},
         {"allow_concurrent_memtable_write",
          {offsetof(struct DBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1552,6 +1581,14 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, manual_wal_flush), OptionType::kBoolean,
           OptionVerificationType::kNormal, false,
           offsetof(struct ImmutableDBOptions, manual_wal_flush)}},
+        {"atomic_flush",
+         {offsetof(struct DBOptions, atomic_flush), OptionType::kBoolean,
+          OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, atomic_flush)}},
+        {"precompute_wal_checksums",
+         {offsetof(struct DBOptions, precompute_wal_checksums),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, precompute_wal_checksums)}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated, false,
           0}}};
@@ -1960,7 +1997,11 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"high_pri_pool_ratio",
          {offset_of(&LRUCacheOptions::high_pri_pool_ratio), OptionType::kDouble,
           OptionVerificationType::kNormal, true,
-          offsetof(struct LRUCacheOptions, high_pri_pool_ratio)}}};
+          offsetof(struct LRUCacheOptions, high_pri_pool_ratio)}},
+        {"tiny_lfu_admission",
+         {offset_of(&LRUCacheOptions::tiny_lfu_admission),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct LRUCacheOptions, tiny_lfu_admission)}}};
 
 #endif  // !ROCKSDB_LITE
 
@@ -200,6 +200,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
+      {offsetof(struct DBOptions, compaction_service),
+       sizeof(std::shared_ptr<CompactionService>)},
   };
 
   char* options_ptr = new char[sizeof(DBOptions)];
@@ -246,6 +248,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "max_total_wal_size=4295005604;"
                              "compaction_readahead_size=0;"
                              "new_table_reader_for_compaction_inputs=false;"
+                             "compaction_async_readahead=false;"
                              "keep_log_file_num=4890;"
                              "skip_stats_update_on_db_open=false;"
                              "max_manifest_file_size=4295009941;"
@@ -265,6 +268,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "delayed_write_rate=4294976214;"
                              "manifest_preallocation_size=1222;"
                              "allow_mmap_writes=false;"
+                             "use_pmem_for_wal=false;"
                              "stats_dump_period_sec=70127;"
                              "allow_fallocate=true;"
                              "allow_mmap_reads=false;"
@@ -275,6 +279,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "advise_random_on_open=true;"
                              "fail_if_options_file_error=false;"
                              "enable_pipelined_write=false;"
+                             "unordered_write=false;"
                              "allow_concurrent_memtable_write=true;"
                              "wal_recovery_mode=kPointInTimeRecovery;"
                              "enable_write_thread_adaptive_yield=true;"
@@ -291,6 +296,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "concurrent_prepare=false;"
                              "two_write_queues=false;"
                              "manual_wal_flush=false;"
+                             "atomic_flush=false;"
+                             "precompute_wal_checksums=false;"
                              "seq_per_batch=false;",
                              new_options));
 
@@ -25,6 +25,7 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/leveldb_options.h"
+#include "table/full_filter_bits_builder.h"
 #include "util/random.h"
 #include "util/stderr_logger.h"
 #include "util/string_util.h"
@@ -63,7 +64,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
        "kZSTDNotFinalCompression"},
       {"bottommost_compression", "kLZ4Compression"},
       {"bottommost_compression_opts", "5:6:7:8:9:true"},
-      {"compression_opts", "4:5:6:7:8:true"},
+      {"compression_opts", "4:5:6:7:8:true:2"},
       {"num_levels", "8"},
       {"level0_file_num_compaction_trigger", "8"},
       {"level0_slowdown_writes_trigger", "9"},
@@ -162,6 +163,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 7);
   ASSERT_EQ(new_cf_opt.compression_opts.zstd_max_train_bytes, 8);
   ASSERT_EQ(new_cf_opt.compression_opts.enabled, true);
+  ASSERT_EQ(new_cf_opt.compression_opts.parallel_threads, 2);
   ASSERT_EQ(new_cf_opt.bottommost_compression, kLZ4Compression);
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.window_bits, 5);
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.level, 6);
@@ -169,6 +171,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.max_dict_bytes, 8);
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.zstd_max_train_bytes, 9);
   ASSERT_EQ(new_cf_opt.bottommost_compression_opts.enabled, true);
+  ASSERT_EQ(new_cf_opt.bottommost_compression_opts.parallel_threads, 1);
   ASSERT_EQ(new_cf_opt.num_levels, 8);
   ASSERT_EQ(new_cf_opt.level0_file_num_compaction_trigger, 8);
   ASSERT_EQ(new_cf_opt.level0_slowdown_writes_trigger, 9);
@@ -541,6 +544,29 @@ TEST_F(OptionsTest, GetBlockBasedTableOptionsFromString) {
             new_opt.cache_index_and_filter_blocks);
   ASSERT_EQ(table_opt.filter_policy, new_opt.filter_policy);
 
+  // full filter format version
+  ASSERT_OK(GetBlockBasedTableOptionsFromString(
+      table_opt, "filter_policy=bloomfilter:10:false:1", &new_opt));
+  ASSERT_TRUE(new_opt.filter_policy != nullptr);
+  std::unique_ptr<FilterBitsBuilder> bits_builder(
+      new_opt.filter_policy->GetFilterBitsBuilder());
+  ASSERT_TRUE(dynamic_cast<SplitBlockBloomBitsBuilder*>(bits_builder.get()) !=
+              nullptr);
+
+  // Ribbon filter with a start level
+  ASSERT_OK(GetBlockBasedTableOptionsFromString(
+      table_opt, "filter_policy=ribbonfilter:10:2", &new_opt));
+  ASSERT_TRUE(new_opt.filter_policy != nullptr);
+  FilterBuildingContext context;
+  context.level_at_creation = 2;
+  bits_builder.reset(new_opt.filter_policy->GetBuilderWithContext(context));
+  ASSERT_TRUE(dynamic_cast<RibbonFilterBitsBuilder*>(bits_builder.get()) !=
+              nullptr);
+  context.level_at_creation = 1;
+  bits_builder.reset(new_opt.filter_policy->GetBuilderWithContext(context));
+  ASSERT_TRUE(dynamic_cast<FullFilterBitsBuilder*>(bits_builder.get()) !=
+              nullptr);
+
   // Check block cache options are overwritten when specified
   // in new format as a struct.
   ASSERT_OK(GetBlockBasedTableOptionsFromString(table_opt,
@@ -635,6 +661,16 @@ TEST_F(OptionsTest, GetBlockBasedTableOptionsFromString) {
   ASSERT_EQ(std::dynamic_pointer_cast<LRUCache>(
                 new_opt.block_cache_compressed)->GetHighPriPoolRatio(),
                 0.0);
+  ASSERT_FALSE(std::dynamic_pointer_cast<LRUCache>(
+                   new_opt.block_cache)->GetTinyLFUAdmission());
+
+  // Enable TinyLFU admission.
+  ASSERT_OK(GetBlockBasedTableOptionsFromString(table_opt,
+             "block_cache={capacity=1M;tiny_lfu_admission=true;}",
+             &new_opt));
+  ASSERT_EQ(new_opt.block_cache->GetCapacity(), 1024UL*1024UL);
+  ASSERT_TRUE(std::dynamic_pointer_cast<LRUCache>(
+                  new_opt.block_cache)->GetTinyLFUAdmission());
 }
 #endif  // !ROCKSDB_LITE
 
@@ -703,6 +739,11 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("bplus_tree", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "BPlusTreeFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("bplus_tree:1024",
+                                             &new_mem_factory));
+
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo", &new_mem_factory));
   ASSERT_OK(GetMemTableRepFactoryFromString("cuckoo:1024", &new_mem_factory));
   ASSERT_EQ(std::string(new_mem_factory->Name()), "HashCuckooRepFactory");
@@ -1,6 +1,8 @@
 # These are the sources from which librocksdb.a is built:
 LIB_SOURCES =                                                   \
   cache/clock_cache.cc                                          \
+  cache/compressed_secondary_cache.cc                           \
+  cache/frequency_sketch.cc                                     \
   cache/lru_cache.cc                                            \
   cache/sharded_cache.cc                                        \
   db/builder.cc                                                 \
@@ -12,6 +14,8 @@ LIB_SOURCES =                                                   \
   db/compaction_job.cc                                          \
   db/compaction_picker.cc                                       \
   db/compaction_picker_universal.cc                             \
+  db/compaction_service.cc                                      \
+  db/concurrent_log_writer.cc                                   \
   db/convenience.cc                                             \
   db/db_filesnapshot.cc                                         \
   db/db_impl.cc                                                 \
@@ -67,6 +71,8 @@ LIB_SOURCES =                                                   \
   memtable/hash_cuckoo_rep.cc                                   \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
+  memtable/bplustree_rep.cc                                     \
+  memtable/sharded_rep.cc                                       \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
@@ -337,6 +343,7 @@ MAIN_SOURCES =                                                          \
   env/env_basic_test.cc                                                 \
   env/env_test.cc                                                       \
   env/mock_env_test.cc                                                  \
+  memtable/bplustree_test.cc                                            \
   memtable/inlineskiplist_test.cc                                       \
   memtable/memtablerep_bench.cc                                         \
   memtable/skiplist_test.cc                                             \
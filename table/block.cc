@@ -14,6 +14,11 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
 
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
@@ -94,6 +99,132 @@ struct DecodeKeyV4 {
   }
 };
 
+namespace {
+// Blocks with fewer restart points are searched with the comparator alone
+const uint32_t kMinRestartsForKeyPrefixes = 4;
+// RestartKeyPrefixes::Find() stops the scalar binary search once this many
+// prefixes are left, and counts them with SIMD compares
+const uint32_t kKeyPrefixScanWidth = 16;
+
+inline uint32_t CountMaskBits(int mask) {
+  return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+         ((mask >> 3) & 1);
+}
+
+// Counts the prefixes of p[0, n) that are less than and greater than t
+inline void CountLessAndGreater(const int64_t* p, uint32_t n, int64_t t,
+                                uint32_t* less, uint32_t* greater) {
+  uint32_t i = 0;
+  uint32_t l = 0;
+  uint32_t g = 0;
+#ifdef __AVX2__
+  const __m256i tv = _mm256_set1_epi64x(t);
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    l += CountMaskBits(
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(tv, v))));
+    g += CountMaskBits(
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, tv))));
+  }
+#elif defined(__SSE4_2__)
+  const __m128i tv = _mm_set1_epi64x(t);
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    l += CountMaskBits(
+        _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(tv, v))));
+    g += CountMaskBits(
+        _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(v, tv))));
+  }
+#endif
+  for (; i < n; i++) {
+    l += p[i] < t;
+    g += p[i] > t;
+  }
+  *less = l;
+  *greater = g;
+}
+
+// Number of bytes following the user key in the keys ordered by
+// `comparator`, or -1 if restart key prefixes do not apply to it.
+int RestartKeyFooterLength(const Comparator* comparator,
+                           const Comparator* user_comparator) {
+  if (user_comparator != BytewiseComparator()) {
+    return -1;
+  }
+  if (comparator == user_comparator) {
+    return 0;
+  }
+  // Otherwise comparator is an InternalKeyComparator, see Block::NewIterator()
+  if (!static_cast<const InternalKeyComparator*>(comparator)
+           ->OrdersByUserKey()) {
+    return -1;
+  }
+  // The packed sequence number and value type
+  return 8;
+}
+
+template <typename DecodeKeyFunc>
+RestartKeyPrefixes* BuildRestartKeyPrefixes(const char* data,
+                                            uint32_t restart_offset,
+                                            uint32_t num_restarts,
+                                            size_t key_footer_len) {
+  std::vector<int64_t> prefixes;
+  prefixes.reserve(num_restarts);
+  for (uint32_t i = 0; i < num_restarts; i++) {
+    uint32_t region_offset =
+        DecodeFixed32(data + restart_offset + i * sizeof(uint32_t));
+    uint32_t shared, non_shared;
+    const char* key_ptr = DecodeKeyFunc()(
+        data + region_offset, data + restart_offset, &shared, &non_shared);
+    if (key_ptr == nullptr || shared != 0 || non_shared < key_footer_len) {
+      // Leave it to BinarySeek() to report the corruption
+      return new RestartKeyPrefixes(std::vector<int64_t>(), port::kMaxSizet);
+    }
+    prefixes.push_back(RestartKeyPrefixes::Encode(
+        Slice(key_ptr, non_shared - key_footer_len)));
+  }
+  return new RestartKeyPrefixes(std::move(prefixes), key_footer_len);
+}
+}  // namespace
+
+int64_t RestartKeyPrefixes::Encode(const Slice& user_key) {
+  size_t n = std::min(user_key.size(), sizeof(uint64_t));
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < n; i++) {
+    prefix |= static_cast<uint64_t>(static_cast<unsigned char>(user_key[i]))
+              << (56 - 8 * i);
+  }
+  return static_cast<int64_t>(prefix ^ (uint64_t{1} << 63));
+}
+
+bool RestartKeyPrefixes::Find(const Slice& key, uint32_t* lo,
+                              uint32_t* hi) const {
+  if (key.size() < key_footer_len_) {
+    return false;
+  }
+  int64_t target = Encode(Slice(key.data(), key.size() - key_footer_len_));
+  const int64_t* p = prefixes_.data();
+  uint32_t begin = 0;
+  uint32_t end = static_cast<uint32_t>(prefixes_.size());
+  // The prefixes are sorted, so everything before `begin` is less than the
+  // target and everything from `end` on is greater.
+  while (end - begin > kKeyPrefixScanWidth) {
+    uint32_t mid = begin + (end - begin) / 2;
+    if (p[mid] < target) {
+      begin = mid + 1;
+    } else if (p[mid] > target) {
+      end = mid;
+    } else {
+      break;
+    }
+  }
+  uint32_t less, greater;
+  CountLessAndGreater(p + begin, end - begin, target, &less, &greater);
+  *lo = begin + less;
+  *hi = end - greater;
+  return true;
+}
+
 void DataBlockIter::Next() {
   assert(Valid());
   ParseNextDataKey();
@@ -603,6 +734,20 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t left,
                                    const Comparator* comp) {
   assert(left <= right);
 
+  if (restart_key_prefixes_ != nullptr && left == 0 &&
+      right == num_restarts_ - 1) {
+    uint32_t lo, hi;
+    if (restart_key_prefixes_->Find(target, &lo, &hi)) {
+      if (lo == hi) {
+        // No restart key shares the prefix of target
+        *index = lo > 0 ? lo - 1 : 0;
+        return true;
+      }
+      left = lo > 0 ? lo - 1 : 0;
+      right = hi - 1;
+    }
+  }
+
   while (left < right) {
     uint32_t mid = (left + right + 1) / 2;
     uint32_t region_offset = GetRestartPoint(mid);
@@ -752,7 +897,10 @@ BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   return index_type;
 }
 
-Block::~Block() { TEST_SYNC_POINT("Block::~Block"); }
+Block::~Block() {
+  TEST_SYNC_POINT("Block::~Block");
+  delete restart_key_prefixes_.load(std::memory_order_relaxed);
+}
 
 Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
              size_t read_amp_bytes_per_bit, Statistics* statistics)
@@ -761,7 +909,8 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
       size_(contents_.data.size()),
       restart_offset_(0),
       num_restarts_(0),
-      global_seqno_(_global_seqno) {
+      global_seqno_(_global_seqno),
+      restart_key_prefixes_(nullptr) {
   TEST_SYNC_POINT("Block::Block:0");
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
@@ -840,6 +989,11 @@ DataBlockIter* Block::NewIterator(const Comparator* cmp, const Comparator* ucmp,
         cmp, ucmp, data_, restart_offset_, num_restarts_, global_seqno_,
         read_amp_bitmap_.get(), cachable(),
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
+    int key_footer_len = RestartKeyFooterLength(cmp, ucmp);
+    if (key_footer_len >= 0) {
+      ret_iter->SetRestartKeyPrefixes(GetRestartKeyPrefixes(
+          key_footer_len, false /* value_delta_encoded */));
+    }
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -877,6 +1031,12 @@ IndexBlockIter* Block::NewIterator(const Comparator* cmp,
     ret_iter->Initialize(cmp, ucmp, data_, restart_offset_, num_restarts_,
                          prefix_index_ptr, key_includes_seq, value_is_full,
                          cachable(), nullptr /* data_block_hash_index */);
+    int key_footer_len =
+        RestartKeyFooterLength(key_includes_seq ? cmp : ucmp, ucmp);
+    if (key_footer_len >= 0) {
+      ret_iter->SetRestartKeyPrefixes(
+          GetRestartKeyPrefixes(key_footer_len, !value_is_full));
+    }
   }
 
   return ret_iter;
@@ -892,7 +1052,37 @@ size_t Block::ApproximateMemoryUsage() const {
   if (read_amp_bitmap_) {
     usage += read_amp_bitmap_->ApproximateMemoryUsage();
   }
+  const RestartKeyPrefixes* prefixes =
+      restart_key_prefixes_.load(std::memory_order_relaxed);
+  if (prefixes != nullptr) {
+    usage += prefixes->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
+const RestartKeyPrefixes* Block::GetRestartKeyPrefixes(
+    size_t key_footer_len, bool value_delta_encoded) {
+  if (num_restarts_ < kMinRestartsForKeyPrefixes) {
+    return nullptr;
+  }
+  RestartKeyPrefixes* prefixes =
+      restart_key_prefixes_.load(std::memory_order_acquire);
+  if (prefixes == nullptr) {
+    std::unique_ptr<RestartKeyPrefixes> built(
+        value_delta_encoded
+            ? BuildRestartKeyPrefixes<DecodeKeyV4>(data_, restart_offset_,
+                                                   num_restarts_,
+                                                   key_footer_len)
+            : BuildRestartKeyPrefixes<DecodeKey>(data_, restart_offset_,
+                                                 num_restarts_,
+                                                 key_footer_len));
+    // Another iterator may have built them concurrently, keep the first
+    if (restart_key_prefixes_.compare_exchange_strong(prefixes,
+                                                      built.get())) {
+      prefixes = built.release();
+    }
+  }
+  return prefixes->key_footer_len() == key_footer_len ? prefixes : nullptr;
+}
+
 }  // namespace rocksdb
@@ -10,6 +10,7 @@
 #pragma once
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>
 #include <string>
 #include <vector>
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
@@ -142,6 +143,37 @@ class BlockReadAmpBitmap {
   uint32_t rnd_;
 };
 
+// The first 8 bytes of the user key of each restart point of a block, for
+// blocks ordered by BytewiseComparator. Each prefix is zero padded and loaded
+// big-endian, with the sign bit flipped, so that comparing prefixes as signed
+// integers orders them like the keys. BinarySeek() uses them to find the
+// restart points that compare equal on the prefix with a few (SIMD) integer
+// compares, and only calls the comparator on those.
+class RestartKeyPrefixes {
+ public:
+  RestartKeyPrefixes(std::vector<int64_t>&& prefixes, size_t key_footer_len)
+      : prefixes_(std::move(prefixes)), key_footer_len_(key_footer_len) {}
+
+  // Number of bytes following the user key in the keys of the block, i.e. 8
+  // for internal keys and 0 for user keys.
+  size_t key_footer_len() const { return key_footer_len_; }
+
+  static int64_t Encode(const Slice& user_key);
+
+  // Sets [*lo, *hi) to the restart points whose prefix is equal to that of
+  // `key`: the restart keys before *lo are less than `key`, and the ones from
+  // *hi on are greater. Returns false if `key` is too short to be searched.
+  bool Find(const Slice& key, uint32_t* lo, uint32_t* hi) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(*this) + prefixes_.capacity() * sizeof(int64_t);
+  }
+
+ private:
+  std::vector<int64_t> prefixes_;
+  size_t key_footer_len_;
+};
+
 class Block {
  public:
   // Initialize the block with the specified contents.
@@ -195,6 +227,12 @@ class Block {
 
   SequenceNumber global_seqno() const { return global_seqno_; }
 
+  // Returns the prefixes of the restart keys of a BytewiseComparator ordered
+  // block whose keys are followed by `key_footer_len` bytes, building them on
+  // first use, or nullptr if the block is too small to benefit from them.
+  const RestartKeyPrefixes* GetRestartKeyPrefixes(size_t key_footer_len,
+                                                  bool value_delta_encoded);
+
  private:
   BlockContents contents_;
   const char* data_;            // contents_.data.data()
@@ -208,6 +246,9 @@ class Block {
 
   DataBlockHashIndex data_block_hash_index_;
 
+  // Built by the first iterator that can use them, and shared by the others
+  std::atomic<RestartKeyPrefixes*> restart_key_prefixes_;
+
   // No copying allowed
   Block(const Block&) = delete;
   void operator=(const Block&) = delete;
@@ -230,6 +271,13 @@ class BlockIter : public InternalIteratorBase<TValue> {
     restart_index_ = num_restarts_;
     global_seqno_ = global_seqno;
     block_contents_pinned_ = block_contents_pinned;
+    restart_key_prefixes_ = nullptr;
+  }
+
+  // Makes BinarySeek() narrow down the restart points with `prefixes`, which
+  // must come from the block being iterated.
+  void SetRestartKeyPrefixes(const RestartKeyPrefixes* prefixes) {
+    restart_key_prefixes_ = prefixes;
   }
 
   // Makes Valid() return false, status() return `s`, and Seek()/Prev()/etc do
@@ -298,6 +346,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
   // whether the block data is guaranteed to outlive this iterator
   bool block_contents_pinned_;
   SequenceNumber global_seqno_;
+  const RestartKeyPrefixes* restart_key_prefixes_;
 
  public:
   // Return the offset in data_ just past the end of the current entry.
@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
@@ -20,6 +21,7 @@
 #include <utility>
 
 #include "db/dbformat.h"
+#include "port/port.h"
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -42,6 +44,7 @@
 #include "util/coding.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/xxhash.h"
@@ -64,11 +67,14 @@ FilterBlockBuilder* CreateFilterBlockBuilder(
     const ImmutableCFOptions& /*opt*/, const MutableCFOptions& mopt,
     const BlockBasedTableOptions& table_opt,
     const bool use_delta_encoding_for_index_values,
-    PartitionedIndexBuilder* const p_index_builder) {
+    PartitionedIndexBuilder* const p_index_builder,
+    const int level_at_creation) {
   if (table_opt.filter_policy == nullptr) return nullptr;
 
+  FilterBuildingContext context;
+  context.level_at_creation = level_at_creation;
   FilterBitsBuilder* filter_bits_builder =
-      table_opt.filter_policy->GetFilterBitsBuilder();
+      table_opt.filter_policy->GetBuilderWithContext(context);
   if (filter_bits_builder == nullptr) {
     return new BlockBasedFilterBlockBuilder(mopt.prefix_extractor.get(),
                                             table_opt);
@@ -243,6 +249,60 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   bool prefix_filtering_;
 };
 
+// State of the data block compression pipeline, used when
+// CompressionOptions::parallel_threads > 1. Data blocks are compressed by a
+// pool of worker threads owned by the builder, and written to the file in
+// order by the thread calling Add(), which also adds their index entries.
+struct BlockBasedTableBuilder::ParallelCompressionRep {
+  // A data block from the time it is cut until it is written.
+  struct BlockRep {
+    std::string raw;
+    std::string compressed_output;
+    // Contents to write, pointing to raw or compressed_output.
+    Slice contents;
+    CompressionType type = kNoCompression;
+    Status status;
+    // Set by the worker once contents, type and status are final.
+    bool compressed = false;  // guarded by mu
+    // Arguments of the block's index entry.
+    std::string last_key;
+    std::string next_key;
+    bool has_next_key = false;
+  };
+
+  port::Mutex mu;
+  // Signaled when a block is queued for compression, or on shutdown.
+  port::CondVar work_cv;
+  // Signaled when a block is compressed.
+  port::CondVar done_cv;
+  std::deque<BlockRep*> to_compress;  // guarded by mu
+  bool shutdown = false;              // guarded by mu
+
+  // Blocks that are not written yet, in file order. Only accessed by the
+  // thread building the table.
+  std::deque<std::unique_ptr<BlockRep>> pending;
+  // Number of blocks that can be in flight before Add() waits for the
+  // oldest one to be compressed.
+  const size_t max_pending;
+  std::vector<port::Thread> workers;
+
+  // Used to estimate the file size while blocks are in flight.
+  uint64_t pending_raw_bytes = 0;
+  uint64_t written_raw_bytes = 0;
+  uint64_t written_bytes = 0;
+
+  explicit ParallelCompressionRep(uint32_t parallel_threads)
+      : work_cv(&mu), done_cv(&mu), max_pending(2 * parallel_threads) {}
+
+  uint64_t EstimatedPendingSize() const {
+    if (written_raw_bytes == 0) {
+      return pending_raw_bytes;
+    }
+    return static_cast<uint64_t>(static_cast<double>(pending_raw_bytes) *
+                                 written_bytes / written_raw_bytes);
+  }
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const MutableCFOptions moptions;
@@ -283,6 +343,9 @@ struct BlockBasedTableBuilder::Rep {
 
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  // Set if data blocks are compressed by worker threads.
+  std::unique_ptr<ParallelCompressionRep> pc_rep;
+
   Rep(const ImmutableCFOptions& _ioptions, const MutableCFOptions& _moptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -293,7 +356,7 @@ struct BlockBasedTableBuilder::Rep {
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict, const bool skip_filters,
       const std::string& _column_family_name, const uint64_t _creation_time,
-      const uint64_t _oldest_key_time)
+      const uint64_t _oldest_key_time, const int _level_at_creation)
       : ioptions(_ioptions),
         moptions(_moptions),
         table_options(table_opt),
@@ -341,7 +404,8 @@ struct BlockBasedTableBuilder::Rep {
     } else {
       filter_builder.reset(CreateFilterBlockBuilder(
           _ioptions, _moptions, table_options,
-          use_delta_encoding_for_index_values, p_index_builder_));
+          use_delta_encoding_for_index_values, p_index_builder_,
+          _level_at_creation));
     }
 
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
@@ -356,6 +420,17 @@ struct BlockBasedTableBuilder::Rep {
       verify_ctx.reset(new UncompressionContext(UncompressionContext::NoCache(),
                                                 compression_ctx.type()));
     }
+    // Block-based filters and the hash index need the offset or the keys of
+    // each data block as it is cut, and partitioned filters must see the
+    // index entries in step with their keys, so those keep compressing
+    // inline.
+    if (_compression_opts.parallel_threads > 1 &&
+        compression_ctx.type() != kNoCompression &&
+        table_options.index_type != BlockBasedTableOptions::kHashSearch &&
+        (filter_builder == nullptr ||
+         (!filter_builder->IsBlockBased() && !table_options.partition_filters))) {
+      pc_rep.reset(new ParallelCompressionRep(_compression_opts.parallel_threads));
+    }
   }
 
   Rep(const Rep&) = delete;
@@ -375,7 +450,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const CompressionOptions& compression_opts,
     const std::string* compression_dict, const bool skip_filters,
     const std::string& column_family_name, const uint64_t creation_time,
-    const uint64_t oldest_key_time) {
+    const uint64_t oldest_key_time, const int level_at_creation) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -392,7 +467,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
       new Rep(ioptions, moptions, sanitized_table_options, internal_comparator,
               int_tbl_prop_collector_factories, column_family_id, file,
               compression_type, compression_opts, compression_dict,
-              skip_filters, column_family_name, creation_time, oldest_key_time);
+              skip_filters, column_family_name, creation_time, oldest_key_time,
+              level_at_creation);
 
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
@@ -403,10 +479,18 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
         &rep_->compressed_cache_key_prefix[0],
         &rep_->compressed_cache_key_prefix_size);
   }
+
+  if (rep_->pc_rep != nullptr) {
+    for (uint32_t i = 0; i < compression_opts.parallel_threads; i++) {
+      rep_->pc_rep->workers.emplace_back(
+          &BlockBasedTableBuilder::BGWorkCompression, this);
+    }
+  }
 }
 
 BlockBasedTableBuilder::~BlockBasedTableBuilder() {
   assert(rep_->closed);  // Catch errors where caller forgot to call Finish()
+  assert(rep_->pc_rep == nullptr);
   delete rep_;
 }
 
@@ -421,7 +505,10 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     }
 
     auto should_flush = r->flush_block_policy->Update(key, value);
-    if (should_flush) {
+    if (should_flush && r->pc_rep != nullptr) {
+      assert(!r->data_block.empty());
+      QueueBlockForCompression(&key);
+    } else if (should_flush) {
       assert(!r->data_block.empty());
       Flush();
 
@@ -498,42 +585,59 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   assert(ok());
   Rep* r = rep_;
 
-  auto type = r->compression_ctx.type();
   Slice block_contents;
+  CompressionType type;
+  Status compress_status;
+  CompressAndVerifyBlock(raw_block_contents, is_data_block,
+                         &r->compression_ctx, r->verify_ctx.get(),
+                         &r->compressed_output, &block_contents, &type,
+                         &compress_status);
+  r->status = compress_status;
+  if (!ok()) {
+    return;
+  }
+
+  WriteRawBlock(block_contents, type, handle, is_data_block);
+  r->compressed_output.clear();
+}
+
+void BlockBasedTableBuilder::CompressAndVerifyBlock(
+    const Slice& raw_block_contents, bool is_data_block,
+    CompressionContext* compression_ctx, UncompressionContext* verify_ctx,
+    std::string* compressed_output, Slice* block_contents,
+    CompressionType* type, Status* out_status) const {
+  const Rep* r = rep_;
   bool abort_compression = false;
 
   StopWatchNano timer(r->ioptions.env,
     ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics));
 
   if (raw_block_contents.size() < kCompressionSizeLimit) {
-    Slice compression_dict;
     if (is_data_block && r->compression_dict && r->compression_dict->size()) {
-      r->compression_ctx.dict() = *r->compression_dict;
-      if (r->table_options.verify_compression) {
-        assert(r->verify_ctx != nullptr);
-        r->verify_ctx->dict() = *r->compression_dict;
+      compression_ctx->dict() = *r->compression_dict;
+      if (verify_ctx != nullptr) {
+        verify_ctx->dict() = *r->compression_dict;
       }
     } else {
       // Clear dictionary
-      r->compression_ctx.dict() = Slice();
-      if (r->table_options.verify_compression) {
-        assert(r->verify_ctx != nullptr);
-        r->verify_ctx->dict() = Slice();
+      compression_ctx->dict() = Slice();
+      if (verify_ctx != nullptr) {
+        verify_ctx->dict() = Slice();
       }
     }
 
-    block_contents =
-        CompressBlock(raw_block_contents, r->compression_ctx, &type,
-                      r->table_options.format_version, &r->compressed_output);
+    *block_contents =
+        CompressBlock(raw_block_contents, *compression_ctx, type,
+                      r->table_options.format_version, compressed_output);
 
     // Some of the compression algorithms are known to be unreliable. If
     // the verify_compression flag is set then try to de-compress the
     // compressed data and compare to the input.
-    if (type != kNoCompression && r->table_options.verify_compression) {
+    if (*type != kNoCompression && verify_ctx != nullptr) {
       // Retrieve the uncompressed contents into a new buffer
       BlockContents contents;
       Status stat = UncompressBlockContentsForCompressionType(
-          *r->verify_ctx, block_contents.data(), block_contents.size(),
+          *verify_ctx, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
 
       if (stat.ok()) {
@@ -543,12 +647,12 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
           abort_compression = true;
           ROCKS_LOG_ERROR(r->ioptions.info_log,
                           "Decompressed block did not match raw block");
-          r->status =
+          *out_status =
               Status::Corruption("Decompressed block did not match raw block");
         }
       } else {
         // Decompression reported an error. abort.
-        r->status = Status::Corruption("Could not decompress");
+        *out_status = Status::Corruption("Could not decompress");
         abort_compression = true;
       }
     }
@@ -561,9 +665,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   // verification.
   if (abort_compression) {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
-    block_contents = raw_block_contents;
-  } else if (type != kNoCompression) {
+    *type = kNoCompression;
+    *block_contents = raw_block_contents;
+  } else if (*type != kNoCompression) {
     if (ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics)) {
       MeasureTime(r->ioptions.statistics, COMPRESSION_TIMES_NANOS,
                   timer.ElapsedNanos());
@@ -572,9 +676,120 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
                 raw_block_contents.size());
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_COMPRESSED);
   }
+}
 
-  WriteRawBlock(block_contents, type, handle, is_data_block);
-  r->compressed_output.clear();
+void BlockBasedTableBuilder::QueueBlockForCompression(const Slice* next_key) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  assert(pc != nullptr);
+  if (!ok()) return;
+
+  std::unique_ptr<ParallelCompressionRep::BlockRep> block(
+      new ParallelCompressionRep::BlockRep);
+  block->raw = r->data_block.Finish().ToString();
+  r->data_block.Reset();
+  block->last_key = r->last_key;
+  if (next_key != nullptr) {
+    block->next_key = next_key->ToString();
+    block->has_next_key = true;
+  }
+  pc->pending_raw_bytes += block->raw.size();
+  {
+    MutexLock l(&pc->mu);
+    pc->to_compress.push_back(block.get());
+    pc->work_cv.Signal();
+  }
+  pc->pending.push_back(std::move(block));
+
+  WritePendingBlocks(pc->max_pending);
+}
+
+void BlockBasedTableBuilder::WritePendingBlocks(size_t max_pending) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  while (!pc->pending.empty()) {
+    ParallelCompressionRep::BlockRep* block = pc->pending.front().get();
+    {
+      MutexLock l(&pc->mu);
+      if (!block->compressed && pc->pending.size() <= max_pending) {
+        break;
+      }
+      // Even after an error, a block is only freed once no worker uses it.
+      while (!block->compressed) {
+        pc->done_cv.Wait();
+      }
+    }
+
+    if (ok()) {
+      r->status = block->status;
+    }
+    if (ok()) {
+      WriteRawBlock(block->contents, block->type, &r->pending_handle,
+                    true /* is_data_block */);
+    }
+    if (ok()) {
+      if (r->filter_builder != nullptr) {
+        r->filter_builder->StartBlock(r->offset);
+      }
+      r->props.data_size = r->offset;
+      ++r->props.num_data_blocks;
+      Slice next_key(block->next_key);
+      r->index_builder->AddIndexEntry(
+          &block->last_key, block->has_next_key ? &next_key : nullptr,
+          r->pending_handle);
+      pc->written_raw_bytes += block->raw.size();
+      pc->written_bytes += block->contents.size() + kBlockTrailerSize;
+    }
+    pc->pending_raw_bytes -= block->raw.size();
+    pc->pending.pop_front();
+  }
+}
+
+void BlockBasedTableBuilder::BGWorkCompression() {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  CompressionContext compression_ctx(r->compression_ctx.type(),
+                                     r->compression_ctx.options());
+  std::unique_ptr<UncompressionContext> verify_ctx;
+  if (r->table_options.verify_compression) {
+    verify_ctx.reset(new UncompressionContext(UncompressionContext::NoCache(),
+                                              compression_ctx.type()));
+  }
+
+  MutexLock l(&pc->mu);
+  while (true) {
+    while (pc->to_compress.empty() && !pc->shutdown) {
+      pc->work_cv.Wait();
+    }
+    if (pc->shutdown) {
+      break;
+    }
+    ParallelCompressionRep::BlockRep* block = pc->to_compress.front();
+    pc->to_compress.pop_front();
+
+    pc->mu.Unlock();
+    CompressAndVerifyBlock(block->raw, true /* is_data_block */,
+                           &compression_ctx, verify_ctx.get(),
+                           &block->compressed_output, &block->contents,
+                           &block->type, &block->status);
+    pc->mu.Lock();
+
+    block->compressed = true;
+    pc->done_cv.Signal();
+  }
+}
+
+void BlockBasedTableBuilder::StopParallelCompression() {
+  ParallelCompressionRep* pc = rep_->pc_rep.get();
+  {
+    MutexLock l(&pc->mu);
+    pc->shutdown = true;
+    pc->work_cv.SignalAll();
+  }
+  for (auto& worker : pc->workers) {
+    worker.join();
+  }
+  rep_->pc_rep.reset();
 }
 
 void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
@@ -855,13 +1070,22 @@ void BlockBasedTableBuilder::WriteRangeDelBlock(
 Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
   bool empty_data_block = r->data_block.empty();
-  Flush();
+  bool parallel_compression = r->pc_rep != nullptr;
+  if (parallel_compression) {
+    if (!empty_data_block) {
+      QueueBlockForCompression(nullptr /* no next data block */);
+    }
+    WritePendingBlocks(0 /* max_pending */);
+    StopParallelCompression();
+  } else {
+    Flush();
+  }
   assert(!r->closed);
   r->closed = true;
 
   // To make sure properties block is able to keep the accurate size of index
   // block, we will finish writing all index entries first.
-  if (ok() && !empty_data_block) {
+  if (ok() && !empty_data_block && !parallel_compression) {
     r->index_builder->AddIndexEntry(
         &r->last_key, nullptr /* no next data block */, r->pending_handle);
   }
@@ -920,6 +1144,9 @@ Status BlockBasedTableBuilder::Finish() {
 void BlockBasedTableBuilder::Abandon() {
   Rep* r = rep_;
   assert(!r->closed);
+  if (r->pc_rep != nullptr) {
+    StopParallelCompression();
+  }
   r->closed = true;
 }
 
@@ -928,6 +1155,10 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
 }
 
 uint64_t BlockBasedTableBuilder::FileSize() const {
+  if (rep_->pc_rep != nullptr) {
+    // Account for the data blocks that are not written yet.
+    return rep_->offset + rep_->pc_rep->EstimatedPendingSize();
+  }
   return rep_->offset;
 }
 
@@ -50,7 +50,7 @@ class BlockBasedTableBuilder : public TableBuilder {
       const CompressionOptions& compression_opts,
       const std::string* compression_dict, const bool skip_filters,
       const std::string& column_family_name, const uint64_t creation_time = 0,
-      const uint64_t oldest_key_time = 0);
+      const uint64_t oldest_key_time = 0, const int level_at_creation = -1);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~BlockBasedTableBuilder();
@@ -101,6 +101,18 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Compress and write block content to the file.
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
                   bool is_data_block);
+  // Compress raw_block_contents with compression_ctx, and check the result
+  // with verify_ctx unless it is null. Sets *block_contents to the contents
+  // to write, which may be in *compressed_output, and *type to their
+  // compression type. Only reads the immutable state of the builder, so it
+  // can be called from the compression workers.
+  void CompressAndVerifyBlock(const Slice& raw_block_contents,
+                              bool is_data_block,
+                              CompressionContext* compression_ctx,
+                              UncompressionContext* verify_ctx,
+                              std::string* compressed_output,
+                              Slice* block_contents, CompressionType* type,
+                              Status* out_status) const;
   // Directly write data to the file.
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle,
                      bool is_data_block = false);
@@ -116,6 +128,7 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
 
   struct Rep;
+  struct ParallelCompressionRep;
   class BlockBasedTablePropertiesCollectorFactory;
   class BlockBasedTablePropertiesCollector;
   Rep* rep_;
@@ -126,6 +139,24 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Flush();
 
+  // With parallel compression, cut the current data block and hand it to
+  // the compression workers. next_key is the first key of the next data
+  // block, or nullptr for the last one; the block's index entry is added
+  // when it is written.
+  void QueueBlockForCompression(const Slice* next_key);
+
+  // Write the compressed data blocks at the head of the queue, in order,
+  // waiting for their compression until at most max_pending blocks are
+  // left in flight.
+  void WritePendingBlocks(size_t max_pending);
+
+  // Body of a compression worker thread.
+  void BGWorkCompression();
+
+  // Stop and join the compression workers. Blocks that are still queued
+  // are dropped.
+  void StopParallelCompression();
+
   // Some compression libraries fail when the raw size is bigger than int. If
   // uncompressed size is bigger than kCompressionSizeLimit, don't compress it
   const uint64_t kCompressionSizeLimit = std::numeric_limits<int>::max();
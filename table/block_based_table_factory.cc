@@ -219,7 +219,7 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.skip_filters,
       table_builder_options.column_family_name,
       table_builder_options.creation_time,
-      table_builder_options.oldest_key_time);
+      table_builder_options.oldest_key_time, table_builder_options.level);
 
   return table_builder;
 }
@@ -479,7 +479,24 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       return "";
     } else if (name == "filter_policy") {
       // Expect the following format
-      // bloomfilter:int:bool
+      // bloomfilter:int:bool[:int]
+      // ribbonfilter:int[:int]
+      const std::string kRibbonName = "ribbonfilter:";
+      if (value.compare(0, kRibbonName.size(), kRibbonName) == 0) {
+        size_t pos = value.find(':', kRibbonName.size());
+        int bloom_equivalent_bits_per_key = ParseInt(
+            trim(value.substr(kRibbonName.size(),
+                              pos == std::string::npos
+                                  ? std::string::npos
+                                  : pos - kRibbonName.size())));
+        int ribbon_start_level = 0;
+        if (pos != std::string::npos) {
+          ribbon_start_level = ParseInt(trim(value.substr(pos + 1)));
+        }
+        new_options->filter_policy.reset(NewRibbonFilterPolicy(
+            bloom_equivalent_bits_per_key, ribbon_start_level));
+        return "";
+      }
       const std::string kName = "bloomfilter:";
       if (value.compare(0, kName.size(), kName) != 0) {
         return "Invalid filter policy name";
@@ -490,10 +507,19 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       }
       int bits_per_key =
           ParseInt(trim(value.substr(kName.size(), pos - kName.size())));
-      bool use_block_based_builder =
-          ParseBoolean("use_block_based_builder", trim(value.substr(pos + 1)));
-      new_options->filter_policy.reset(
-          NewBloomFilterPolicy(bits_per_key, use_block_based_builder));
+      size_t version_pos = value.find(':', pos + 1);
+      bool use_block_based_builder = ParseBoolean(
+          "use_block_based_builder",
+          trim(value.substr(pos + 1, version_pos == std::string::npos
+                                         ? std::string::npos
+                                         : version_pos - pos - 1)));
+      int full_filter_format_version = 0;
+      if (version_pos != std::string::npos) {
+        full_filter_format_version =
+            ParseInt(trim(value.substr(version_pos + 1)));
+      }
+      new_options->filter_policy.reset(NewBloomFilterPolicy(
+          bits_per_key, use_block_based_builder, full_filter_format_version));
       return "";
     }
   }
@@ -110,6 +110,43 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
 void DeleteCachedFilterEntry(const Slice& key, void* value);
 void DeleteCachedIndexEntry(const Slice& key, void* value);
 
+// A data block evicted to the secondary tier of the block cache is saved as
+// its global sequence number followed by its uncompressed contents.
+size_t SizeOfCachedBlock(void* value) {
+  return sizeof(uint64_t) + reinterpret_cast<Block*>(value)->size();
+}
+
+void SaveCachedBlock(void* value, char* out) {
+  auto block = reinterpret_cast<Block*>(value);
+  EncodeFixed64(out, block->global_seqno());
+  memcpy(out + sizeof(uint64_t), block->data(), block->size());
+}
+
+const Cache::CacheItemHelper kDataBlockCacheHelper = {
+    &SizeOfCachedBlock, &SaveCachedBlock, &DeleteCachedEntry<Block>};
+
+// Rebuilds a data block saved by SaveCachedBlock().
+Cache::CreateCallback NewDataBlockCreateCallback(size_t read_amp_bytes_per_bit,
+                                                 Statistics* statistics) {
+  return [read_amp_bytes_per_bit, statistics](
+             const Slice& data, void** value, size_t* charge) -> Status {
+    if (data.size() < sizeof(uint64_t)) {
+      return Status::Corruption("Truncated block from secondary cache");
+    }
+    SequenceNumber global_seqno = DecodeFixed64(data.data());
+    size_t size = data.size() - sizeof(uint64_t);
+    std::unique_ptr<char[]> buf(new char[size]);
+    memcpy(buf.get(), data.data() + sizeof(uint64_t), size);
+    Block* block = new Block(
+        BlockContents(std::move(buf), size, true /* cachable */,
+                      kNoCompression),
+        global_seqno, read_amp_bytes_per_bit, statistics);
+    *value = block;
+    *charge = block->ApproximateMemoryUsage();
+    return Status::OK();
+  };
+}
+
 // Release the cached entry and decrement its ref count.
 void ReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -141,8 +178,15 @@ Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
                                  uint64_t* block_cache_miss_stats,
                                  uint64_t* block_cache_hit_stats,
                                  Statistics* statistics,
-                                 GetContext* get_context) {
-  auto cache_handle = block_cache->Lookup(key, statistics);
+                                 GetContext* get_context,
+                                 const Cache::CacheItemHelper* helper = nullptr,
+                                 const Cache::CreateCallback& create_cb =
+                                     Cache::CreateCallback()) {
+  auto cache_handle =
+      helper != nullptr
+          ? block_cache->LookupWithHelper(key, helper, create_cb,
+                                          Cache::Priority::LOW, statistics)
+          : block_cache->Lookup(key, statistics);
   if (cache_handle != nullptr) {
     PERF_COUNTER_ADD(block_cache_hit_count, 1);
     if (get_context != nullptr) {
@@ -1193,7 +1237,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
             ? (is_index ? &get_context->get_context_stats_.num_cache_index_hit
                         : &get_context->get_context_stats_.num_cache_data_hit)
             : nullptr,
-        statistics, get_context);
+        statistics, get_context, is_index ? nullptr : &kDataBlockCacheHelper,
+        is_index ? Cache::CreateCallback()
+                 : NewDataBlockCreateCallback(read_amp_bytes_per_bit,
+                                              statistics));
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -1242,9 +1289,15 @@ Status BlockBasedTable::GetDataBlockFromCache(
     if (block_cache != nullptr && block->value->cachable() &&
         read_options.fill_cache) {
       size_t charge = block->value->ApproximateMemoryUsage();
-      s = block_cache->Insert(block_cache_key, block->value, charge,
-                              &DeleteCachedEntry<Block>,
-                              &(block->cache_handle));
+      if (is_index) {
+        s = block_cache->Insert(block_cache_key, block->value, charge,
+                                &DeleteCachedEntry<Block>,
+                                &(block->cache_handle));
+      } else {
+        s = block_cache->InsertWithHelper(block_cache_key, block->value,
+                                          &kDataBlockCacheHelper, charge,
+                                          &(block->cache_handle));
+      }
       block_cache->TEST_mark_as_data_block(block_cache_key, charge);
       if (s.ok()) {
         if (get_context != nullptr) {
@@ -1342,9 +1395,15 @@ Status BlockBasedTable::PutDataBlockToCache(
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
     size_t charge = block->value->ApproximateMemoryUsage();
-    s = block_cache->Insert(block_cache_key, block->value, charge,
-                            &DeleteCachedEntry<Block>, &(block->cache_handle),
-                            priority);
+    if (is_index) {
+      s = block_cache->Insert(block_cache_key, block->value, charge,
+                              &DeleteCachedEntry<Block>,
+                              &(block->cache_handle), priority);
+    } else {
+      s = block_cache->InsertWithHelper(block_cache_key, block->value,
+                                        &kDataBlockCacheHelper, charge,
+                                        &(block->cache_handle), priority);
+    }
     block_cache->TEST_mark_as_data_block(block_cache_key, charge);
     if (s.ok()) {
       assert(block->cache_handle != nullptr);
@@ -1795,36 +1854,68 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
         rep->table_options.read_amp_bytes_per_bit, is_index, get_context);
 
     if (block_entry->value == nullptr && !no_io && ro.fill_cache) {
-      std::unique_ptr<Block> raw_block;
-      {
-        StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
-        s = ReadBlockFromFile(
-            rep->file.get(), prefetch_buffer, rep->footer, ro, handle,
-            &raw_block, rep->ioptions,
-            block_cache_compressed == nullptr && rep->blocks_maybe_compressed,
-            compression_dict, rep->persistent_cache_options,
-            is_index ? kDisableGlobalSequenceNumber : rep->global_seqno,
-            rep->table_options.read_amp_bytes_per_bit, rep->immortal_table);
-      }
-
-      if (s.ok()) {
-        s = PutDataBlockToCache(
-            key, ckey, block_cache, block_cache_compressed, ro, rep->ioptions,
-            block_entry, raw_block.release(), rep->table_options.format_version,
-            compression_dict, rep->table_options.read_amp_bytes_per_bit,
-            is_index,
-            is_index && rep->table_options
-                            .cache_index_and_filter_blocks_with_high_priority
-                ? Cache::Priority::HIGH
-                : Cache::Priority::LOW,
-            get_context);
-      }
+      s = LoadDataBlockToCache(prefetch_buffer, rep, ro, handle,
+                               compression_dict, block_entry, is_index,
+                               get_context);
     }
   }
   assert(s.ok() || block_entry->value == nullptr);
   return s;
 }
 
+Status BlockBasedTable::LoadDataBlockToCache(
+    FilePrefetchBuffer* prefetch_buffer, Rep* rep, const ReadOptions& ro,
+    const BlockHandle& handle, Slice compression_dict,
+    CachableEntry<Block>* block_entry, bool is_index, GetContext* get_context) {
+  assert(block_entry != nullptr && block_entry->value == nullptr);
+  Cache* block_cache = rep->table_options.block_cache.get();
+  Cache* block_cache_compressed =
+      rep->table_options.block_cache_compressed.get();
+  assert(block_cache != nullptr || block_cache_compressed != nullptr);
+
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  char compressed_cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  Slice key, ckey;
+  if (block_cache != nullptr) {
+    key = GetCacheKey(rep->cache_key_prefix, rep->cache_key_prefix_size,
+                      handle, cache_key);
+  }
+  if (block_cache_compressed != nullptr) {
+    ckey = GetCacheKey(rep->compressed_cache_key_prefix,
+                       rep->compressed_cache_key_prefix_size, handle,
+                       compressed_cache_key);
+  }
+
+  Status s;
+  std::unique_ptr<Block> raw_block;
+  {
+    StopWatch sw(rep->ioptions.env, rep->ioptions.statistics,
+                 READ_BLOCK_GET_MICROS);
+    s = ReadBlockFromFile(
+        rep->file.get(), prefetch_buffer, rep->footer, ro, handle, &raw_block,
+        rep->ioptions,
+        block_cache_compressed == nullptr && rep->blocks_maybe_compressed,
+        compression_dict, rep->persistent_cache_options,
+        is_index ? kDisableGlobalSequenceNumber : rep->global_seqno,
+        rep->table_options.read_amp_bytes_per_bit, rep->immortal_table);
+  }
+
+  if (s.ok()) {
+    s = PutDataBlockToCache(
+        key, ckey, block_cache, block_cache_compressed, ro, rep->ioptions,
+        block_entry, raw_block.release(), rep->table_options.format_version,
+        compression_dict, rep->table_options.read_amp_bytes_per_bit, is_index,
+        is_index &&
+                rep->table_options
+                    .cache_index_and_filter_blocks_with_high_priority
+            ? Cache::Priority::HIGH
+            : Cache::Priority::LOW,
+        get_context);
+  }
+  assert(s.ok() || block_entry->value == nullptr);
+  return s;
+}
+
 BlockBasedTable::PartitionedIndexIteratorState::PartitionedIndexIteratorState(
     BlockBasedTable* table,
     std::unordered_map<uint64_t, CachableEntry<Block>>* block_map,
@@ -2118,10 +2209,28 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
     }
     auto* rep = table_->get_rep();
 
-    // Automatically prefetch additional data when a range scan (iterator) does
-    // more than 2 sequential IOs. This is enabled only for user reads and when
-    // ReadOptions.readahead_size is 0.
-    if (!for_compaction_ && read_options_.readahead_size == 0) {
+    if (read_options_.async_readahead) {
+      // Let a double-buffered FilePrefetchBuffer read the next window in the
+      // background. A fixed window starts right away; the automatic one
+      // waits for more than 2 sequential IOs, like the buffered readahead
+      // below.
+      if (!prefetch_buffer_ &&
+          (read_options_.readahead_size > 0 || ++num_file_reads_ > 2)) {
+        size_t readahead_size = read_options_.readahead_size > 0
+                                    ? read_options_.readahead_size
+                                    : kInitReadaheadSize;
+        size_t max_readahead_size = read_options_.readahead_size > 0
+                                        ? read_options_.readahead_size
+                                        : kMaxReadaheadSize;
+        prefetch_buffer_.reset(new FilePrefetchBuffer(
+            rep->file.get(), readahead_size, max_readahead_size,
+            true /* enable */, false /* track_min_offset */,
+            true /* async_readahead */));
+      }
+    } else if (!for_compaction_ && read_options_.readahead_size == 0) {
+      // Automatically prefetch additional data when a range scan (iterator)
+      // does more than 2 sequential IOs. This is enabled only for user reads
+      // and when ReadOptions.readahead_size is 0.
       num_file_reads_++;
       if (num_file_reads_ > 2) {
         if (!rep->file->use_direct_io() &&
@@ -2344,85 +2453,356 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
     }
 
     bool matched = false;  // if such user key mathced a key in SST
-    bool done = false;
-    for (iiter->Seek(key); iiter->Valid() && !done; iiter->Next()) {
-      BlockHandle handle = iiter->value();
-
-      bool not_exist_in_filter =
-          filter != nullptr && filter->IsBlockBased() == true &&
-          !filter->KeyMayMatch(ExtractUserKey(key), prefix_extractor,
-                               handle.offset(), no_io);
-
-      if (not_exist_in_filter) {
-        // Not found
-        // TODO: think about interaction with Merge. If a user key cannot
-        // cross one data block, we should be fine.
-        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+    iiter->Seek(key);
+    s = GetFromDataBlocks(read_options, key, get_context, iiter, filter,
+                          prefix_extractor, &matched);
+    if (matched && filter != nullptr && !filter->IsBlockBased()) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_TRUE_POSITIVE);
+    }
+  }
+
+  // if rep_->filter_entry is not set, we should call Release(); otherwise
+  // don't call, in this case we have a local copy in rep_->filter_entry,
+  // it's pinned to the cache and will be released in the destructor
+  if (!rep_->filter_entry.IsSet()) {
+    filter_entry.Release(rep_->table_options.block_cache.get());
+  }
+  return s;
+}
+
+Status BlockBasedTable::GetFromDataBlocks(
+    const ReadOptions& read_options, const Slice& key, GetContext* get_context,
+    InternalIteratorBase<BlockHandle>* iiter, FilterBlockReader* filter,
+    const SliceTransform* prefix_extractor, bool* matched) {
+  Status s;
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
+  bool done = false;
+  for (; iiter->Valid() && !done; iiter->Next()) {
+    BlockHandle handle = iiter->value();
+
+    bool not_exist_in_filter =
+        filter != nullptr && filter->IsBlockBased() == true &&
+        !filter->KeyMayMatch(ExtractUserKey(key), prefix_extractor,
+                             handle.offset(), no_io);
+
+    if (not_exist_in_filter) {
+      // Not found
+      // TODO: think about interaction with Merge. If a user key cannot
+      // cross one data block, we should be fine.
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      break;
+    } else {
+      DataBlockIter biter;
+      NewDataBlockIterator<DataBlockIter>(
+          rep_, read_options, iiter->value(), &biter, false,
+          true /* key_includes_seq */, get_context);
+
+      if (read_options.read_tier == kBlockCacheTier &&
+          biter.status().IsIncomplete()) {
+        // couldn't get block from block_cache
+        // Update Saver.state to Found because we are only looking for
+        // whether we can guarantee the key is not there when "no_io" is set
+        get_context->MarkKeyMayExist();
         break;
-      } else {
-        DataBlockIter biter;
-        NewDataBlockIterator<DataBlockIter>(
-            rep_, read_options, iiter->value(), &biter, false,
-            true /* key_includes_seq */, get_context);
-
-        if (read_options.read_tier == kBlockCacheTier &&
-            biter.status().IsIncomplete()) {
-          // couldn't get block from block_cache
-          // Update Saver.state to Found because we are only looking for
-          // whether we can guarantee the key is not there when "no_io" is set
-          get_context->MarkKeyMayExist();
-          break;
+      }
+      if (!biter.status().ok()) {
+        s = biter.status();
+        break;
+      }
+
+      bool may_exist = biter.SeekForGet(key);
+      if (!may_exist) {
+        // HashSeek cannot find the key this block and the the iter is not
+        // the end of the block, i.e. cannot be in the following blocks
+        // either. In this case, the seek_key cannot be found, so we break
+        // from the top level for-loop.
+        break;
+      }
+
+      // Call the *saver function on each entry/block until it returns false
+      for (; biter.Valid(); biter.Next()) {
+        ParsedInternalKey parsed_key;
+        if (!ParseInternalKey(biter.key(), &parsed_key)) {
+          s = Status::Corruption(Slice());
         }
-        if (!biter.status().ok()) {
-          s = biter.status();
+
+        if (!get_context->SaveValue(
+                parsed_key, biter.value(), matched,
+                biter.IsValuePinned() ? &biter : nullptr)) {
+          done = true;
           break;
         }
+      }
+      s = biter.status();
+    }
+    if (done) {
+      // Avoid the extra Next which is expensive in two-level indexes
+      break;
+    }
+  }
+  if (s.ok()) {
+    s = iiter->status();
+  }
+  return s;
+}
 
-        bool may_exist = biter.SeekForGet(key);
-        if (!may_exist) {
-          // HashSeek cannot find the key this block and the the iter is not
-          // the end of the block, i.e. cannot be in the following blocks
-          // either. In this case, the seek_key cannot be found, so we break
-          // from the top level for-loop.
-          break;
+void BlockBasedTable::MultiGet(const ReadOptions& read_options,
+                               size_t num_keys, const Slice* keys,
+                               GetContext** get_contexts, Status* statuses,
+                               const SliceTransform* prefix_extractor,
+                               bool skip_filters) {
+  if (num_keys == 0) {
+    return;
+  }
+  if (rep_->filter_type == Rep::FilterType::kBlockFilter) {
+    // Block-based filters are consulted once per data block, so there is
+    // nothing to share across keys before the data blocks are known.
+    TableReader::MultiGet(read_options, num_keys, keys, get_contexts,
+                          statuses, prefix_extractor, skip_filters);
+    return;
+  }
+
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
+  Statistics* statistics = rep_->ioptions.statistics;
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  Cache* block_cache_compressed =
+      rep_->table_options.block_cache_compressed.get();
+  CachableEntry<FilterBlockReader> filter_entry;
+  if (!skip_filters) {
+    filter_entry = GetFilter(prefix_extractor, /*prefetch_buffer*/ nullptr,
+                             no_io, get_contexts[0]);
+  }
+  FilterBlockReader* filter = filter_entry.value;
+
+  IndexBlockIter iiter_on_stack;
+  bool need_upper_bound_check = false;
+  if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+    need_upper_bound_check = PrefixExtractorChanged(
+        rep_->table_properties.get(), prefix_extractor);
+  }
+  auto iiter =
+      NewIndexIterator(read_options, need_upper_bound_check, &iiter_on_stack,
+                       /* index_entry */ nullptr, get_contexts[0]);
+  std::unique_ptr<InternalIteratorBase<BlockHandle>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // With whole key filtering, probe the full filter for all the keys at once
+  std::unique_ptr<bool[]> key_may_match;
+  if (filter != nullptr && !filter->IsBlockBased() &&
+      filter->whole_key_filtering()) {
+    std::vector<Slice> user_keys(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+      user_keys[i] = ExtractUserKey(keys[i]);
+    }
+    key_may_match.reset(new bool[num_keys]);
+    filter->KeysMayMatch(num_keys, user_keys.data(), prefix_extractor, no_io,
+                         keys, key_may_match.get());
+  }
+
+  // Find the first data block of every key that passes the filter. The keys
+  // are sorted, so keys sharing a data block are adjacent and the distinct
+  // blocks come out in file order.
+  const size_t kNoBlock = port::kMaxSizet;
+  std::vector<size_t> block_of_key(num_keys, kNoBlock);
+  std::vector<BlockHandle> handles;
+  std::vector<size_t> first_key_of_block;
+  for (size_t i = 0; i < num_keys; ++i) {
+    assert(keys[i].size() >= 8);  // key must be internal key
+    statuses[i] = Status::OK();
+    bool may_match;
+    if (key_may_match) {
+      may_match = key_may_match[i];
+      if (may_match) {
+        RecordTick(statistics, BLOOM_FILTER_FULL_POSITIVE);
+      }
+    } else {
+      may_match = FullFilterKeyMayMatch(read_options, filter, keys[i], no_io,
+                                        prefix_extractor);
+    }
+    if (!may_match) {
+      RecordTick(statistics, BLOOM_FILTER_USEFUL);
+      continue;
+    }
+    iiter->Seek(keys[i]);
+    if (!iiter->Valid()) {
+      statuses[i] = iiter->status();
+      continue;
+    }
+    BlockHandle handle = iiter->value();
+    if (handles.empty() || handles.back().offset() != handle.offset()) {
+      handles.push_back(handle);
+      first_key_of_block.push_back(i);
+    }
+    block_of_key[i] = handles.size() - 1;
+  }
+
+  Slice compression_dict;
+  if (rep_->compression_dict_block) {
+    compression_dict = rep_->compression_dict_block->data;
+  }
+
+  // Pin the blocks that are already cached and collect the rest.
+  std::vector<CachableEntry<Block>> blocks(handles.size());
+  std::vector<Status> block_statuses(handles.size());
+  std::vector<size_t> missing;
+  if (block_cache != nullptr || block_cache_compressed != nullptr) {
+    ReadOptions cache_only_options = read_options;
+    cache_only_options.read_tier = kBlockCacheTier;
+    for (size_t b = 0; b < handles.size(); ++b) {
+      block_statuses[b] = MaybeLoadDataBlockToCache(
+          nullptr /* prefetch_buffer */, rep_, cache_only_options, handles[b],
+          compression_dict, &blocks[b], false /* is_index */,
+          get_contexts[first_key_of_block[b]]);
+      if (block_statuses[b].ok() && blocks[b].value == nullptr) {
+        missing.push_back(b);
+      }
+    }
+  } else {
+    for (size_t b = 0; b < handles.size(); ++b) {
+      missing.push_back(b);
+    }
+  }
+
+  // Read the missing blocks. Blocks that are adjacent in the file are
+  // coalesced into a single read, and all the reads are handed to the file
+  // at once so they can be serviced in parallel.
+  if (!missing.empty() && !no_io) {
+    std::vector<uint64_t> run_offsets;
+    std::vector<size_t> run_lens;
+    std::vector<size_t> run_of_missing;
+    for (size_t m = 0; m < missing.size(); ++m) {
+      const BlockHandle& handle = handles[missing[m]];
+      size_t len = static_cast<size_t>(handle.size()) + kBlockTrailerSize;
+      if (!run_offsets.empty() &&
+          run_offsets.back() + run_lens.back() == handle.offset()) {
+        run_lens.back() += len;
+      } else {
+        run_offsets.push_back(handle.offset());
+        run_lens.push_back(len);
+      }
+      run_of_missing.push_back(run_offsets.size() - 1);
+    }
+
+    std::unique_ptr<FilePrefetchBuffer[]> run_buffers(
+        new FilePrefetchBuffer[run_offsets.size()]);
+    Status s;
+    {
+      PERF_TIMER_GUARD(block_read_time);
+      s = FilePrefetchBuffer::MultiPrefetch(
+          rep_->file.get(), run_buffers.get(), run_offsets.data(), run_lens.data(),
+          run_offsets.size());
+    }
+    PERF_COUNTER_ADD(block_read_count, missing.size());
+    for (size_t r = 0; r < run_lens.size(); ++r) {
+      PERF_COUNTER_ADD(block_read_byte, run_lens[r]);
+    }
+
+    for (size_t m = 0; m < missing.size(); ++m) {
+      size_t b = missing[m];
+      FilePrefetchBuffer* buffer = &run_buffers[run_of_missing[m]];
+      if (!s.ok()) {
+        block_statuses[b] = s;
+      } else if ((block_cache != nullptr ||
+                  block_cache_compressed != nullptr) &&
+                 read_options.fill_cache) {
+        block_statuses[b] = LoadDataBlockToCache(
+            buffer, rep_, read_options, handles[b], compression_dict,
+            &blocks[b], false /* is_index */,
+            get_contexts[first_key_of_block[b]]);
+      } else {
+        std::unique_ptr<Block> block_value;
+        {
+          StopWatch sw(rep_->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
+          block_statuses[b] = ReadBlockFromFile(
+              rep_->file.get(), buffer, rep_->footer, read_options,
+              handles[b], &block_value, rep_->ioptions,
+              rep_->blocks_maybe_compressed, compression_dict,
+              rep_->persistent_cache_options, rep_->global_seqno,
+              rep_->table_options.read_amp_bytes_per_bit,
+              rep_->immortal_table);
         }
+        if (block_statuses[b].ok()) {
+          blocks[b].value = block_value.release();
+        }
+      }
+    }
+  }
 
-        // Call the *saver function on each entry/block until it returns false
-        for (; biter.Valid(); biter.Next()) {
-          ParsedInternalKey parsed_key;
-          if (!ParseInternalKey(biter.key(), &parsed_key)) {
-            s = Status::Corruption(Slice());
-          }
+  for (size_t i = 0; i < num_keys; ++i) {
+    size_t b = block_of_key[i];
+    if (b == kNoBlock) {
+      continue;
+    }
+    GetContext* get_context = get_contexts[i];
+    if (!block_statuses[b].ok()) {
+      statuses[i] = block_statuses[b];
+      continue;
+    }
+    if (blocks[b].value == nullptr) {
+      assert(no_io);
+      // Same as Get(): we can't tell the key is not there without IO
+      get_context->MarkKeyMayExist();
+      continue;
+    }
 
-          if (!get_context->SaveValue(
-                  parsed_key, biter.value(), &matched,
-                  biter.IsValuePinned() ? &biter : nullptr)) {
-            done = true;
-            break;
-          }
+    DataBlockIter biter;
+    blocks[b].value->NewIterator<DataBlockIter>(
+        &rep_->internal_comparator, rep_->internal_comparator.user_comparator(),
+        &biter, statistics, true /* total_order_seek */);
+    // Values may only be pinned to blocks that live in the block cache; each
+    // key takes its own reference so that it can hand it to its value.
+    // Values of blocks owned by this call are copied out by get_context.
+    Cleanable* value_pinner = nullptr;
+    if (blocks[b].cache_handle != nullptr) {
+      block_cache->Ref(blocks[b].cache_handle);
+      biter.RegisterCleanup(&ReleaseCachedEntry, block_cache,
+                            blocks[b].cache_handle);
+      value_pinner = &biter;
+    }
+
+    bool matched = false;
+    bool done = false;
+    if (biter.SeekForGet(keys[i])) {
+      for (; biter.Valid(); biter.Next()) {
+        ParsedInternalKey parsed_key;
+        if (!ParseInternalKey(biter.key(), &parsed_key)) {
+          statuses[i] = Status::Corruption(Slice());
+        }
+        if (!get_context->SaveValue(parsed_key, biter.value(), &matched,
+                                    value_pinner)) {
+          done = true;
+          break;
         }
-        s = biter.status();
       }
-      if (done) {
-        // Avoid the extra Next which is expensive in two-level indexes
-        break;
+      if (statuses[i].ok()) {
+        statuses[i] = biter.status();
+      }
+      if (!done && statuses[i].ok()) {
+        // The versions of the key continue past the end of this block.
+        iiter->Seek(keys[i]);
+        iiter->Next();
+        statuses[i] =
+            GetFromDataBlocks(read_options, keys[i], get_context, iiter,
+                              filter, prefix_extractor, &matched);
       }
     }
-    if (matched && filter != nullptr && !filter->IsBlockBased()) {
-      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_TRUE_POSITIVE);
-    }
-    if (s.ok()) {
-      s = iiter->status();
+    if (matched && filter != nullptr) {
+      RecordTick(statistics, BLOOM_FILTER_FULL_TRUE_POSITIVE);
     }
   }
 
-  // if rep_->filter_entry is not set, we should call Release(); otherwise
-  // don't call, in this case we have a local copy in rep_->filter_entry,
-  // it's pinned to the cache and will be released in the destructor
+  for (auto& block : blocks) {
+    if (block.cache_handle != nullptr) {
+      block.Release(block_cache);
+    } else {
+      delete block.value;
+    }
+  }
   if (!rep_->filter_entry.IsSet()) {
-    filter_entry.Release(rep_->table_options.block_cache.get());
+    filter_entry.Release(block_cache);
   }
-  return s;
 }
 
 Status BlockBasedTable::Prefetch(const Slice* const begin,
@@ -120,6 +120,16 @@ class BlockBasedTable : public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks up the sorted internal keys as a batch: the filter and index are
+  // fetched once, keys are grouped by data block, and the blocks that miss in
+  // the block cache are read together, with adjacent blocks coalesced into a
+  // single read.
+  // @param skip_filters Disables loading/accessing the filter block
+  void MultiGet(const ReadOptions& readOptions, size_t num_keys,
+                const Slice* keys, GetContext** get_contexts,
+                Status* statuses, const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -263,6 +273,19 @@ class BlockBasedTable : public TableReader {
                                           bool is_index = false,
                                           GetContext* get_context = nullptr);
 
+  // Reads the block identified by handle from prefetch_buffer or the file and
+  // inserts it into the block cache(s) without looking it up first. Used on
+  // the miss path of MaybeLoadDataBlockToCache() and by MultiGet(), which
+  // probes the cache for a whole batch of blocks before reading the misses.
+  // REQUIRES: block_cache or block_cache_compressed is enabled.
+  static Status LoadDataBlockToCache(FilePrefetchBuffer* prefetch_buffer,
+                                     Rep* rep, const ReadOptions& ro,
+                                     const BlockHandle& handle,
+                                     Slice compression_dict,
+                                     CachableEntry<Block>* block_entry,
+                                     bool is_index = false,
+                                     GetContext* get_context = nullptr);
+
   // For the following two functions:
   // if `no_io == true`, we will not try to read filter/index from sst file
   // were they not present in cache yet.
@@ -344,6 +367,16 @@ class BlockBasedTable : public TableReader {
       InternalIterator* preloaded_meta_index_iter = nullptr,
       const int level = -1);
 
+  // Feeds the entries of key from the data blocks the index iterator points
+  // at, starting from its current position, to get_context until it has
+  // seen all that it needs. Sets *matched if the user key was found.
+  Status GetFromDataBlocks(const ReadOptions& read_options, const Slice& key,
+                           GetContext* get_context,
+                           InternalIteratorBase<BlockHandle>* iiter,
+                           FilterBlockReader* filter,
+                           const SliceTransform* prefix_extractor,
+                           bool* matched);
+
   bool FullFilterKeyMayMatch(
       const ReadOptions& read_options, FilterBlockReader* filter,
       const Slice& user_key, const bool no_io,
@@ -177,6 +177,30 @@ void BlockFetcher::GetBlockContents() {
   }
 }
 
+BlockFetcher::~BlockFetcher() {
+  if (read_submitted_) {
+    // The read must not outlive the buffer it writes into
+    file_->PollReads(&read_req_, 1, io_handle_, true /* wait */);
+  }
+}
+
+void BlockFetcher::SubmitRead() {
+  if (read_submitted_ || prefetch_buffer_ != nullptr ||
+      cache_options_.persistent_cache) {
+    return;
+  }
+  block_size_ = static_cast<size_t>(handle_.size());
+  PrepareBufferForBlockFromFile();
+  read_req_.offset = handle_.offset();
+  read_req_.len = block_size_ + kBlockTrailerSize;
+  read_req_.scratch = used_buf_;
+  submit_status_ = file_->SubmitReads(&read_req_, 1, &io_handle_);
+  if (!submit_status_.ok()) {
+    io_handle_ = nullptr;
+  }
+  read_submitted_ = true;
+}
+
 Status BlockFetcher::ReadBlockContents() {
   block_size_ = static_cast<size_t>(handle_.size());
 
@@ -188,14 +212,27 @@ Status BlockFetcher::ReadBlockContents() {
       return status_;
     }
   } else if (!TryGetCompressedBlockFromPersistentCache()) {
-    PrepareBufferForBlockFromFile();
-    Status s;
-
     {
       PERF_TIMER_GUARD(block_read_time);
-      // Actual file read
-      status_ = file_->Read(handle_.offset(), block_size_ + kBlockTrailerSize,
-                            &slice_, used_buf_);
+      if (read_submitted_) {
+        // Wait for the read started by SubmitRead()
+        read_submitted_ = false;
+        status_ = submit_status_;
+        if (status_.ok()) {
+          status_ = file_->PollReads(&read_req_, 1, io_handle_,
+                                     true /* wait */);
+        }
+        if (status_.ok()) {
+          status_ = read_req_.status;
+          slice_ = read_req_.result;
+        }
+      } else {
+        PrepareBufferForBlockFromFile();
+        // Actual file read
+        status_ = file_->Read(handle_.offset(),
+                              block_size_ + kBlockTrailerSize, &slice_,
+                              used_buf_);
+      }
     }
     PERF_COUNTER_ADD(block_read_count, 1);
     PERF_COUNTER_ADD(block_read_byte, block_size_ + kBlockTrailerSize);
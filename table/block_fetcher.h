@@ -38,6 +38,15 @@ class BlockFetcher {
         immortal_source_(immortal_source),
         compression_dict_(compression_dict),
         cache_options_(cache_options) {}
+  ~BlockFetcher();
+
+  // Start reading the block from the file without waiting for it, so that a
+  // thread can keep the reads of several fetchers in flight at once. A later
+  // ReadBlockContents() waits for the read and finishes the block as usual.
+  // Blocks that may be served by the persistent cache or the prefetch buffer
+  // are left to ReadBlockContents().
+  void SubmitRead();
+
   Status ReadBlockContents();
 
  private:
@@ -61,6 +70,11 @@ class BlockFetcher {
   std::unique_ptr<char[]> heap_buf_;
   char stack_buf_[kDefaultStackBufferSize];
   bool got_from_prefetch_buffer_ = false;
+  // The read started by SubmitRead(), while read_submitted_ is true
+  ReadRequest read_req_;
+  void* io_handle_ = nullptr;
+  Status submit_status_;
+  bool read_submitted_ = false;
   rocksdb::CompressionType compression_type;
 
   // return true if found
@@ -324,6 +324,97 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+// Seeks with the restart key prefixes of BytewiseComparator ordered blocks
+// must land where a plain binary search over the keys does.
+TEST_F(BlockTest, RestartKeyPrefixSeek) {
+  Random rnd(301);
+  InternalKeyComparator icmp(BytewiseComparator());
+  // Short keys, keys that are prefixes of others, and long shared prefixes
+  // that leave the restart key prefixes equal
+  const std::vector<std::string> kStems = {
+      "", "a", "ab", "abc\xff", "commonprefix", std::string("z\0", 2)};
+  const char kChars[] = {'\0', '\1', 'a', 'b', 'z', '\xff'};
+  auto random_user_key = [&]() {
+    std::string key = kStems[rnd.Uniform(static_cast<int>(kStems.size()))];
+    int len = rnd.Uniform(12);
+    for (int i = 0; i < len; i++) {
+      key.push_back(kChars[rnd.Uniform(static_cast<int>(sizeof(kChars)))]);
+    }
+    return key;
+  };
+  std::set<std::string> user_key_set;
+  while (user_key_set.size() < 2000) {
+    user_key_set.insert(random_user_key());
+  }
+  std::vector<std::string> user_keys(user_key_set.begin(),
+                                     user_key_set.end());
+  std::vector<std::string> internal_keys;
+  for (const auto &user_key : user_keys) {
+    internal_keys.push_back(
+        InternalKey(user_key, 100, kTypeValue).Encode().ToString());
+  }
+
+  for (int restart_interval : {1, 4, 16}) {
+    BlockBuilder data_builder(restart_interval);
+    BlockBuilder index_builder(restart_interval);
+    for (size_t i = 0; i < user_keys.size(); i++) {
+      data_builder.Add(internal_keys[i], "v");
+      std::string handle;
+      BlockHandle(i, 10).EncodeTo(&handle);
+      index_builder.Add(user_keys[i], handle);
+    }
+    BlockContents data_contents;
+    data_contents.data = data_builder.Finish();
+    Block data_block(std::move(data_contents), kDisableGlobalSequenceNumber);
+    BlockContents index_contents;
+    index_contents.data = index_builder.Finish();
+    Block index_block(std::move(index_contents),
+                      kDisableGlobalSequenceNumber);
+
+    std::unique_ptr<DataBlockIter> data_iter(
+        data_block.NewIterator<DataBlockIter>(&icmp, BytewiseComparator()));
+    std::unique_ptr<IndexBlockIter> index_iter(
+        index_block.NewIterator<IndexBlockIter>(
+            &icmp, BytewiseComparator(), nullptr /* iter */,
+            nullptr /* stats */, true /* total_order_seek */,
+            false /* key_includes_seq */));
+    for (int i = 0; i < 5000; i++) {
+      std::string user_key = i % 2 == 0
+                                 ? user_keys[rnd.Uniform(
+                                       static_cast<int>(user_keys.size()))]
+                                 : random_user_key();
+      for (SequenceNumber seq : {SequenceNumber{50}, SequenceNumber{150}}) {
+        std::string target =
+            InternalKey(user_key, seq, kTypeValue).Encode().ToString();
+        auto expected = std::lower_bound(
+            internal_keys.begin(), internal_keys.end(), target,
+            [&](const std::string &a, const std::string &b) {
+              return icmp.Compare(a, b) < 0;
+            });
+        data_iter->Seek(target);
+        if (expected == internal_keys.end()) {
+          ASSERT_FALSE(data_iter->Valid());
+        } else {
+          ASSERT_TRUE(data_iter->Valid());
+          ASSERT_EQ(*expected, data_iter->key().ToString());
+        }
+      }
+
+      auto expected =
+          std::lower_bound(user_keys.begin(), user_keys.end(), user_key);
+      index_iter->Seek(InternalKey(user_key, 0, kTypeValue).Encode());
+      if (expected == user_keys.end()) {
+        ASSERT_FALSE(index_iter->Valid());
+      } else {
+        ASSERT_TRUE(index_iter->Valid());
+        ASSERT_EQ(*expected, index_iter->key().ToString());
+      }
+    }
+    ASSERT_OK(data_iter->status());
+    ASSERT_OK(index_iter->status());
+  }
+}
+
 // A slow and accurate version of BlockReadAmpBitmap that simply store
 // all the marked ranges in a set.
 class BlockReadAmpBitmapSlowAndAccurate {
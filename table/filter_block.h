@@ -99,6 +99,22 @@ class FilterBlockReader {
                            const bool no_io = false,
                            const Slice* const const_ikey_ptr = nullptr) = 0;
 
+  /**
+   * Same as KeyMayMatch with block_offset kNotValid for each of keys[0,
+   * num_keys), setting may_match[i] for keys[i], whose internal key is
+   * ikeys[i]. Readers can check the keys together to overlap their memory
+   * accesses.
+   */
+  virtual void KeysMayMatch(size_t num_keys, const Slice* keys,
+                            const SliceTransform* prefix_extractor,
+                            const bool no_io, const Slice* ikeys,
+                            bool* may_match) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      may_match[i] = KeyMayMatch(keys[i], prefix_extractor, kNotValid, no_io,
+                                 &ikeys[i]);
+    }
+  }
+
   /**
    * no_io and const_ikey_ptr here means the same as in KeyMayMatch
    */
@@ -71,4 +71,97 @@ class FullFilterBitsBuilder : public FilterBitsBuilder {
   void operator=(const FullFilterBitsBuilder&);
 };
 
+// Builds split block Bloom filters (full filter format version 1). Each key
+// is mapped to one 32-byte block, split in 8 32-bit words, and sets one bit
+// in each word. Checking a key thus loads a single block and compares it
+// against an 8 bit mask, in one instruction with AVX2.
+class SplitBlockBloomBitsBuilder : public FilterBitsBuilder {
+ public:
+  static const uint32_t kBlockSize = 32;
+  static const uint32_t kNumProbes = 8;
+
+  explicit SplitBlockBloomBitsBuilder(const size_t bits_per_key);
+
+  ~SplitBlockBloomBitsBuilder();
+
+  virtual void AddKey(const Slice& key) override;
+
+  // The filter is num_blocks * kBlockSize bytes of blocks followed by a
+  // 6-byte trailer. Readers of the original format take the last 5 bytes
+  // for num_probes and num_lines, and see num_lines == 0.
+  // +----------------------------------------------------------------+
+  // |              blocks with length num_blocks * 32                |
+  // +----------------------------------------------------------------+
+  // | ... | format_version (1) : 1 byte | -1 : 1 byte | 0 : 4 bytes  |
+  // +----------------------------------------------------------------+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override;
+
+  virtual int CalculateNumEntry(const uint32_t space) override;
+
+  // Calculate space for new filter. This is reverse of CalculateNumEntry.
+  uint32_t CalculateSpace(const int num_entry, uint32_t* num_blocks);
+
+ private:
+  size_t bits_per_key_;
+  std::vector<uint32_t> hash_entries_;
+
+  // No Copy allowed
+  SplitBlockBloomBitsBuilder(const SplitBlockBloomBitsBuilder&);
+  void operator=(const SplitBlockBloomBitsBuilder&);
+};
+
+// Builds Ribbon filters (full filter format version 2). Each key is hashed
+// to a 64-bit coefficient row starting at some slot and to a num_result_bits
+// fingerprint, and the filter stores num_result_bits bits per slot that solve
+// the linear system over GF(2) of all the keys: for each key, the XOR of the
+// slots selected by its coefficient row is its fingerprint. The system is
+// brought to echelon form by Gaussian elimination as the keys are banded in
+// Finish(), and then solved by back substitution. A key that was not added
+// matches with probability 2^-num_result_bits, and the filter takes about
+// 1.1 * num_result_bits bits per key. If banding fails, which gets less
+// likely with more slots per key, it is retried with another hash seed and
+// then with more slots.
+class RibbonFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  static const uint32_t kCoeffBits = 64;
+  static const uint32_t kMaxResultBits = 16;
+
+  explicit RibbonFilterBitsBuilder(const uint32_t num_result_bits);
+
+  ~RibbonFilterBitsBuilder();
+
+  virtual void AddKey(const Slice& key) override;
+
+  // The solution is stored in blocks of kCoeffBits slots, each holding one
+  // 64-bit word per result bit, so that checking a key reads its start block
+  // and the next one. A filter of no keys has no blocks, and one that could
+  // not be built has num_result_bits 0 and matches every key.
+  // +----------------------------------------------------------------+
+  // |    num_slots / 64 blocks of num_result_bits 64-bit words      |
+  // +----------------------------------------------------------------+
+  // | ... | num_result_bits : 1 byte | seed : 1 byte                 |
+  // +----------------------------------------------------------------+
+  // | ... | format_version (2) : 1 byte | -1 : 1 byte | 0 : 4 bytes  |
+  // +----------------------------------------------------------------+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override;
+
+  virtual int CalculateNumEntry(const uint32_t space) override;
+
+  // Calculate space for new filter. This is reverse of CalculateNumEntry.
+  uint32_t CalculateSpace(const int num_entry, uint32_t* num_slots);
+
+ private:
+  uint32_t num_result_bits_;
+  std::vector<uint64_t> hash_entries_;
+
+  // Gaussian elimination of the keys into rows of the given number of slots.
+  // Returns false if the keys give an inconsistent system with this seed.
+  bool Band(uint32_t num_slots, uint32_t seed, uint64_t* coeff_rows,
+            uint16_t* result_rows) const;
+
+  // No Copy allowed
+  RibbonFilterBitsBuilder(const RibbonFilterBitsBuilder&);
+  void operator=(const RibbonFilterBitsBuilder&);
+};
+
 }  // namespace rocksdb
@@ -135,6 +135,30 @@ bool FullFilterBlockReader::KeyMayMatch(
   return MayMatch(key);
 }
 
+void FullFilterBlockReader::KeysMayMatch(
+    size_t num_keys, const Slice* keys,
+    const SliceTransform* /*prefix_extractor*/, const bool /*no_io*/,
+    const Slice* /*ikeys*/, bool* may_match) {
+  if (!whole_key_filtering_ || contents_.size() == 0) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      may_match[i] = true;
+    }
+    return;
+  }
+  std::vector<const Slice*> key_ptrs(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    key_ptrs[i] = &keys[i];
+  }
+  filter_bits_reader_->BatchMayMatch(static_cast<int>(num_keys),
+                                     key_ptrs.data(), may_match);
+  uint64_t hits = 0;
+  for (size_t i = 0; i < num_keys; ++i) {
+    hits += may_match[i] ? 1 : 0;
+  }
+  PERF_COUNTER_ADD(bloom_sst_hit_count, hits);
+  PERF_COUNTER_ADD(bloom_sst_miss_count, num_keys - hits);
+}
+
 bool FullFilterBlockReader::PrefixMayMatch(
     const Slice& prefix, const SliceTransform* /* prefix_extractor */,
     uint64_t block_offset, const bool /*no_io*/,
@@ -103,6 +103,11 @@ class FullFilterBlockReader : public FilterBlockReader {
       uint64_t block_offset = kNotValid, const bool no_io = false,
       const Slice* const const_ikey_ptr = nullptr) override;
 
+  virtual void KeysMayMatch(size_t num_keys, const Slice* keys,
+                            const SliceTransform* prefix_extractor,
+                            const bool no_io, const Slice* ikeys,
+                            bool* may_match) override;
+
   virtual bool PrefixMayMatch(
       const Slice& prefix, const SliceTransform* prefix_extractor,
       uint64_t block_offset = kNotValid, const bool no_io = false,
@@ -145,6 +145,15 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = new VectorRepFactory();
     }
+  } else if (opts_list[0] == "bplus_tree") {
+    // Expecting format
+    // bplus_tree
+    if (1 == len) {
+      mem_factory = new BPlusTreeFactory();
+    } else {
+      return Status::InvalidArgument("Can't parse memtable_factory option ",
+                                     opts_str);
+    }
   } else if (opts_list[0] == "cuckoo") {
     // Expecting format
     // cuckoo:<write_buffer_size>
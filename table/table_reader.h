@@ -85,6 +85,22 @@ class TableReader {
                      const SliceTransform* prefix_extractor,
                      bool skip_filters = false) = 0;
 
+  // Batched version of Get(). keys[0..num_keys-1] are internal keys in
+  // ascending order; the lookup of keys[i] reports its result through
+  // get_contexts[i] and sets statuses[i]. Implementations may use the batch
+  // to share index and filter lookups and to read the needed data blocks
+  // together. The default implementation calls Get() for each key.
+  virtual void MultiGet(const ReadOptions& readOptions, size_t num_keys,
+                        const Slice* keys, GetContext** get_contexts,
+                        Status* statuses,
+                        const SliceTransform* prefix_extractor,
+                        bool skip_filters = false) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      statuses[i] = Get(readOptions, keys[i], get_contexts[i],
+                        prefix_extractor, skip_filters);
+    }
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -3416,6 +3416,92 @@ TEST_P(BlockBasedTableTest, BlockAlignTest) {
   table_reader.reset();
 }
 
+TEST_P(BlockBasedTableTest, ParallelCompression) {
+  // The file does not depend on the compression library, as a block that
+  // cannot be compressed is stored uncompressed.
+  CompressionType compression_type = kSnappyCompression;
+  for (auto type : {kZSTD, kLZ4Compression, kSnappyCompression}) {
+    if (CompressionTypeSupported(type)) {
+      compression_type = type;
+      break;
+    }
+  }
+
+  for (auto index_type : {BlockBasedTableOptions::kBinarySearch,
+                          BlockBasedTableOptions::kTwoLevelIndexSearch}) {
+    BlockBasedTableOptions bbto = GetBlockBasedTableOptions();
+    bbto.index_type = index_type;
+    bbto.metadata_block_size = 256;
+    bbto.filter_policy.reset(NewBloomFilterPolicy(10, false));
+    Options options;
+    options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+    const ImmutableCFOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    InternalKeyComparator ikc(options.comparator);
+    std::vector<std::unique_ptr<IntTblPropCollectorFactory>>
+        int_tbl_prop_collector_factories;
+    std::string column_family_name;
+    auto key = [](int i) {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "%08d", i);
+      return std::string(buf);
+    };
+
+    auto build_table = [&](uint32_t parallel_threads) {
+      test::StringSink* sink = new test::StringSink();
+      unique_ptr<WritableFileWriter> file_writer(
+          test::GetWritableFileWriter(sink));
+      CompressionOptions compression_opts;
+      compression_opts.parallel_threads = parallel_threads;
+      std::unique_ptr<TableBuilder> builder(
+          options.table_factory->NewTableBuilder(
+              TableBuilderOptions(ioptions, moptions, ikc,
+                                  &int_tbl_prop_collector_factories,
+                                  compression_type, compression_opts,
+                                  nullptr /* compression_dict */,
+                                  false /* skip_filters */, column_family_name,
+                                  -1),
+              TablePropertiesCollectorFactory::Context::kUnknownColumnFamily,
+              file_writer.get()));
+      Random rnd(301);
+      for (int i = 0; i < 10000; ++i) {
+        InternalKey ik(key(i), 0, kTypeValue);
+        std::string value;
+        test::CompressibleString(&rnd, 0.5, 100, &value);
+        builder->Add(ik.Encode(), value);
+      }
+      EXPECT_OK(builder->Finish());
+      file_writer->Flush();
+      EXPECT_EQ(builder->FileSize(), sink->contents().size());
+      return sink->contents();
+    };
+
+    // Blocks are written in order, and the index and filter match them, so
+    // the file is the same as when compressing inline.
+    std::string serial_contents = build_table(1);
+    std::string parallel_contents = build_table(4);
+    ASSERT_EQ(serial_contents, parallel_contents);
+
+    std::unique_ptr<RandomAccessFileReader> file_reader(
+        test::GetRandomAccessFileReader(
+            new test::StringSource(parallel_contents, 0, false)));
+    std::unique_ptr<TableReader> table_reader;
+    ASSERT_OK(ioptions.table_factory->NewTableReader(
+        TableReaderOptions(ioptions, moptions.prefix_extractor.get(),
+                           EnvOptions(), ikc),
+        std::move(file_reader), parallel_contents.size(), &table_reader));
+    std::unique_ptr<InternalIterator> iter(table_reader->NewIterator(
+        ReadOptions(), moptions.prefix_extractor.get()));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(ExtractUserKey(iter->key()).ToString(), key(count));
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(10000, count);
+  }
+}
+
 TEST_P(BlockBasedTableTest, PropertiesBlockRestartPointTest) {
   BlockBasedTableOptions bbto = GetBlockBasedTableOptions();
   bbto.block_align = true;
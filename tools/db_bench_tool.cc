@@ -40,6 +40,7 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/cache.h"
+#include "rocksdb/compaction_service.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
@@ -49,6 +50,7 @@
 #include "rocksdb/perf_context.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/rate_limiter.h"
+#include "rocksdb/secondary_cache.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/utilities/object_registry.h"
@@ -279,6 +281,10 @@ DEFINE_double(read_random_exp_range, 0.0,
               "The larger the number is, the more skewed the reads are. "
               "Only used in readrandom and multireadrandom benchmarks.");
 
+DEFINE_bool(multiread_batched, false,
+            "Use the batched MultiGet API, which looks the keys up as a "
+            "batch, in multireadrandom");
+
 DEFINE_bool(histogram, false, "Print histogram of operation timings");
 
 DEFINE_bool(enable_numa, false,
@@ -295,6 +301,15 @@ DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
 DEFINE_bool(cost_write_buffer_to_cache, false,
             "The usage of memtable is costed to the block cache");
 
+DEFINE_bool(write_buffer_manager_allow_stall, false,
+            "Slow down the writes gradually once the memtables use more than "
+            "db_write_buffer_size");
+
+DEFINE_bool(write_buffer_manager_cost_aware_flush, false,
+            "When the memtables reach db_write_buffer_size, flush the column "
+            "family picked by memtable size, age and WAL retention instead of "
+            "the one with the oldest memtable");
+
 DEFINE_int64(write_buffer_size, rocksdb::Options().write_buffer_size,
              "Number of bytes to buffer in memtable before compacting");
 
@@ -359,6 +374,15 @@ static const bool FLAGS_subcompactions_dummy
     __attribute__((__unused__)) = RegisterFlagValidator(&FLAGS_subcompactions,
                                                     &ValidateUint32Range);
 
+DEFINE_int32(compaction_service_threads, 0,
+             "If positive, compactions are handed over to a compaction "
+             "service that runs them on this many threads of its own, as a "
+             "stand-in for a remote compaction executor");
+
+DEFINE_bool(compaction_service_bottommost_only, false,
+            "Only hand compactions into the bottommost level over to the "
+            "compaction service");
+
 DEFINE_int32(max_background_flushes,
              rocksdb::Options().max_background_flushes,
              "The maximum number of concurrent background flushes"
@@ -479,6 +503,13 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
+DEFINE_int64(secondary_cache_size, 0,
+             "If positive, data blocks evicted from the block cache are kept "
+             "compressed in a secondary cache tier of this many bytes.");
+
+DEFINE_string(secondary_cache_compression_type, "lz4",
+              "Algorithm used to compress blocks in the secondary cache.");
+
 DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
@@ -496,6 +527,17 @@ DEFINE_bool(new_table_reader_for_compaction_inputs, true,
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_bool(compaction_async_readahead, false,
+            "Read the next compaction input readahead window in the "
+            "background while the current one is merged");
+
+DEFINE_int32(readahead_size, 0,
+             "ReadOptions.readahead_size for readseq");
+
+DEFINE_bool(async_readahead, false,
+            "Read the next readahead window in the background during "
+            "readseq");
+
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
              "Maximum windows randomaccess buffer size");
 
@@ -794,6 +836,11 @@ DEFINE_int32(compression_zstd_max_train_bytes,
              "Maximum size of training data passed to zstd's dictionary "
              "trainer.");
 
+DEFINE_int32(compression_parallel_threads,
+             rocksdb::CompressionOptions().parallel_threads,
+             "Number of threads compressing the data blocks of each table "
+             "file being built.");
+
 DEFINE_int32(min_level_to_compress, -1, "If non-negative, compression starts"
              " from this level. Levels with number < min_level_to_compress are"
              " not compressed. Otherwise, apply compression_type to "
@@ -870,6 +917,20 @@ DEFINE_bool(enable_pipelined_write, true,
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_bool(unordered_write, false,
+            "Let each writer insert into the memtable after the WAL write of "
+            "its group, and publish writes before they are in the memtable. "
+            "Overrides enable_pipelined_write.");
+
+DEFINE_bool(atomic_flush, rocksdb::Options().atomic_flush,
+            "Flush the memtables of all the column families together, and "
+            "install the results atomically");
+
+DEFINE_bool(precompute_wal_checksums,
+            rocksdb::Options().precompute_wal_checksums,
+            "Let each writer checksum its batch before joining a write group, "
+            "and the group leader combine the checksums for the WAL record");
+
 DEFINE_bool(inplace_update_support, rocksdb::Options().inplace_update_support,
             "Support in-place memtable update for smaller or same-size values");
 
@@ -950,6 +1011,10 @@ DEFINE_bool(mmap_read, rocksdb::Options().allow_mmap_reads,
 DEFINE_bool(mmap_write, rocksdb::Options().allow_mmap_writes,
             "Allow writes to occur via mmap-ing files");
 
+DEFINE_bool(use_pmem_for_wal, rocksdb::Options().use_pmem_for_wal,
+            "Write the WAL through a memory mapping, synced with cache line "
+            "flushes when the file system supports MAP_SYNC");
+
 DEFINE_bool(use_direct_reads, rocksdb::Options().use_direct_reads,
             "Use O_DIRECT for reading data");
 
@@ -1041,7 +1106,8 @@ enum RepFactory {
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
-  kCuckoo
+  kCuckoo,
+  kBPlusTree
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1057,6 +1123,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kHashLinkedList;
   else if (!strcasecmp(ctype, "cuckoo"))
     return kCuckoo;
+  else if (!strcasecmp(ctype, "bplus_tree"))
+    return kBPlusTree;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1065,6 +1133,9 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
 static enum RepFactory FLAGS_rep_factory;
 DEFINE_string(memtablerep, "skip_list", "");
 DEFINE_int64(hash_bucket_count, 1024 * 1024, "hash bucket count");
+DEFINE_int32(memtable_shards, 0,
+             "If greater than 1, partition each memtable into this many "
+             "shards by the hash of the user key, with NewShardedRepFactory");
 DEFINE_bool(use_plain_table, false, "if use plain table "
             "instead of block-based table format");
 DEFINE_bool(use_cuckoo_table, false, "if use cuckoo table format");
@@ -1075,6 +1146,11 @@ DEFINE_bool(use_hash_search, false, "if use kHashSearch "
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
+DEFINE_int32(full_filter_format_version, 0,
+             "Format of the full filters built by the bloom filter policy. "
+             "0: cache line local Bloom filter, 1: split block Bloom filter, "
+             "2: Ribbon filter with the false positive rate of a Bloom filter "
+             "of bloom_bits");
 DEFINE_string(merge_operator, "", "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
               " database The possible merge operators are defined in"
@@ -2081,6 +2157,9 @@ class Benchmark {
       case kCuckoo:
         fprintf(stdout, "Memtablerep: cuckoo\n");
         break;
+      case kBPlusTree:
+        fprintf(stdout, "Memtablerep: bplus_tree\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2216,7 +2295,8 @@ class Benchmark {
     virtual const char* Name() const override { return "KeepFilter"; }
   };
 
-  std::shared_ptr<Cache> NewCache(int64_t capacity) {
+  std::shared_ptr<Cache> NewCache(int64_t capacity,
+                                  int64_t secondary_cache_capacity = 0) {
     if (capacity <= 0) {
       return nullptr;
     }
@@ -2228,19 +2308,28 @@ class Benchmark {
       }
       return cache;
     } else {
-      return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
-                         false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+      LRUCacheOptions opts((size_t)capacity, FLAGS_cache_numshardbits,
+                           false /*strict_capacity_limit*/,
+                           FLAGS_cache_high_pri_pool_ratio);
+      if (secondary_cache_capacity > 0) {
+        opts.secondary_cache =
+            NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
+                (size_t)secondary_cache_capacity, FLAGS_cache_numshardbits,
+                StringToCompressionType(
+                    FLAGS_secondary_cache_compression_type.c_str())));
+      }
+      return NewLRUCache(opts);
     }
   }
 
  public:
   Benchmark()
-      : cache_(NewCache(FLAGS_cache_size)),
+      : cache_(NewCache(FLAGS_cache_size, FLAGS_secondary_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
         filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
+                           ? NewBloomFilterPolicy(
+                                 FLAGS_bloom_bits, FLAGS_use_block_based_filter,
+                                 FLAGS_full_filter_format_version)
                            : nullptr),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
@@ -2896,7 +2985,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
   void Crc32c(ThreadState* thread) {
     // Checksum about 500MB of data total
     const int size = FLAGS_block_size; // use --block_size option for db_bench
-    std::string labels = "(" + ToString(FLAGS_block_size) + " per op)";
+    std::string labels = "(" + ToString(FLAGS_block_size) + " per op, " +
+                         crc32c::IsFastCrc32Supported() + ")";
     const char* label = labels.c_str();
 
     std::string data(size, 'x');
@@ -3084,8 +3174,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
 
     options.max_open_files = FLAGS_open_files;
     if (FLAGS_cost_write_buffer_to_cache || FLAGS_db_write_buffer_size != 0) {
-      options.write_buffer_manager.reset(
-          new WriteBufferManager(FLAGS_db_write_buffer_size, cache_));
+      options.write_buffer_manager.reset(new WriteBufferManager(
+          FLAGS_db_write_buffer_size, cache_,
+          FLAGS_write_buffer_manager_allow_stall,
+          FLAGS_write_buffer_manager_cost_aware_flush
+              ? WriteBufferFlushPolicy::kCostAware
+              : WriteBufferFlushPolicy::kOldestMemtable));
     }
     options.write_buffer_size = FLAGS_write_buffer_size;
     options.max_write_buffer_number = FLAGS_max_write_buffer_number;
@@ -3101,6 +3195,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.compaction_pri = FLAGS_compaction_pri_e;
     options.allow_mmap_reads = FLAGS_mmap_read;
     options.allow_mmap_writes = FLAGS_mmap_write;
+    options.use_pmem_for_wal = FLAGS_use_pmem_for_wal;
     options.use_direct_reads = FLAGS_use_direct_reads;
     options.use_direct_io_for_flush_and_compaction =
         FLAGS_use_direct_io_for_flush_and_compaction;
@@ -3135,6 +3230,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.compaction_async_readahead = FLAGS_compaction_async_readahead;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
     options.use_fsync = FLAGS_use_fsync;
@@ -3175,12 +3271,22 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         options.memtable_factory.reset(NewHashCuckooRepFactory(
             options.write_buffer_size, FLAGS_key_size + FLAGS_value_size));
         break;
+      case kBPlusTree:
+        options.memtable_factory.reset(new BPlusTreeFactory);
+        break;
 #else
       default:
         fprintf(stderr, "Only skip list is supported in lite mode\n");
         exit(1);
 #endif  // ROCKSDB_LITE
     }
+#ifndef ROCKSDB_LITE
+    if (FLAGS_memtable_shards > 1) {
+      options.memtable_factory.reset(NewShardedRepFactory(
+          options.memtable_factory,
+          static_cast<size_t>(FLAGS_memtable_shards)));
+    }
+#endif  // ROCKSDB_LITE
     if (FLAGS_use_plain_table) {
 #ifndef ROCKSDB_LITE
       if (FLAGS_rep_factory != kPrefixHash &&
@@ -3370,7 +3476,11 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.inplace_update_num_locks = FLAGS_inplace_update_num_locks;
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
-    options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.enable_pipelined_write =
+        FLAGS_enable_pipelined_write && !FLAGS_unordered_write;
+    options.unordered_write = FLAGS_unordered_write;
+    options.atomic_flush = FLAGS_atomic_flush;
+    options.precompute_wal_checksums = FLAGS_precompute_wal_checksums;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.rate_limit_delay_max_milliseconds =
@@ -3449,6 +3559,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
     options.compression_opts.zstd_max_train_bytes =
         FLAGS_compression_zstd_max_train_bytes;
+    options.compression_opts.parallel_threads =
+        FLAGS_compression_parallel_threads;
     // If this is a block based table, set some related options
     if (options.table_factory->Name() == BlockBasedTableFactory::kName &&
         options.table_factory->GetOptions() != nullptr) {
@@ -3460,7 +3572,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       }
       if (FLAGS_bloom_bits >= 0) {
         table_options->filter_policy.reset(NewBloomFilterPolicy(
-            FLAGS_bloom_bits, FLAGS_use_block_based_filter));
+            FLAGS_bloom_bits, FLAGS_use_block_based_filter,
+            FLAGS_full_filter_format_version));
       }
     }
     if (FLAGS_row_cache_size) {
@@ -3500,6 +3613,15 @@ void VerifyDBFromDB(std::string& truth_db_name) {
           FLAGS_rate_limiter_auto_tuned));
     }
 
+#ifndef ROCKSDB_LITE
+    if (FLAGS_compaction_service_threads > 0) {
+      // Last, as the service opens the DB with a copy of these options
+      options.compaction_service = NewThreadPoolCompactionService(
+          options, FLAGS_compaction_service_threads,
+          FLAGS_compaction_service_bottommost_only);
+    }
+#endif  // ROCKSDB_LITE
+
     if (FLAGS_num_multi_db <= 1) {
       OpenDb(options, FLAGS_db, &db_);
     } else {
@@ -4218,6 +4340,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.readahead_size = FLAGS_readahead_size;
+    options.async_readahead = FLAGS_async_readahead;
 
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
@@ -4415,6 +4539,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]> > key_guards;
     std::vector<std::string> values(entries_per_batch_);
+    std::vector<PinnableSlice> pin_values(entries_per_batch_);
+    std::vector<Status> statuses(entries_per_batch_);
     while (static_cast<int64_t>(keys.size()) < entries_per_batch_) {
       key_guards.push_back(std::unique_ptr<const char[]>());
       keys.push_back(AllocateKey(&key_guards.back()));
@@ -4426,7 +4552,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       for (int64_t i = 0; i < entries_per_batch_; ++i) {
         GenerateKeyFromInt(GetRandomKey(&thread->rand), FLAGS_num, &keys[i]);
       }
-      std::vector<Status> statuses = db->MultiGet(options, keys, &values);
+      if (FLAGS_multiread_batched) {
+        db->MultiGet(options, db->DefaultColumnFamily(), keys.size(),
+                     keys.data(), pin_values.data(), statuses.data());
+      } else {
+        statuses = db->MultiGet(options, keys, &values);
+      }
       assert(static_cast<int64_t>(statuses.size()) == entries_per_batch_);
 
       read += entries_per_batch_;
@@ -9,6 +9,12 @@
 
 #include "rocksdb/filter_policy.h"
 
+#include <algorithm>
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "rocksdb/slice.h"
 #include "table/block_based_filter_block.h"
 #include "table/full_filter_bits_builder.h"
@@ -21,6 +27,120 @@ namespace rocksdb {
 class BlockBasedFilterBlockBuilder;
 class FullFilterBlockBuilder;
 
+namespace {
+// Full filters in a format newer than the original one end with
+//   format_version (1 byte) | kNewFormatMarker (1 byte) | 0 (4 bytes)
+// where the original format has num_probes (at most 30) and num_lines.
+const char kNewFormatMarker = -1;
+const uint32_t kNewFormatTrailerSize = 6;
+const char kSplitBlockFormatVersion = 1;
+
+// Odd constants that pick a bit out of each of the 8 words of a block
+const uint32_t kSplitBlockSalts[SplitBlockBloomBitsBuilder::kNumProbes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+inline uint32_t SplitBlockIndex(uint32_t hash, uint32_t num_blocks) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(hash) * num_blocks) >>
+                               32);
+}
+
+// The block index takes the high bits of the key hash, which keys sharing a
+// block have in common, so the bits within the block are chosen from a
+// remix of the whole hash.
+inline uint32_t SplitBlockProbeHash(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+// Ribbon filters have the num_result_bits (1 byte) and the seed (1 byte)
+// ahead of the trailer of the newer formats
+const char kRibbonFormatVersion = 2;
+const uint32_t kRibbonTrailerSize = kNewFormatTrailerSize + 2;
+// Seeds past this give up on building the filter
+const uint32_t kRibbonMaxSeed = 63;
+
+// 64 bits of hash of the key, the upper half of which is its BloomHash
+inline uint64_t RibbonHash(const Slice& key) {
+  return (static_cast<uint64_t>(BloomHash(key)) << 32) |
+         Hash(key.data(), key.size(), 0x7b8a1c45);
+}
+
+// Remixes a key hash for a seed with the splitmix64 finalizer, so that
+// retrying with another seed does not rehash the keys
+inline uint64_t RibbonRemix(uint64_t hash, uint32_t seed) {
+  hash += (seed + 1) * 0x9e3779b97f4a7c15ULL;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+  return hash ^ (hash >> 31);
+}
+
+// The slot of the first coefficient of a remixed hash, among num_starts
+inline uint32_t RibbonStart(uint64_t hash, uint32_t num_starts) {
+  return static_cast<uint32_t>(((hash >> 32) * num_starts) >> 32);
+}
+
+inline uint64_t RibbonCoeffRow(uint64_t hash) {
+  uint64_t row = (hash ^ (hash >> 29)) * 0xbf58476d1ce4e5b9ULL;
+  // The first coefficient is always set, so rows can be eliminated in
+  // order of their start
+  return (row ^ (row >> 32)) | 1;
+}
+
+inline uint32_t RibbonResult(uint64_t hash, uint32_t num_result_bits) {
+  return static_cast<uint32_t>(hash) & ((1U << num_result_bits) - 1);
+}
+
+// The slots needed for num_entry keys. The slots per key for banding to
+// likely succeed grow with log(num_entry): 1.06 for a thousand keys and 1.12
+// for a million.
+inline uint32_t RibbonNumSlots(int num_entry) {
+  const uint32_t kCoeffBits = RibbonFilterBitsBuilder::kCoeffBits;
+  if (num_entry <= 0) {
+    return 0;
+  }
+  const double slots_per_key =
+      1.0 + 0.006 * std::log2(static_cast<double>(num_entry));
+  uint64_t num_slots = static_cast<uint64_t>(num_entry * slots_per_key) +
+                       2 * kCoeffBits - 1;
+  num_slots -= num_slots % kCoeffBits;
+  return static_cast<uint32_t>(std::max<uint64_t>(num_slots, 2 * kCoeffBits));
+}
+
+inline uint32_t Parity64(uint64_t x) {
+#ifdef __GNUC__
+  return static_cast<uint32_t>(__builtin_parityll(x));
+#else
+  x ^= x >> 32;
+  x ^= x >> 16;
+  x ^= x >> 8;
+  x ^= x >> 4;
+  x ^= x >> 2;
+  x ^= x >> 1;
+  return static_cast<uint32_t>(x & 1);
+#endif
+}
+
+// REQUIRES: x != 0
+inline uint32_t CountTrailingZeros64(uint64_t x) {
+  assert(x != 0);
+#ifdef __GNUC__
+  return static_cast<uint32_t>(__builtin_ctzll(x));
+#else
+  uint32_t n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+}  // namespace
+
 FullFilterBitsBuilder::FullFilterBitsBuilder(const size_t bits_per_key,
                                              const size_t num_probes)
     : bits_per_key_(bits_per_key), num_probes_(num_probes) {
@@ -137,6 +257,227 @@ inline void FullFilterBitsBuilder::AddHash(uint32_t h, char* data,
   }
 }
 
+SplitBlockBloomBitsBuilder::SplitBlockBloomBitsBuilder(
+    const size_t bits_per_key)
+    : bits_per_key_(bits_per_key) {
+  assert(bits_per_key_);
+}
+
+SplitBlockBloomBitsBuilder::~SplitBlockBloomBitsBuilder() {}
+
+void SplitBlockBloomBitsBuilder::AddKey(const Slice& key) {
+  uint32_t hash = BloomHash(key);
+  if (hash_entries_.size() == 0 || hash != hash_entries_.back()) {
+    hash_entries_.push_back(hash);
+  }
+}
+
+Slice SplitBlockBloomBitsBuilder::Finish(std::unique_ptr<const char[]>* buf) {
+  uint32_t num_blocks;
+  uint32_t sz = CalculateSpace(static_cast<int>(hash_entries_.size()),
+                               &num_blocks);
+  char* data = new char[sz];
+  memset(data, 0, sz);
+
+  for (auto h : hash_entries_) {
+    char* block = data + SplitBlockIndex(h, num_blocks) * kBlockSize;
+    const uint32_t probe_hash = SplitBlockProbeHash(h);
+    for (uint32_t i = 0; i < kNumProbes; ++i) {
+      char* word = block + i * sizeof(uint32_t);
+      EncodeFixed32(word, DecodeFixed32(word) |
+                              (1U << ((probe_hash * kSplitBlockSalts[i]) >>
+                                      27)));
+    }
+  }
+  data[sz - kNewFormatTrailerSize] = kSplitBlockFormatVersion;
+  data[sz - 5] = kNewFormatMarker;
+  EncodeFixed32(data + sz - 4, 0);
+
+  const char* const_data = data;
+  buf->reset(const_data);
+  hash_entries_.clear();
+
+  return Slice(data, sz);
+}
+
+uint32_t SplitBlockBloomBitsBuilder::CalculateSpace(const int num_entry,
+                                                    uint32_t* num_blocks) {
+  assert(bits_per_key_);
+  if (num_entry != 0) {
+    uint64_t total_bits = static_cast<uint64_t>(num_entry) * bits_per_key_;
+    *num_blocks = static_cast<uint32_t>((total_bits + kBlockSize * 8 - 1) /
+                                        (kBlockSize * 8));
+  } else {
+    // filter is empty, just leave space for metadata
+    *num_blocks = 0;
+  }
+  return *num_blocks * kBlockSize + kNewFormatTrailerSize;
+}
+
+int SplitBlockBloomBitsBuilder::CalculateNumEntry(const uint32_t space) {
+  assert(bits_per_key_);
+  if (space <= kNewFormatTrailerSize) {
+    return 0;
+  }
+  uint64_t num_blocks = (space - kNewFormatTrailerSize) / kBlockSize;
+  return static_cast<int>(num_blocks * kBlockSize * 8 / bits_per_key_);
+}
+
+RibbonFilterBitsBuilder::RibbonFilterBitsBuilder(
+    const uint32_t num_result_bits)
+    : num_result_bits_(num_result_bits) {
+  assert(num_result_bits_ >= 1 && num_result_bits_ <= kMaxResultBits);
+}
+
+RibbonFilterBitsBuilder::~RibbonFilterBitsBuilder() {}
+
+void RibbonFilterBitsBuilder::AddKey(const Slice& key) {
+  uint64_t hash = RibbonHash(key);
+  if (hash_entries_.size() == 0 || hash != hash_entries_.back()) {
+    hash_entries_.push_back(hash);
+  }
+}
+
+bool RibbonFilterBitsBuilder::Band(uint32_t num_slots, uint32_t seed,
+                                   uint64_t* coeff_rows,
+                                   uint16_t* result_rows) const {
+  const uint32_t num_starts = num_slots - kCoeffBits + 1;
+  for (auto hash : hash_entries_) {
+    const uint64_t h = RibbonRemix(hash, seed);
+    uint32_t i = RibbonStart(h, num_starts);
+    uint64_t row = RibbonCoeffRow(h);
+    uint32_t result = RibbonResult(h, num_result_bits_);
+    while (true) {
+      assert(i < num_slots);
+      if (coeff_rows[i] == 0) {
+        coeff_rows[i] = row;
+        result_rows[i] = static_cast<uint16_t>(result);
+        break;
+      }
+      // Eliminate the first coefficient with the row already starting there
+      row ^= coeff_rows[i];
+      result ^= result_rows[i];
+      if (row == 0) {
+        // The equation of the key is a sum of those of other keys, which is
+        // fine, e.g. for keys of the same hash, unless it contradicts them
+        if (result != 0) {
+          return false;
+        }
+        break;
+      }
+      const uint32_t shift = CountTrailingZeros64(row);
+      i += shift;
+      row >>= shift;
+    }
+  }
+  return true;
+}
+
+Slice RibbonFilterBitsBuilder::Finish(std::unique_ptr<const char[]>* buf) {
+  uint32_t num_slots;
+  CalculateSpace(static_cast<int>(hash_entries_.size()), &num_slots);
+
+  std::vector<uint64_t> coeff_rows;
+  std::vector<uint16_t> result_rows;
+  bool banded = false;
+  uint32_t seed = 0;
+  for (; num_slots > 0; ++seed) {
+    coeff_rows.assign(num_slots, 0);
+    result_rows.assign(num_slots, 0);
+    if (Band(num_slots, seed, coeff_rows.data(), result_rows.data())) {
+      banded = true;
+      break;
+    }
+    if (seed == kRibbonMaxSeed) {
+      break;
+    }
+    if (seed % 2 == 1) {
+      // Give every other retry about 6% more slots
+      num_slots += std::max(num_slots / 16 / kCoeffBits, 1U) * kCoeffBits;
+    }
+  }
+  // A filter that could not be built matches every key
+  assert(banded || hash_entries_.empty());
+  const uint32_t num_result_bits =
+      banded || hash_entries_.empty() ? num_result_bits_ : 0;
+  const uint32_t num_blocks = banded ? num_slots / kCoeffBits : 0;
+  const uint32_t block_size =
+      num_result_bits * static_cast<uint32_t>(sizeof(uint64_t));
+  const uint32_t sz = num_blocks * block_size + kRibbonTrailerSize;
+  char* data = new char[sz];
+
+  if (banded) {
+    // Back substitution, from the last slot to the first. After solving slot
+    // i, bit k of state[j] is result bit j of slot i + k.
+    uint64_t state[kMaxResultBits] = {0};
+    for (uint32_t i = num_slots; i-- > 0;) {
+      const uint64_t row = coeff_rows[i];
+      // No key's row starts at an empty slot, so any result does. A
+      // pseudorandom one rather than 0 keeps the false positive rate of
+      // keys whose rows select such slots at 2^-num_result_bits.
+      const uint32_t result = row != 0
+                                  ? result_rows[i]
+                                  : RibbonResult(RibbonRemix(i, seed),
+                                                 num_result_bits);
+      for (uint32_t j = 0; j < num_result_bits; ++j) {
+        // The first coefficient of the row selects slot i, which is 0 yet
+        state[j] <<= 1;
+        state[j] |= ((result >> j) & 1) ^ Parity64(row & state[j]);
+      }
+      if (i % kCoeffBits == 0) {
+        char* block = data + (i / kCoeffBits) * block_size;
+        for (uint32_t j = 0; j < num_result_bits; ++j) {
+          EncodeFixed64(block + j * sizeof(uint64_t), state[j]);
+        }
+      }
+    }
+  }
+  data[sz - kRibbonTrailerSize] = static_cast<char>(num_result_bits);
+  data[sz - kRibbonTrailerSize + 1] = static_cast<char>(seed);
+  data[sz - kNewFormatTrailerSize] = kRibbonFormatVersion;
+  data[sz - 5] = kNewFormatMarker;
+  EncodeFixed32(data + sz - 4, 0);
+
+  const char* const_data = data;
+  buf->reset(const_data);
+  hash_entries_.clear();
+
+  return Slice(data, sz);
+}
+
+uint32_t RibbonFilterBitsBuilder::CalculateSpace(const int num_entry,
+                                                 uint32_t* num_slots) {
+  *num_slots = RibbonNumSlots(num_entry);
+  return *num_slots / kCoeffBits * num_result_bits_ *
+             static_cast<uint32_t>(sizeof(uint64_t)) +
+         kRibbonTrailerSize;
+}
+
+int RibbonFilterBitsBuilder::CalculateNumEntry(const uint32_t space) {
+  if (space < kRibbonTrailerSize) {
+    return 0;
+  }
+  const uint32_t num_blocks = (space - kRibbonTrailerSize) /
+                              (num_result_bits_ * sizeof(uint64_t));
+  if (num_blocks < 2) {
+    return 0;
+  }
+  // The largest number of keys that fit, which is less than the slots
+  int low = 0;
+  int high = static_cast<int>(
+      std::min<uint64_t>(uint64_t{num_blocks} * kCoeffBits, port::kMaxInt32));
+  uint32_t dont_care;
+  while (low < high) {
+    int mid = low + (high - low + 1) / 2;
+    if (CalculateSpace(mid, &dont_care) <= space) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
 namespace {
 class FullFilterBitsReader : public FilterBitsReader {
  public:
@@ -185,6 +526,31 @@ class FullFilterBitsReader : public FilterBitsReader {
                         num_probes_, num_lines_);
   }
 
+  virtual void BatchMayMatch(int num_keys, const Slice* const* keys,
+                             bool* may_match) override {
+    if (data_len_ <= 5 || num_probes_ == 0 || num_lines_ == 0) {
+      for (int i = 0; i < num_keys; ++i) {
+        may_match[i] = data_len_ > 5;
+      }
+      return;
+    }
+    // Hash all the keys and prefetch their cache lines before probing any
+    const int kBatch = 32;
+    uint32_t hashes[kBatch];
+    for (int start = 0; start < num_keys; start += kBatch) {
+      int n = std::min(kBatch, num_keys - start);
+      for (int i = 0; i < n; ++i) {
+        hashes[i] = BloomHash(*keys[start + i]);
+        PREFETCH(data_ + ((hashes[i] % num_lines_) << log2_cache_line_size_),
+                 0 /* rw */, 1 /* locality */);
+      }
+      for (int i = 0; i < n; ++i) {
+        may_match[start + i] = HashMayMatch(
+            hashes[i], Slice(data_, data_len_), num_probes_, num_lines_);
+      }
+    }
+  }
+
  private:
   // Filter meta data
   char* data_;
@@ -265,12 +631,195 @@ bool FullFilterBitsReader::HashMayMatch(const uint32_t& hash,
   return true;
 }
 
+// Reads filters built by SplitBlockBloomBitsBuilder
+class SplitBlockBloomBitsReader : public FilterBitsReader {
+ public:
+  // `blocks` is the filter without its trailer
+  explicit SplitBlockBloomBitsReader(const Slice& blocks)
+      : data_(blocks.data()),
+        num_blocks_(static_cast<uint32_t>(
+            blocks.size() / SplitBlockBloomBitsBuilder::kBlockSize)) {}
+
+  ~SplitBlockBloomBitsReader() {}
+
+  virtual bool MayMatch(const Slice& entry) override {
+    if (num_blocks_ == 0) {
+      return false;
+    }
+    uint32_t hash = BloomHash(entry);
+    return HashMayMatch(BlockFor(hash), SplitBlockProbeHash(hash));
+  }
+
+  virtual void BatchMayMatch(int num_keys, const Slice* const* keys,
+                             bool* may_match) override {
+    if (num_blocks_ == 0) {
+      for (int i = 0; i < num_keys; ++i) {
+        may_match[i] = false;
+      }
+      return;
+    }
+    // Hash all the keys and prefetch their blocks before probing any
+    const int kBatch = 32;
+    const char* blocks[kBatch];
+    uint32_t probe_hashes[kBatch];
+    for (int start = 0; start < num_keys; start += kBatch) {
+      int n = std::min(kBatch, num_keys - start);
+      for (int i = 0; i < n; ++i) {
+        uint32_t hash = BloomHash(*keys[start + i]);
+        blocks[i] = BlockFor(hash);
+        probe_hashes[i] = SplitBlockProbeHash(hash);
+        PREFETCH(blocks[i], 0 /* rw */, 1 /* locality */);
+      }
+      for (int i = 0; i < n; ++i) {
+        may_match[start + i] = HashMayMatch(blocks[i], probe_hashes[i]);
+      }
+    }
+  }
+
+ private:
+  const char* data_;
+  uint32_t num_blocks_;
+
+  const char* BlockFor(uint32_t hash) const {
+    return data_ + SplitBlockIndex(hash, num_blocks_) *
+                       SplitBlockBloomBitsBuilder::kBlockSize;
+  }
+
+  static bool HashMayMatch(const char* block, uint32_t probe_hash) {
+#ifdef __AVX2__
+    // The words are stored little-endian, as x86 loads them
+    const __m256i salts = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(kSplitBlockSalts));
+    const __m256i bit_index = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_set1_epi32(probe_hash), salts), 27);
+    const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bit_index);
+    const __m256i bits =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    // All of mask is set in bits
+    return _mm256_testc_si256(bits, mask) != 0;
+#else
+    for (uint32_t i = 0; i < SplitBlockBloomBitsBuilder::kNumProbes; ++i) {
+      uint32_t bit = 1U << ((probe_hash * kSplitBlockSalts[i]) >> 27);
+      if ((DecodeFixed32(block + i * sizeof(uint32_t)) & bit) == 0) {
+        return false;
+      }
+    }
+    return true;
+#endif
+  }
+
+  // No Copy allowed
+  SplitBlockBloomBitsReader(const SplitBlockBloomBitsReader&);
+  void operator=(const SplitBlockBloomBitsReader&);
+};
+
+// Reads filters built by RibbonFilterBitsBuilder
+class RibbonFilterBitsReader : public FilterBitsReader {
+ public:
+  // `blocks` is the filter without its trailer
+  RibbonFilterBitsReader(const Slice& blocks, uint32_t num_result_bits,
+                         uint32_t seed)
+      : data_(blocks.data()),
+        num_result_bits_(num_result_bits),
+        seed_(seed),
+        block_size_(num_result_bits * static_cast<uint32_t>(sizeof(uint64_t))),
+        num_starts_(0) {
+    const uint32_t num_blocks =
+        static_cast<uint32_t>(blocks.size() / block_size_);
+    if (num_blocks > 0) {
+      num_starts_ = num_blocks * kCoeffBits - kCoeffBits + 1;
+    }
+  }
+
+  ~RibbonFilterBitsReader() {}
+
+  virtual bool MayMatch(const Slice& entry) override {
+    if (num_starts_ == 0) {
+      return false;
+    }
+    return HashMayMatch(RibbonRemix(RibbonHash(entry), seed_));
+  }
+
+  virtual void BatchMayMatch(int num_keys, const Slice* const* keys,
+                             bool* may_match) override {
+    if (num_starts_ == 0) {
+      for (int i = 0; i < num_keys; ++i) {
+        may_match[i] = false;
+      }
+      return;
+    }
+    // Hash all the keys and prefetch their blocks before probing any
+    const int kBatch = 32;
+    uint64_t hashes[kBatch];
+    for (int start = 0; start < num_keys; start += kBatch) {
+      int n = std::min(kBatch, num_keys - start);
+      for (int i = 0; i < n; ++i) {
+        hashes[i] = RibbonRemix(RibbonHash(*keys[start + i]), seed_);
+        const char* block = BlockFor(hashes[i]);
+        PREFETCH(block, 0 /* rw */, 1 /* locality */);
+        PREFETCH(block + 2 * block_size_ - 1, 0 /* rw */, 1 /* locality */);
+      }
+      for (int i = 0; i < n; ++i) {
+        may_match[start + i] = HashMayMatch(hashes[i]);
+      }
+    }
+  }
+
+ private:
+  static const uint32_t kCoeffBits = RibbonFilterBitsBuilder::kCoeffBits;
+
+  const char* data_;
+  uint32_t num_result_bits_;
+  uint32_t seed_;
+  uint32_t block_size_;
+  uint32_t num_starts_;
+
+  const char* BlockFor(uint64_t hash) const {
+    return data_ + RibbonStart(hash, num_starts_) / kCoeffBits * block_size_;
+  }
+
+  // hash: the remixed hash of the key
+  bool HashMayMatch(uint64_t hash) const {
+    const uint32_t start = RibbonStart(hash, num_starts_);
+    const uint64_t row = RibbonCoeffRow(hash);
+    const uint32_t shift = start % kCoeffBits;
+    const char* block = data_ + start / kCoeffBits * block_size_;
+    uint32_t result = 0;
+    for (uint32_t j = 0; j < num_result_bits_; ++j) {
+      // Result bit j of the slots from start on. A row starting past the
+      // first slot of a block takes the rest of its slots from the next one,
+      // which there always is.
+      uint64_t slots = DecodeFixed64(block + j * sizeof(uint64_t)) >> shift;
+      if (shift != 0) {
+        slots |= DecodeFixed64(block + block_size_ + j * sizeof(uint64_t))
+                 << (kCoeffBits - shift);
+      }
+      result |= Parity64(row & slots) << j;
+    }
+    return result == RibbonResult(hash, num_result_bits_);
+  }
+
+  // No Copy allowed
+  RibbonFilterBitsReader(const RibbonFilterBitsReader&);
+  void operator=(const RibbonFilterBitsReader&);
+};
+
+// Reader for full filters of a format this version does not know
+class AlwaysTrueFilterBitsReader : public FilterBitsReader {
+ public:
+  virtual bool MayMatch(const Slice& /*entry*/) override { return true; }
+};
+
 // An implementation of filter policy
 class BloomFilterPolicy : public FilterPolicy {
  public:
-  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder)
+  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder,
+                             int full_filter_format_version,
+                             int ribbon_start_level = 0)
       : bits_per_key_(bits_per_key), hash_func_(BloomHash),
-        use_block_based_builder_(use_block_based_builder) {
+        use_block_based_builder_(use_block_based_builder),
+        full_filter_format_version_(full_filter_format_version),
+        ribbon_start_level_(ribbon_start_level) {
     initialize();
   }
 
@@ -342,11 +891,56 @@ class BloomFilterPolicy : public FilterPolicy {
       return nullptr;
     }
 
+    if (full_filter_format_version_ == kSplitBlockFormatVersion) {
+      return new SplitBlockBloomBitsBuilder(bits_per_key_);
+    }
+    if (full_filter_format_version_ == kRibbonFormatVersion) {
+      return new RibbonFilterBitsBuilder(ribbon_result_bits_);
+    }
     return new FullFilterBitsBuilder(bits_per_key_, num_probes_);
   }
 
+  virtual FilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext& context) const override {
+    if (!use_block_based_builder_ &&
+        full_filter_format_version_ == kRibbonFormatVersion &&
+        context.level_at_creation >= 0 &&
+        context.level_at_creation < ribbon_start_level_) {
+      return new FullFilterBitsBuilder(bits_per_key_, num_probes_);
+    }
+    return GetFilterBitsBuilder();
+  }
+
   virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
       const override {
+    const size_t len = contents.size();
+    if (len >= kNewFormatTrailerSize && contents[len - 5] == kNewFormatMarker &&
+        DecodeFixed32(contents.data() + len - 4) == 0) {
+      const size_t blocks_len = len - kNewFormatTrailerSize;
+      if (contents[blocks_len] == kSplitBlockFormatVersion &&
+          blocks_len % SplitBlockBloomBitsBuilder::kBlockSize == 0) {
+        return new SplitBlockBloomBitsReader(
+            Slice(contents.data(), blocks_len));
+      }
+      if (contents[blocks_len] == kRibbonFormatVersion &&
+          len >= kRibbonTrailerSize) {
+        const size_t solution_len = len - kRibbonTrailerSize;
+        const uint32_t num_result_bits =
+            static_cast<unsigned char>(contents[solution_len]);
+        const uint32_t seed =
+            static_cast<unsigned char>(contents[solution_len + 1]);
+        const size_t block_size = num_result_bits * sizeof(uint64_t);
+        // A filter of keys has at least two blocks
+        if (num_result_bits >= 1 &&
+            num_result_bits <= RibbonFilterBitsBuilder::kMaxResultBits &&
+            solution_len % block_size == 0 && solution_len != block_size) {
+          return new RibbonFilterBitsReader(
+              Slice(contents.data(), solution_len), num_result_bits, seed);
+        }
+      }
+      // Written by a newer version, or corrupted
+      return new AlwaysTrueFilterBitsReader();
+    }
     return new FullFilterBitsReader(contents);
   }
 
@@ -359,20 +953,43 @@ class BloomFilterPolicy : public FilterPolicy {
   uint32_t (*hash_func_)(const Slice& key);
 
   const bool use_block_based_builder_;
+  const int full_filter_format_version_;
+  // Tables of lower levels get format 0 filters rather than Ribbon filters
+  const int ribbon_start_level_;
+  uint32_t ribbon_result_bits_;
 
   void initialize() {
     // We intentionally round down to reduce probing cost a little bit
     num_probes_ = static_cast<size_t>(bits_per_key_ * 0.69);  // 0.69 =~ ln(2)
     if (num_probes_ < 1) num_probes_ = 1;
     if (num_probes_ > 30) num_probes_ = 30;
+
+    // Ribbon filters match a key that was not added with probability
+    // 2^-result_bits, so take the least that is not above the false positive
+    // rate of a Bloom filter of bits_per_key_ and num_probes_.
+    const double bloom_fp_rate = std::pow(
+        1.0 - std::exp(-static_cast<double>(num_probes_) / bits_per_key_),
+        static_cast<double>(num_probes_));
+    const double result_bits = std::ceil(-std::log2(bloom_fp_rate) - 0.01);
+    ribbon_result_bits_ = static_cast<uint32_t>(std::min<double>(
+        std::max(result_bits, 1.0), RibbonFilterBitsBuilder::kMaxResultBits));
   }
 };
 
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-                                         bool use_block_based_builder) {
-  return new BloomFilterPolicy(bits_per_key, use_block_based_builder);
+                                         bool use_block_based_builder,
+                                         int full_filter_format_version) {
+  return new BloomFilterPolicy(bits_per_key, use_block_based_builder,
+                               full_filter_format_version);
+}
+
+const FilterPolicy* NewRibbonFilterPolicy(int bloom_equivalent_bits_per_key,
+                                          int ribbon_start_level) {
+  return new BloomFilterPolicy(bloom_equivalent_bits_per_key,
+                               false /* use_block_based_builder */,
+                               kRibbonFormatVersion, ribbon_start_level);
 }
 
 }  // namespace rocksdb
@@ -192,6 +192,13 @@ class FullBloomTest : public testing::Test {
     Reset();
   }
 
+  void SetFormatVersion(int full_filter_format_version) {
+    delete policy_;
+    policy_ = NewBloomFilterPolicy(FLAGS_bits_per_key, false,
+                                   full_filter_format_version);
+    Reset();
+  }
+
   ~FullBloomTest() {
     delete policy_;
   }
@@ -228,6 +235,30 @@ class FullBloomTest : public testing::Test {
     return bits_reader_->MayMatch(s);
   }
 
+  // Checks that the batched probe agrees with the single key one
+  void CheckBatchMatches(const std::vector<std::string>& keys) {
+    if (bits_reader_ == nullptr) {
+      Build();
+    }
+    std::vector<Slice> slices(keys.begin(), keys.end());
+    std::vector<const Slice*> key_ptrs;
+    for (const auto& slice : slices) {
+      key_ptrs.push_back(&slice);
+    }
+    std::unique_ptr<bool[]> may_match(new bool[keys.size()]);
+    bits_reader_->BatchMayMatch(static_cast<int>(keys.size()),
+                                key_ptrs.data(), may_match.get());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ASSERT_EQ(bits_reader_->MayMatch(keys[i]), may_match[i]) << keys[i];
+    }
+  }
+
+  Slice Filter() const { return Slice(buf_.get(), filter_size_); }
+
+  FilterBitsReader* NewReader(const Slice& filter) const {
+    return policy_->GetFilterBitsReader(filter);
+  }
+
   double FalsePositiveRate() {
     char buffer[sizeof(int)];
     int result = 0;
@@ -309,6 +340,205 @@ TEST_F(FullBloomTest, FullVaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters/5);
 }
 
+TEST_F(FullBloomTest, BatchMayMatch) {
+  char buffer[sizeof(int)];
+  for (int format_version : {0, 1, 2}) {
+    SetFormatVersion(format_version);
+    CheckBatchMatches({"hello"});
+    for (int i = 0; i < 1000; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+    std::vector<std::string> keys;
+    for (int i = 0; i < 2000; i += 3) {
+      keys.push_back(Key(i, buffer).ToString());
+    }
+    CheckBatchMatches(keys);
+  }
+}
+
+TEST_F(FullBloomTest, SplitBlockSmall) {
+  SetFormatVersion(1);
+  ASSERT_TRUE(!Matches("hello"));
+  Reset();
+  Add("hello");
+  Add("world");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  ASSERT_TRUE(!Matches("x"));
+  ASSERT_TRUE(!Matches("foo"));
+}
+
+TEST_F(FullBloomTest, SplitBlockVaryingLengths) {
+  char buffer[sizeof(int)];
+  SetFormatVersion(1);
+
+  double total_rate = 0;
+  int num_filters = 0;
+  for (int length = 1; length <= 10000; length = NextLength(length)) {
+    Reset();
+    for (int i = 0; i < length; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    ASSERT_LE(FilterSize(), (size_t)((length * 10 / 8) + 32 + 6)) << length;
+
+    // All added keys must match
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+
+    double rate = FalsePositiveRate();
+    if (kVerbose >= 1) {
+      fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n",
+              rate*100.0, length, static_cast<int>(FilterSize()));
+    }
+    ASSERT_LE(rate, 0.03);
+    total_rate += rate;
+    num_filters++;
+  }
+  ASSERT_LE(total_rate / num_filters, 0.02);
+}
+
+TEST_F(FullBloomTest, SplitBlockFormatCompatibility) {
+  char buffer[sizeof(int)];
+  SetFormatVersion(1);
+  for (int i = 0; i < 1000; i++) {
+    Add(Key(i, buffer));
+  }
+  Build();
+  std::string filter = Filter().ToString();
+  // Readers of the original format see no cache lines in the trailer and
+  // treat the filter as matching everything
+  ASSERT_EQ(0U, DecodeFixed32(filter.data() + filter.size() - 4));
+
+  // Filters are read according to their own format, whatever the policy
+  // builds
+  SetFormatVersion(0);
+  std::unique_ptr<FilterBitsReader> reader(NewReader(filter));
+  int matches = 0;
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i, buffer)));
+    matches += reader->MayMatch(Key(i + 1000000000, buffer)) ? 1 : 0;
+  }
+  ASSERT_LT(matches, 50);
+
+  // Filters of an unknown format version match every key
+  filter[filter.size() - 6] = 100;
+  reader.reset(NewReader(filter));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i + 1000000000, buffer)));
+  }
+}
+
+TEST_F(FullBloomTest, RibbonSmall) {
+  SetFormatVersion(2);
+  ASSERT_TRUE(!Matches("hello"));
+  Reset();
+  Add("hello");
+  Add("world");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  ASSERT_TRUE(!Matches("x"));
+  ASSERT_TRUE(!Matches("foo"));
+}
+
+TEST_F(FullBloomTest, RibbonVaryingLengths) {
+  char buffer[sizeof(int)];
+  SetFormatVersion(2);
+
+  double total_rate = 0;
+  int num_filters = 0;
+  for (int length = 1; length <= 100000; length = NextLength(length)) {
+    Reset();
+    for (int i = 0; i < length; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    // 7 result bits per slot for 10 Bloom bits per key, with at most 12%
+    // more slots than keys and two 56-byte blocks at least
+    ASSERT_LE(FilterSize(), (size_t)(length * 7 * 1.12 / 8 + 2 * 56 + 8))
+        << length;
+
+    // All added keys must match
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+
+    double rate = FalsePositiveRate();
+    if (kVerbose >= 1) {
+      fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n",
+              rate*100.0, length, static_cast<int>(FilterSize()));
+    }
+    ASSERT_LE(rate, 0.015);
+    total_rate += rate;
+    num_filters++;
+  }
+  // 2^-7
+  ASSERT_LE(total_rate / num_filters, 0.01);
+}
+
+TEST_F(FullBloomTest, RibbonFilterSize) {
+  RibbonFilterBitsBuilder builder(7);
+  uint32_t dont_care;
+  for (int n = 1; n < 100000; n = NextLength(n)) {
+    auto space = builder.CalculateSpace(n, &dont_care);
+    auto n2 = builder.CalculateNumEntry(space);
+    ASSERT_GE(n2, n);
+    ASSERT_EQ(space, builder.CalculateSpace(n2, &dont_care));
+  }
+}
+
+TEST_F(FullBloomTest, RibbonFormatCompatibility) {
+  char buffer[sizeof(int)];
+  SetFormatVersion(2);
+  for (int i = 0; i < 1000; i++) {
+    Add(Key(i, buffer));
+  }
+  Build();
+  std::string filter = Filter().ToString();
+  ASSERT_EQ(0U, DecodeFixed32(filter.data() + filter.size() - 4));
+
+  SetFormatVersion(0);
+  std::unique_ptr<FilterBitsReader> reader(NewReader(filter));
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i, buffer)));
+  }
+
+  // A filter that could not be built, or a broken one, matches every key
+  filter[filter.size() - 8] = 0;
+  reader.reset(NewReader(filter));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i + 1000000000, buffer)));
+  }
+  filter[filter.size() - 8] = 17;
+  reader.reset(NewReader(filter));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(reader->MayMatch(Key(i + 1000000000, buffer)));
+  }
+}
+
+TEST_F(FullBloomTest, RibbonStartLevel) {
+  std::unique_ptr<const FilterPolicy> policy(NewRibbonFilterPolicy(10, 2));
+  FilterBuildingContext context;
+  for (int level : {-1, 0, 1, 2, 6}) {
+    context.level_at_creation = level;
+    std::unique_ptr<FilterBitsBuilder> builder(
+        policy->GetBuilderWithContext(context));
+    bool is_ribbon =
+        dynamic_cast<RibbonFilterBitsBuilder*>(builder.get()) != nullptr;
+    ASSERT_EQ(level < 0 || level >= 2, is_ribbon) << level;
+    if (!is_ribbon) {
+      ASSERT_TRUE(dynamic_cast<FullFilterBitsBuilder*>(builder.get()) !=
+                  nullptr);
+    }
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -481,6 +481,13 @@ std::string IsFastCrc32Supported() {
 #else
   has_fast_crc = isSSE42();
   arch = "x86";
+#if defined HAVE_SSE42 && defined HAVE_PCLMUL && !defined NO_THREEWAY_CRC32C
+  // Choose_Extend() then interleaves three streams and combines them with
+  // carry-less multiplication.
+  if (has_fast_crc && isPCLMULQDQ()) {
+    arch = "x86 with PCLMULQDQ";
+  }
+#endif
 #endif
   if (has_fast_crc) {
     fast_zero_msg.append("Supported on " + arch);
@@ -1226,6 +1233,83 @@ uint32_t Extend(uint32_t crc, const char* buf, size_t size) {
   return ChosenExtend(crc, buf, size);
 }
 
+// Arithmetic on polynomials modulo the CRC32C polynomial, in the reflected
+// bit order used by the tables above: bit 31 is the coefficient of x^0.
+static const uint32_t kCrc32cPoly = 0x82f63b78;
+
+// Return v * x.
+static inline uint32_t MultiplyByX(uint32_t v) {
+  return (v >> 1) ^ ((v & 1) ? kCrc32cPoly : 0);
+}
+
+struct PolyTables {
+  // reduce4[m] is m * x^4 for the polynomials m of bits 0-3 (x^28-x^31).
+  uint32_t reduce4[16];
+  // byte_power[j][b] is x^(8 * b * 256^j): the shift by b * 256^j bytes.
+  uint32_t byte_power[sizeof(uint64_t)][256];
+
+  PolyTables();
+};
+
+static uint32_t MultiplyModPoly(const PolyTables& tables, uint32_t a,
+                                uint32_t b);
+
+PolyTables::PolyTables() {
+  for (uint32_t m = 0; m < 16; m++) {
+    uint32_t v = m;
+    for (int i = 0; i < 4; i++) {
+      v = MultiplyByX(v);
+    }
+    reduce4[m] = v;
+  }
+  uint32_t x8 = 1u << 23;  // x^8, the shift by one byte
+  for (size_t j = 0; j < sizeof(uint64_t); j++) {
+    byte_power[j][0] = 1u << 31;  // x^0
+    for (int b = 1; b < 256; b++) {
+      byte_power[j][b] = MultiplyModPoly(*this, byte_power[j][b - 1], x8);
+    }
+    // x^(8 * 256^(j + 1))
+    x8 = MultiplyModPoly(*this, byte_power[j][255], x8);
+  }
+}
+
+// Return a * b, four bits of a at a time.
+static uint32_t MultiplyModPoly(const PolyTables& tables, uint32_t a,
+                                uint32_t b) {
+  // multiples[m] is b times the polynomial of the four bits of m, where
+  // bit 3 is the lowest degree as in a.
+  const uint32_t b1 = MultiplyByX(b);
+  const uint32_t b2 = MultiplyByX(b1);
+  const uint32_t b3 = MultiplyByX(b2);
+  const uint32_t multiples[16] = {
+      0,           b3,           b2,           b2 ^ b3,
+      b1,          b1 ^ b3,      b1 ^ b2,      b1 ^ b2 ^ b3,
+      b,           b ^ b3,       b ^ b2,       b ^ b2 ^ b3,
+      b ^ b1,      b ^ b1 ^ b3,  b ^ b1 ^ b2,  b ^ b1 ^ b2 ^ b3};
+  // Horner's rule from the highest degree nibble of a, in its low bits.
+  uint32_t product = 0;
+  for (int shift = 0; shift < 32; shift += 4) {
+    product = (product >> 4) ^ tables.reduce4[product & 15] ^
+              multiples[(a >> shift) & 15];
+  }
+  return product;
+}
+
+static const PolyTables kPolyTables;
+
+uint32_t Combine(uint32_t crc1, uint32_t crc2, size_t len2) {
+  // Appending len2 bytes multiplies the crc of A by x^(8 * len2); the
+  // pre- and post-conditioning of both crcs cancel out.
+  uint32_t shift = kPolyTables.byte_power[0][len2 & 255];
+  uint64_t n = static_cast<uint64_t>(len2) >> 8;
+  for (size_t j = 1; n != 0; j++, n >>= 8) {
+    if (n & 255) {
+      shift = MultiplyModPoly(kPolyTables, kPolyTables.byte_power[j][n & 255],
+                              shift);
+    }
+  }
+  return MultiplyModPoly(kPolyTables, shift, crc1) ^ crc2;
+}
 
 }  // namespace crc32c
 }  // namespace rocksdb
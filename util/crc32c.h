@@ -27,6 +27,12 @@ inline uint32_t Value(const char* data, size_t n) {
   return Extend(0, data, n);
 }
 
+// Return the crc32c of concat(A, B) where crc1 is the crc32c of some
+// string A and crc2 is the crc32c of some string B of length len2.
+// Combine() lets the crc32c of pieces of a stream be computed
+// independently, and costs O(log(len2)) regardless of the data.
+extern uint32_t Combine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 static const uint32_t kMaskDelta = 0xa282ead8ul;
 
 // Return a masked representation of crc.
@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "util/crc32c.h"
+#include <vector>
 #include "util/testharness.h"
 #include "util/coding.h"
 
@@ -120,6 +121,44 @@ TEST(CRC, StandardResults) {
 
 }
 
+// Bit at a time crc32c, to check the kernels against.
+static uint32_t BitwiseExtend(uint32_t crc, const char* data, size_t n) {
+  crc = ~crc;
+  for (size_t i = 0; i < n; i++) {
+    crc ^= static_cast<unsigned char>(data[i]);
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78 : 0);
+    }
+  }
+  return ~crc;
+}
+
+TEST(CRC, MatchesBitwise) {
+  // The 3-way kernel aligns its input to 8 bytes, runs three streams of up
+  // to 128 words each over inputs above 216 bytes, and finishes the
+  // remainder one stream at a time. Cover the edges of all these cases.
+  std::vector<size_t> lengths;
+  for (size_t len = 0; len <= 300; len++) {
+    lengths.push_back(len);
+  }
+  for (size_t blocks = 1; blocks <= 3; blocks++) {
+    for (size_t len = blocks * 24 * 128 - 30; len <= blocks * 24 * 128 + 30;
+         len++) {
+      lengths.push_back(len);
+    }
+  }
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t len : lengths) {
+      const char* data = buffer + offset;
+      ASSERT_EQ(BitwiseExtend(0, data, len), Value(data, len))
+          << "offset " << offset << " length " << len;
+      ASSERT_EQ(BitwiseExtend(0x12345678, data, len),
+                Extend(0x12345678, data, len))
+          << "offset " << offset << " length " << len;
+    }
+  }
+}
+
 TEST(CRC, Values) {
   ASSERT_NE(Value("a", 1), Value("foo", 3));
 }
@@ -129,6 +168,24 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine) {
+  ASSERT_EQ(Value("hello world", 11),
+            Combine(Value("hello ", 6), Value("world", 5), 5));
+  ASSERT_EQ(Value("hello", 5), Combine(Value("hello", 5), Value("", 0), 0));
+  ASSERT_EQ(Value("hello", 5), Combine(Value("", 0), Value("hello", 5), 5));
+
+  // Split a buffer at every position
+  char buf[1000];
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = static_cast<char>(i * 7 + i / 13);
+  }
+  const uint32_t crc = Value(buf, sizeof(buf));
+  for (size_t i = 0; i <= sizeof(buf); i++) {
+    ASSERT_EQ(crc, Combine(Value(buf, i), Value(buf + i, sizeof(buf) - i),
+                           sizeof(buf) - i));
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
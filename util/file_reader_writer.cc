@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <mutex>
+#include <vector>
 
 #include "monitoring/histogram.h"
 #include "monitoring/iostats_context_imp.h"
@@ -155,6 +156,73 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status RandomAccessFileReader::MultiRead(ReadRequest* read_reqs,
+                                         size_t num_reqs) const {
+  Status s;
+  if (use_direct_io() || (for_compaction_ && rate_limiter_ != nullptr)) {
+    // Alignment and rate limiting are taken care of request by request in
+    // Read().
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = read_reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return s;
+  }
+  uint64_t elapsed = 0;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
+                 true /*delay_enabled*/);
+    IOSTATS_TIMER_GUARD(read_nanos);
+    s = file_->MultiRead(read_reqs, num_reqs);
+    for (size_t i = 0; i < num_reqs; ++i) {
+      IOSTATS_ADD_IF_POSITIVE(bytes_read, read_reqs[i].result.size());
+    }
+  }
+  if (stats_ != nullptr && file_read_hist_ != nullptr) {
+    file_read_hist_->Add(elapsed);
+  }
+  return s;
+}
+
+Status RandomAccessFileReader::SubmitReads(ReadRequest* read_reqs,
+                                           size_t num_reqs,
+                                           void** io_handle) const {
+  *io_handle = nullptr;
+  if (use_direct_io() || (for_compaction_ && rate_limiter_ != nullptr)) {
+    return MultiRead(read_reqs, num_reqs);
+  }
+  IOSTATS_TIMER_GUARD(read_nanos);
+  return file_->SubmitReads(read_reqs, num_reqs, io_handle);
+}
+
+Status RandomAccessFileReader::PollReads(ReadRequest* read_reqs,
+                                         size_t num_reqs, void* io_handle,
+                                         bool wait) const {
+  if (io_handle == nullptr) {
+    // Completed by SubmitReads(), which also did the accounting
+    return Status::OK();
+  }
+  uint64_t elapsed = 0;
+  Status s;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
+                 true /*delay_enabled*/);
+    IOSTATS_TIMER_GUARD(read_nanos);
+    s = file_->PollReads(io_handle, wait);
+  }
+  if (s.ok()) {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      IOSTATS_ADD_IF_POSITIVE(bytes_read, read_reqs[i].result.size());
+    }
+    if (stats_ != nullptr && file_read_hist_ != nullptr) {
+      file_read_hist_->Add(elapsed);
+    }
+  }
+  return s;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
@@ -643,6 +711,11 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
 };
 }  // namespace
 
+FilePrefetchBuffer::~FilePrefetchBuffer() {
+  // The read must not outlive the buffer it writes into
+  WaitForAsyncRead();
+}
+
 Status FilePrefetchBuffer::Prefetch(RandomAccessFileReader* reader,
                                     uint64_t offset, size_t n) {
   size_t alignment = reader->file()->GetRequiredBufferAlignment();
@@ -717,7 +790,13 @@ bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
   if (track_min_offset_ && offset < min_offset_read_) {
     min_offset_read_ = offset;
   }
-  if (!enable_ || offset < buffer_offset_) {
+  if (!enable_) {
+    return false;
+  }
+  if (!InBuffer(offset, n)) {
+    UseAsyncBuffer(offset, n);
+  }
+  if (offset < buffer_offset_) {
     return false;
   }
 
@@ -742,9 +821,145 @@ bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
 
   uint64_t offset_in_buffer = offset - buffer_offset_;
   *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
+
+  if (async_readahead_ && readahead_size_ > 0 && !async_read_pending_) {
+    // Read the next window while the caller works through this one.
+    // Discarding the status intentionally: on failure the next miss just
+    // reads synchronously.
+    uint64_t buffer_end = buffer_offset_ + buffer_.CurrentSize();
+    if (next_window_offset_ != buffer_end &&
+        PrefetchAsync(file_reader_, buffer_end, readahead_size_).ok()) {
+      readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+    }
+  }
   return true;
 }
 
+Status FilePrefetchBuffer::PrefetchAsync(RandomAccessFileReader* reader,
+                                         uint64_t offset, size_t n) {
+  Status s = WaitForAsyncRead();
+  if (!s.ok() || InBuffer(offset, n)) {
+    return s;
+  }
+  size_t alignment = reader->file()->GetRequiredBufferAlignment();
+  size_t offset_ = static_cast<size_t>(offset);
+  uint64_t rounddown_offset = Rounddown(offset_, alignment);
+  uint64_t roundup_end = Roundup(offset_ + n, alignment);
+  size_t roundup_len = static_cast<size_t>(roundup_end - rounddown_offset);
+  if (async_buffer_.Capacity() < roundup_len) {
+    async_buffer_.Alignment(alignment);
+    async_buffer_.AllocateNewBuffer(roundup_len);
+  }
+  async_buffer_.Size(0);
+  async_buffer_offset_ = rounddown_offset;
+  // Remembered even if the read fails or hits the end of the file, so that
+  // TryReadFromCache() does not keep asking for the same window.
+  next_window_offset_ = offset;
+
+  async_req_.offset = rounddown_offset;
+  async_req_.len = roundup_len;
+  async_req_.scratch = async_buffer_.BufferStart();
+  s = reader->SubmitReads(&async_req_, 1, &async_io_handle_);
+  if (s.ok()) {
+    async_reader_ = reader;
+    async_read_pending_ = true;
+  }
+  return s;
+}
+
+Status FilePrefetchBuffer::WaitForAsyncRead() {
+  if (!async_read_pending_) {
+    return Status::OK();
+  }
+  Status s = async_reader_->PollReads(&async_req_, 1, async_io_handle_,
+                                      true /* wait */);
+  async_read_pending_ = false;
+  async_io_handle_ = nullptr;
+  if (s.ok()) {
+    s = async_req_.status;
+  }
+  if (s.ok()) {
+    if (async_req_.result.data() != async_req_.scratch) {
+      memcpy(async_req_.scratch, async_req_.result.data(),
+             async_req_.result.size());
+    }
+    async_buffer_.Size(async_req_.result.size());
+  }
+  return s;
+}
+
+bool FilePrefetchBuffer::UseAsyncBuffer(uint64_t offset, size_t n) {
+  if (!WaitForAsyncRead().ok() || async_buffer_.CurrentSize() == 0) {
+    return false;
+  }
+  uint64_t async_end = async_buffer_offset_ + async_buffer_.CurrentSize();
+  if (offset < async_buffer_offset_ && offset >= buffer_offset_ &&
+      offset < buffer_offset_ + buffer_.CurrentSize() &&
+      buffer_offset_ + buffer_.CurrentSize() == async_buffer_offset_ &&
+      offset + n <= async_end) {
+    // The request straddles the two windows. Move the unread tail of the
+    // current one in front of the next so that it is served contiguously.
+    size_t alignment = buffer_.Alignment();
+    size_t chunk_offset_in_buffer =
+        static_cast<size_t>(Rounddown(offset - buffer_offset_, alignment));
+    size_t chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+    AlignedBuffer merged;
+    merged.Alignment(alignment);
+    merged.AllocateNewBuffer(chunk_len + async_buffer_.CurrentSize());
+    merged.Append(buffer_.BufferStart() + chunk_offset_in_buffer, chunk_len);
+    merged.Append(async_buffer_.BufferStart(), async_buffer_.CurrentSize());
+    buffer_ = std::move(merged);
+    buffer_offset_ += chunk_offset_in_buffer;
+  } else if (offset >= async_buffer_offset_ && offset + n <= async_end) {
+    // Keep the old buffer around to read the following window into
+    std::swap(buffer_, async_buffer_);
+    std::swap(buffer_offset_, async_buffer_offset_);
+  } else {
+    return false;
+  }
+  async_buffer_.Size(0);
+  return true;
+}
+
+Status FilePrefetchBuffer::MultiPrefetch(RandomAccessFileReader* reader,
+                                         FilePrefetchBuffer* buffers,
+                                         const uint64_t* offsets,
+                                         const size_t* n, size_t num_buffers) {
+  size_t alignment = reader->file()->GetRequiredBufferAlignment();
+  std::vector<ReadRequest> reqs(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    FilePrefetchBuffer& buf = buffers[i];
+    size_t offset = static_cast<size_t>(offsets[i]);
+    uint64_t rounddown_offset = Rounddown(offset, alignment);
+    uint64_t roundup_end = Roundup(offset + n[i], alignment);
+    size_t roundup_len = static_cast<size_t>(roundup_end - rounddown_offset);
+    if (buf.buffer_.Capacity() < roundup_len) {
+      buf.buffer_.Alignment(alignment);
+      buf.buffer_.AllocateNewBuffer(roundup_len);
+    }
+    buf.buffer_.Size(0);
+    buf.buffer_offset_ = rounddown_offset;
+    reqs[i].offset = rounddown_offset;
+    reqs[i].len = roundup_len;
+    reqs[i].scratch = buf.buffer_.BufferStart();
+  }
+
+  Status s = reader->MultiRead(reqs.data(), num_buffers);
+  for (size_t i = 0; s.ok() && i < num_buffers; ++i) {
+    ReadRequest& req = reqs[i];
+    if (!req.status.ok()) {
+      s = req.status;
+      break;
+    }
+    if (req.result.data() != req.scratch) {
+      // e.g. mmap reads return data that lives outside of scratch
+      memcpy(req.scratch, req.result.data(), req.result.size());
+    }
+    buffers[i].buffer_.Size(req.result.size());
+  }
+  return s;
+}
+
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
     std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size) {
   std::unique_ptr<RandomAccessFile> result(
@@ -110,6 +110,23 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  // Issues all of reqs through a single RandomAccessFile::MultiRead() call so
+  // that the underlying file can read them in parallel. Per-request results
+  // are returned in reqs[i].result and reqs[i].status.
+  Status MultiRead(ReadRequest* reqs, size_t num_reqs) const;
+
+  // Starts reqs through RandomAccessFile::SubmitReads() without waiting for
+  // them. The same reqs and *io_handle must then be passed to PollReads()
+  // until it returns OK. Direct I/O and rate limited compaction reads are
+  // done before returning, with *io_handle set to nullptr.
+  Status SubmitReads(ReadRequest* reqs, size_t num_reqs,
+                     void** io_handle) const;
+
+  // See RandomAccessFile::PollReads(). Accounts for the bytes read once the
+  // batch has completed.
+  Status PollReads(ReadRequest* reqs, size_t num_reqs, void* io_handle,
+                   bool wait) const;
+
   Status Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n);
   }
@@ -215,19 +232,41 @@ class WritableFileWriter {
 class FilePrefetchBuffer {
  public:
   // If `track_min_offset` is true, track minimum offset ever read.
+  // If `async_readahead` is true, the next readahead window is read in the
+  // background into a second buffer while the current one is consumed,
+  // instead of only once a read runs past the end of the current one.
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readadhead_size = 0, size_t max_readahead_size = 0,
-                     bool enable = true, bool track_min_offset = false)
+                     bool enable = true, bool track_min_offset = false,
+                     bool async_readahead = false)
       : buffer_offset_(0),
         file_reader_(file_reader),
         readahead_size_(readadhead_size),
         max_readahead_size_(max_readahead_size),
         min_offset_read_(port::kMaxSizet),
         enable_(enable),
-        track_min_offset_(track_min_offset) {}
+        track_min_offset_(track_min_offset),
+        async_readahead_(async_readahead) {}
+  ~FilePrefetchBuffer();
   Status Prefetch(RandomAccessFileReader* reader, uint64_t offset, size_t n);
   bool TryReadFromCache(uint64_t offset, size_t n, Slice* result);
 
+  // Starts reading [offset, offset + n) into the second buffer without
+  // waiting for it, unless the range is already buffered. TryReadFromCache()
+  // keeps serving the first buffer meanwhile, and only waits for the read
+  // once it is asked for data that the first buffer does not hold.
+  Status PrefetchAsync(RandomAccessFileReader* reader, uint64_t offset,
+                       size_t n);
+
+  // Fills buffers[i] with the n[i] bytes of the file starting at offsets[i],
+  // issuing all of the reads together through reader->MultiRead(). Any data
+  // previously held by the buffers is discarded. Returns the first error
+  // encountered; buffers whose read failed are left empty.
+  static Status MultiPrefetch(RandomAccessFileReader* reader,
+                              FilePrefetchBuffer* buffers,
+                              const uint64_t* offsets, const size_t* n,
+                              size_t num_buffers);
+
   // The minimum `offset` ever passed to TryReadFromCache(). Only be tracked
   // if track_min_offset = true.
   size_t min_offset_read() const { return min_offset_read_; }
@@ -246,6 +285,29 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+  bool async_readahead_;
+  // The second buffer, filled by PrefetchAsync(). Its contents are only
+  // valid once async_read_pending_ is false.
+  AlignedBuffer async_buffer_;
+  uint64_t async_buffer_offset_ = 0;
+  // Offset last passed to PrefetchAsync()
+  uint64_t next_window_offset_ = 0;
+  RandomAccessFileReader* async_reader_ = nullptr;
+  ReadRequest async_req_;
+  void* async_io_handle_ = nullptr;
+  bool async_read_pending_ = false;
+
+  bool InBuffer(uint64_t offset, size_t n) const {
+    return buffer_.CurrentSize() > 0 && offset >= buffer_offset_ &&
+           offset + n <= buffer_offset_ + buffer_.CurrentSize();
+  }
+
+  // Waits for the read started by PrefetchAsync(), if any.
+  Status WaitForAsyncRead();
+
+  // Makes [offset, offset + n) part of buffer_ using the data of the second
+  // buffer, if it has it. Returns false otherwise.
+  bool UseAsyncBuffer(uint64_t offset, size_t n);
 };
 
 extern Status NewWritableFile(Env* env, const std::string& fname,
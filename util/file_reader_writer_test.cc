@@ -219,6 +219,86 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn) {
 }
 #endif
 
+TEST(FilePrefetchBufferTest, PrefetchAsync) {
+  Env* env = Env::Default();
+  const std::string fname = test::TmpDir(env) + "/prefetch_async";
+  Random rnd(301);
+  std::string data = test::RandomHumanReadableString(&rnd, 256 << 10);
+  {
+    unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env->NewWritableFile(fname, &wfile, EnvOptions()));
+    ASSERT_OK(wfile->Append(data));
+    ASSERT_OK(wfile->Close());
+  }
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env->NewRandomAccessFile(fname, &file, EnvOptions()));
+  RandomAccessFileReader reader(std::move(file), fname, env);
+
+  {
+    FilePrefetchBuffer buffer;
+    ASSERT_OK(buffer.PrefetchAsync(&reader, 5000, 60000));
+    Slice result;
+    ASSERT_TRUE(buffer.TryReadFromCache(6000, 1000, &result));
+    ASSERT_EQ(Slice(data.data() + 6000, 1000), result);
+    ASSERT_FALSE(buffer.TryReadFromCache(100000, 1000, &result));
+
+    // Range running past the end of the file
+    ASSERT_OK(buffer.PrefetchAsync(&reader, data.size() - 100, 1000));
+    ASSERT_TRUE(buffer.TryReadFromCache(data.size() - 100, 100, &result));
+    ASSERT_EQ(Slice(data.data() + data.size() - 100, 100), result);
+
+    // Blocking prefetch after an asynchronous one
+    ASSERT_OK(buffer.PrefetchAsync(&reader, 0, 4096));
+    ASSERT_OK(buffer.Prefetch(&reader, 1000, 20000));
+    ASSERT_TRUE(buffer.TryReadFromCache(1000, 20000, &result));
+    ASSERT_EQ(Slice(data.data() + 1000, 20000), result);
+
+    // Left in flight for the destructor to wait for
+    ASSERT_OK(buffer.PrefetchAsync(&reader, 128 << 10, 64 << 10));
+  }
+  ASSERT_OK(env->DeleteFile(fname));
+}
+
+TEST(FilePrefetchBufferTest, AsyncReadahead) {
+  Env* env = Env::Default();
+  const std::string fname = test::TmpDir(env) + "/async_readahead";
+  Random rnd(301);
+  std::string data = test::RandomHumanReadableString(&rnd, 1 << 20);
+  {
+    unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env->NewWritableFile(fname, &wfile, EnvOptions()));
+    ASSERT_OK(wfile->Append(data));
+    ASSERT_OK(wfile->Close());
+  }
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env->NewRandomAccessFile(fname, &file, EnvOptions()));
+  RandomAccessFileReader reader(std::move(file), fname, env);
+
+  // Sequential reads of varying sizes, many of which straddle the windows
+  FilePrefetchBuffer buffer(&reader, 8 << 10, 64 << 10, true /* enable */,
+                            false /* track_min_offset */,
+                            true /* async_readahead */);
+  size_t offset = 0;
+  while (offset < data.size()) {
+    size_t n = std::min<size_t>(rnd.Uniform(6000) + 1, data.size() - offset);
+    Slice result;
+    ASSERT_TRUE(buffer.TryReadFromCache(offset, n, &result));
+    ASSERT_EQ(Slice(data.data() + offset, n), result);
+    offset += n;
+  }
+  // Skipping forward past the windows still reads the right data
+  FilePrefetchBuffer skip_buffer(&reader, 8 << 10, 64 << 10, true, false,
+                                 true);
+  offset = 0;
+  while (offset + 5000 <= data.size()) {
+    Slice result;
+    ASSERT_TRUE(skip_buffer.TryReadFromCache(offset, 5000, &result));
+    ASSERT_EQ(Slice(data.data() + offset, 5000), result);
+    offset += 5000 + rnd.Uniform(100000);
+  }
+  ASSERT_OK(env->DeleteFile(fname));
+}
+
 class ReadaheadRandomAccessFileTest
     : public testing::Test,
       public testing::WithParamInterface<size_t> {
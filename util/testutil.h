@@ -90,6 +90,8 @@ class PlainInternalKeyComparator : public InternalKeyComparator {
   virtual int Compare(const Slice& a, const Slice& b) const override {
     return user_comparator()->Compare(a, b);
   }
+
+  virtual bool OrdersByUserKey() const override { return false; }
 };
 #endif
 
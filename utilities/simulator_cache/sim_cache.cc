@@ -149,12 +149,11 @@ class CacheActivityLogger {
 // SimCacheImpl definition
 class SimCacheImpl : public SimCache {
  public:
-  // capacity for real cache (ShardedLRUCache)
-  // test_capacity for key only cache
-  SimCacheImpl(std::shared_ptr<Cache> cache, size_t sim_capacity,
-               int num_shard_bits)
+  // cache is the real cache (ShardedLRUCache)
+  // sim_cache is the key only cache used for simulation
+  SimCacheImpl(std::shared_ptr<Cache> sim_cache, std::shared_ptr<Cache> cache)
       : cache_(cache),
-        key_only_cache_(NewLRUCache(sim_capacity, num_shard_bits)),
+        key_only_cache_(sim_cache),
         miss_times_(0),
         hit_times_(0),
         stats_(nullptr) {}
@@ -337,7 +336,15 @@ std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  return std::make_shared<SimCacheImpl>(cache, sim_capacity, num_shard_bits);
+  return NewSimCache(NewLRUCache(sim_capacity, num_shard_bits), cache);
+}
+
+std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> sim_cache,
+                                      std::shared_ptr<Cache> cache) {
+  if (sim_cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<SimCacheImpl>(sim_cache, cache);
 }
 
 }  // end namespace rocksdb
@@ -210,6 +210,40 @@ TEST_F(SimCacheTest, SimCacheLogging) {
 	ASSERT_GT(fsize, max_size - 100);
 }
 
+TEST_F(SimCacheTest, SimulateCustomCache) {
+  LRUCacheOptions tiny_lfu_opts(10 /*capacity*/, 0 /*num_shard_bits*/,
+                                false /*strict_capacity_limit*/,
+                                0.0 /*high_pri_pool_ratio*/);
+  tiny_lfu_opts.tiny_lfu_admission = true;
+  std::shared_ptr<SimCache> lru_sim =
+      NewSimCache(NewLRUCache(1024 * 1024), 10, 0);
+  std::shared_ptr<SimCache> tiny_lfu_sim =
+      NewSimCache(NewLRUCache(tiny_lfu_opts), NewLRUCache(1024 * 1024));
+  ASSERT_EQ(10, tiny_lfu_sim->GetSimCapacity());
+
+  auto access = [](SimCache* cache, const std::string& key) {
+    Cache::Handle* h = cache->Lookup(key);
+    if (h == nullptr) {
+      ASSERT_OK(cache->Insert(key, nullptr, 1, nullptr, &h));
+    }
+    cache->Release(h);
+  };
+  // A small working set interleaved with scans of keys seen only once.
+  for (int round = 0; round < 3; round++) {
+    for (SimCache* cache : {lru_sim.get(), tiny_lfu_sim.get()}) {
+      for (int i = 0; i < 5; i++) {
+        access(cache, "hot" + ToString(i));
+      }
+      for (int i = 0; i < 20; i++) {
+        access(cache, "scan" + ToString(round * 20 + i));
+      }
+    }
+  }
+  // Plain LRU loses the working set to every scan.
+  ASSERT_EQ(0, lru_sim->get_hit_counter());
+  ASSERT_EQ(10, tiny_lfu_sim->get_hit_counter());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {